@@ -0,0 +1,245 @@
+#pragma once
+
+#include "chat_history.hpp"
+#include "compression/compression.hpp"
+
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Chat
+{
+    /**
+     * @brief Versioned binary encoding of a chat, used for snapshots on disk.
+     *
+     * Layout, all integers little-endian:
+     *   "KCHB" | u16 version | u8 codec | body
+     * where the body is stored as-is (codec 0) or as one Compression frame (codec 1):
+     *   u64 journal epoch | i32 id | i32 lastModified | str name | u32 message count,
+     *   then per message:
+     *   i32 id | u8 flags (1 liked, 2 disliked) | str role | f32 tps |
+     *   i64 timestamp in microseconds since the Unix epoch | str content | str modelName
+     * where str is a u32 byte length followed by the bytes.
+     *
+     * Timestamps are plain numbers, so reading a chat does no date parsing, and they
+     * keep sub-second precision that the JSON strings drop. Versions 1 and 2 stored the
+     * role as a u8 (0 user, 1 assistant), and version 1 had no codec byte and an
+     * uncompressed body; both still read.
+     */
+    class ChatBinaryFormat
+    {
+    public:
+        static constexpr char     MAGIC[4] = { 'K', 'C', 'H', 'B' };
+        static constexpr uint16_t VERSION = 3;
+        // Chat text compresses well within a block this size; larger blocks only cost memory
+        static constexpr size_t   COMPRESSION_BLOCK_SIZE = 256 * 1024;
+
+        enum class Codec : uint8_t
+        {
+            NONE = 0,
+            KLZ = 1
+        };
+        static constexpr uint32_t MAX_STRING_SIZE = 256 * 1024 * 1024;
+
+        // JSON chats start with '{', so the first byte is enough to tell them apart
+        static bool matches(std::istream& in)
+        {
+            return in.peek() == MAGIC[0];
+        }
+
+        /**
+         * @param journalEpoch Epoch of the journal that continues this snapshot, 0 if none.
+         */
+        static void write(std::ostream& out, const ChatHistory& chat, uint64_t journalEpoch,
+            Codec codec = Codec::NONE)
+        {
+            out.write(MAGIC, sizeof(MAGIC));
+            putInt(out, VERSION, 2);
+            putInt(out, static_cast<uint8_t>(codec), 1);
+
+            if (codec == Codec::KLZ)
+            {
+                Compression::CompressStreamBuf packed(out, COMPRESSION_BLOCK_SIZE);
+                std::ostream body(&packed);
+                writeBody(body, chat, journalEpoch);
+                packed.finish();
+            }
+            else
+            {
+                writeBody(out, chat, journalEpoch);
+            }
+
+            if (!out)
+            {
+                throw std::runtime_error("Failed to write binary chat");
+            }
+        }
+
+        static ChatHistory read(std::istream& in, uint64_t& journalEpoch)
+        {
+            char magic[sizeof(MAGIC)];
+            getBytes(in, magic, sizeof(magic));
+            if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+            {
+                throw std::runtime_error("Not a binary chat");
+            }
+            const uint16_t version = static_cast<uint16_t>(getInt(in, 2));
+            if (version == 0 || version > VERSION)
+            {
+                throw std::runtime_error("Unsupported binary chat version " + std::to_string(version));
+            }
+
+            const Codec codec = version == 1 ? Codec::NONE : static_cast<Codec>(getInt(in, 1));
+            switch (codec)
+            {
+            case Codec::NONE:
+                return readBody(in, journalEpoch, version);
+            case Codec::KLZ:
+            {
+                Compression::DecompressStreamBuf packed(in);
+                std::istream body(&packed);
+                // Surface decompression errors instead of a generic short read
+                body.exceptions(std::ios::badbit);
+                ChatHistory chat = readBody(body, journalEpoch, version);
+                if (body.peek() != std::char_traits<char>::eof() || !packed.complete())
+                {
+                    throw std::runtime_error("Trailing data in compressed binary chat");
+                }
+                return chat;
+            }
+            default:
+                throw std::runtime_error("Unknown binary chat codec " + std::to_string(static_cast<int>(codec)));
+            }
+        }
+
+        // Little-endian primitives, shared with the other binary files next to the chats
+
+        static void putInt(std::ostream& out, uint64_t value, int bytes)
+        {
+            char buffer[8];
+            for (int i = 0; i < bytes; ++i)
+            {
+                buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            out.write(buffer, bytes);
+        }
+
+        static void putString(std::ostream& out, const std::string& value)
+        {
+            if (value.size() > MAX_STRING_SIZE)
+            {
+                throw std::runtime_error("String too long for binary format");
+            }
+            putInt(out, value.size(), 4);
+            out.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        static void getBytes(std::istream& in, char* data, size_t size)
+        {
+            in.read(data, static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(in.gcount()) != size)
+            {
+                throw std::runtime_error("Truncated binary data");
+            }
+        }
+
+        static uint64_t getInt(std::istream& in, int bytes)
+        {
+            unsigned char buffer[8];
+            getBytes(in, reinterpret_cast<char*>(buffer), bytes);
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i)
+            {
+                value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        static std::string getString(std::istream& in)
+        {
+            const uint32_t size = static_cast<uint32_t>(getInt(in, 4));
+            if (size > MAX_STRING_SIZE)
+            {
+                throw std::runtime_error("Invalid string length in binary data");
+            }
+            std::string value(size, '\0');
+            getBytes(in, value.data(), size);
+            return value;
+        }
+
+    private:
+        static void writeBody(std::ostream& out, const ChatHistory& chat, uint64_t journalEpoch)
+        {
+            putInt(out, journalEpoch, 8);
+            putInt(out, static_cast<uint32_t>(chat.id), 4);
+            putInt(out, static_cast<uint32_t>(chat.lastModified), 4);
+            putString(out, chat.name);
+            putInt(out, static_cast<uint32_t>(chat.messages.size()), 4);
+
+            for (const auto& message : chat.messages)
+            {
+                uint32_t tps;
+                std::memcpy(&tps, &message.tps, sizeof(tps));
+                const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    message.timestamp.time_since_epoch()).count();
+
+                putInt(out, static_cast<uint32_t>(message.id), 4);
+                putInt(out, (message.isLiked ? 1u : 0u) | (message.isDisliked ? 2u : 0u), 1);
+                putString(out, message.role);
+                putInt(out, tps, 4);
+                putInt(out, static_cast<uint64_t>(micros), 8);
+                putString(out, message.content);
+                putString(out, message.modelName);
+            }
+        }
+
+        static ChatHistory readBody(std::istream& in, uint64_t& journalEpoch, uint16_t version)
+        {
+            ChatHistory chat;
+            journalEpoch = getInt(in, 8);
+            chat.id = static_cast<int32_t>(getInt(in, 4));
+            chat.lastModified = static_cast<int32_t>(getInt(in, 4));
+            chat.name = getString(in);
+
+            const uint32_t count = static_cast<uint32_t>(getInt(in, 4));
+            // The count comes from disk; let the vector grow past this if it is real
+            chat.messages.reserve(std::min<uint32_t>(count, 4096));
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Message message;
+                message.id = static_cast<int32_t>(getInt(in, 4));
+                const uint64_t flags = getInt(in, 1);
+                message.isLiked = (flags & 1) != 0;
+                message.isDisliked = (flags & 2) != 0;
+                if (version >= 3)
+                {
+                    message.role = getString(in);
+                }
+                else
+                {
+                    const uint64_t role = getInt(in, 1);
+                    if (role > 1)
+                    {
+                        throw std::runtime_error("Invalid message role in binary chat");
+                    }
+                    message.role = role == 1 ? "assistant" : "user";
+                }
+                const uint32_t tps = static_cast<uint32_t>(getInt(in, 4));
+                std::memcpy(&message.tps, &tps, sizeof(tps));
+                message.timestamp = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::microseconds(static_cast<int64_t>(getInt(in, 8)))));
+                message.content = getString(in);
+                message.modelName = getString(in);
+                chat.messages.push_back(std::move(message));
+            }
+            return chat;
+        }
+    };
+
+} // namespace Chat
@@ -110,4 +110,32 @@ namespace Chat
         j.at("messages").get_to(chatHistory.messages);
     }
 
+    /**
+     * @brief What the chat list needs to know about a chat, without its messages.
+     */
+    struct ChatSummary
+    {
+        int id = 0;
+        int lastModified = 0;
+        std::string name;
+        size_t messageCount = 0;
+    };
+
+    inline void to_json(json& j, const ChatSummary& summary)
+    {
+        j = json{
+            {"id", summary.id},
+            {"lastModified", summary.lastModified},
+            {"name", summary.name},
+            {"messageCount", summary.messageCount} };
+    }
+
+    inline void from_json(const json& j, ChatSummary& summary)
+    {
+        j.at("id").get_to(summary.id);
+        j.at("lastModified").get_to(summary.lastModified);
+        j.at("name").get_to(summary.name);
+        j.at("messageCount").get_to(summary.messageCount);
+    }
+
 } // namespace Chat
\ No newline at end of file
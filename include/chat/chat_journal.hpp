@@ -0,0 +1,242 @@
+#pragma once
+
+#include "chat_history.hpp"
+#include "crypto/crypto.hpp"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+namespace Chat
+{
+    /**
+     * @brief Append-only log of changes made to a chat since its last snapshot.
+     *
+     * A chat on disk is a `.chat` snapshot plus an optional `.journal` next to it. The
+     * journal is a sequence of records, each a 4-byte little-endian length followed by
+     * an independently AES-GCM sealed JSON body, so appending a message only costs the
+     * size of that message. Records are tagged with the epoch of the snapshot they were
+     * written against; a snapshot rewrite picks a new epoch, which makes any journal
+     * left behind by an interrupted compaction harmless.
+     *
+     * The message JSON only keeps its timestamp to the second, so append records also
+     * carry the raw clock count; replay prefers it, which keeps timestamps as exact as
+     * they are in a binary snapshot. Records without it still replay.
+     *
+     * Record bodies:
+     *   {"epoch": E, "op": "append",   "lastModified": T, "message": {...}, "timestampTicks": C}
+     *   {"epoch": E, "op": "truncate", "lastModified": T, "count": N}
+     */
+    class ChatJournal
+    {
+    public:
+        struct Record
+        {
+            std::vector<uint8_t> sealed;
+        };
+
+        struct ReplayResult
+        {
+            size_t    records = 0;
+            uintmax_t bytes = 0;
+            // The file ends in a partial or unreadable record, e.g. after a crash mid-append
+            bool      damaged = false;
+        };
+
+        static std::filesystem::path pathFor(const std::filesystem::path& chatPath)
+        {
+            return std::filesystem::path(chatPath).replace_extension(".journal");
+        }
+
+        // Stable per-message hash used to find the first message that differs from disk
+        static uint64_t fingerprint(const Message& message)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            auto mix = [&hash](const void* data, size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ULL;
+                }
+                hash ^= 0xFF;
+                hash *= 1099511628211ULL;
+                };
+
+            const auto timestamp = message.timestamp.time_since_epoch().count();
+            mix(&message.id, sizeof(message.id));
+            mix(&message.isLiked, sizeof(message.isLiked));
+            mix(&message.isDisliked, sizeof(message.isDisliked));
+            mix(&message.tps, sizeof(message.tps));
+            mix(&timestamp, sizeof(timestamp));
+            mix(message.role.data(), message.role.size());
+            mix(message.content.data(), message.content.size());
+            mix(message.modelName.data(), message.modelName.size());
+            return hash;
+        }
+
+        static Record makeAppend(const Message& message, int lastModified, uint64_t epoch,
+            const std::array<uint8_t, 32>& key)
+        {
+            json body = {
+                {"epoch", epoch},
+                {"op", "append"},
+                {"lastModified", lastModified},
+                {"message", message},
+                {"timestampTicks", static_cast<int64_t>(message.timestamp.time_since_epoch().count())}
+            };
+            return seal(body, key);
+        }
+
+        static Record makeTruncate(size_t count, int lastModified, uint64_t epoch,
+            const std::array<uint8_t, 32>& key)
+        {
+            json body = {
+                {"epoch", epoch},
+                {"op", "truncate"},
+                {"lastModified", lastModified},
+                {"count", count}
+            };
+            return seal(body, key);
+        }
+
+        /**
+         * @brief Appends records to the journal in one write.
+         * @return Bytes written, or 0 on failure.
+         */
+        static uintmax_t append(const std::filesystem::path& journalPath, const std::vector<Record>& records)
+        {
+            std::vector<char> buffer;
+            for (const auto& record : records)
+            {
+                const uint32_t size = static_cast<uint32_t>(record.sealed.size());
+                for (int shift = 0; shift < 32; shift += 8)
+                {
+                    buffer.push_back(static_cast<char>((size >> shift) & 0xFF));
+                }
+                buffer.insert(buffer.end(), record.sealed.begin(), record.sealed.end());
+            }
+
+            std::ofstream file(journalPath, std::ios::binary | std::ios::app);
+            if (!file)
+            {
+                return 0;
+            }
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            file.flush();
+            return file ? buffer.size() : 0;
+        }
+
+        /**
+         * @brief Applies every intact record of `epoch` to `chat`, stopping at the first
+         *        damaged one. Records from other epochs are skipped.
+         */
+        static ReplayResult replay(const std::filesystem::path& journalPath, ChatHistory& chat, uint64_t epoch,
+            const std::array<uint8_t, 32>& key)
+        {
+            ReplayResult result;
+
+            std::ifstream file(journalPath, std::ios::binary);
+            if (!file)
+            {
+                return result;
+            }
+
+            while (true)
+            {
+                unsigned char header[4];
+                file.read(reinterpret_cast<char*>(header), sizeof(header));
+                if (file.gcount() == 0)
+                {
+                    break;
+                }
+                if (file.gcount() != sizeof(header))
+                {
+                    result.damaged = true;
+                    break;
+                }
+
+                const uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) |
+                    (static_cast<uint32_t>(header[3]) << 24);
+                if (size < Crypto::IV_SIZE + Crypto::TAG_SIZE || size > MAX_RECORD_SIZE)
+                {
+                    result.damaged = true;
+                    break;
+                }
+
+                std::vector<uint8_t> sealed(size);
+                file.read(reinterpret_cast<char*>(sealed.data()), size);
+                if (static_cast<uint32_t>(file.gcount()) != size)
+                {
+                    result.damaged = true;
+                    break;
+                }
+
+                try
+                {
+                    auto plaintext = Crypto::decrypt(sealed, key);
+                    json body = json::parse(plaintext.begin(), plaintext.end());
+                    if (body.at("epoch").get<uint64_t>() == epoch)
+                    {
+                        apply(body, chat);
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[ChatJournal] Stopping replay of " << journalPath
+                        << " at a bad record: " << e.what() << "\n";
+                    result.damaged = true;
+                    break;
+                }
+
+                ++result.records;
+                result.bytes += sizeof(header) + size;
+            }
+
+            return result;
+        }
+
+    private:
+        static constexpr uint32_t MAX_RECORD_SIZE = 256 * 1024 * 1024;
+
+        static Record seal(const json& body, const std::array<uint8_t, 32>& key)
+        {
+            const std::string text = body.dump();
+            return Record{ Crypto::encrypt(std::vector<uint8_t>(text.begin(), text.end()), key) };
+        }
+
+        static void apply(const json& body, ChatHistory& chat)
+        {
+            const std::string op = body.at("op").get<std::string>();
+            if (op == "append")
+            {
+                Message message = body.at("message").get<Message>();
+                auto ticks = body.find("timestampTicks");
+                if (ticks != body.end())
+                {
+                    message.timestamp = decltype(message.timestamp)(
+                        decltype(message.timestamp)::duration(ticks->get<int64_t>()));
+                }
+                chat.messages.push_back(std::move(message));
+            }
+            else if (op == "truncate")
+            {
+                const size_t count = body.at("count").get<size_t>();
+                if (count < chat.messages.size())
+                {
+                    chat.messages.resize(count);
+                }
+            }
+            else
+            {
+                throw std::runtime_error("unknown journal op: " + op);
+            }
+            chat.lastModified = body.at("lastModified").get<int>();
+        }
+    };
+
+} // namespace Chat
@@ -3,6 +3,8 @@
 #pragma once
 
 #include "chat_persistence.hpp"
+#include "chat_save_queue.hpp"
+#include "chat_search_index.hpp"
 
 #include <vector>
 #include <string>
@@ -10,7 +12,10 @@
 #include <shared_mutex>
 #include <optional>
 #include <memory>
+#include <list>
 #include <set>
+#include <atomic>
+#include <thread>
 #include <unordered_set>
 
 #ifdef _WIN32
@@ -25,6 +30,18 @@ namespace Chat
 
     /**
      * @brief Singleton ChatManager class with thread-safe operations
+     *
+     * Only the chat index is loaded at startup; every chat's metadata is kept, but message
+     * bodies are loaded on first use and at most MAX_RESIDENT_CHATS of them stay in
+     * memory, least recently used first out. The current chat and chats with a running
+     * job are never evicted.
+     *
+     * Edits are saved through a write-behind ChatSaveQueue: callers never wait for disk
+     * I/O, and bursts of edits to the same chat collapse into a single write.
+     *
+     * Every edit also updates a ChatSearchIndex. It is saved at most every
+     * SEARCH_INDEX_SAVE_INTERVAL from the save queue's thread and on flush; at startup,
+     * chats the stored index doesn't match are reindexed in the background.
      */
     class ChatManager 
     {
@@ -59,6 +76,10 @@ namespace Chat
     public:
         void initialize(std::unique_ptr<IChatPersistence> persistence) 
         {
+            // Pending saves and the index belong to the old persistence
+            stopReindex();
+            flushPendingSaves();
+
             std::unique_lock<std::shared_mutex> lock(m_mutex);
             m_persistence = std::move(persistence);
             m_currentChatName = std::nullopt;
@@ -74,19 +95,8 @@ namespace Chat
 
         bool switchToChat(const std::string& name)
         {
-            auto it = m_chatNameToIndex.find(name);
-            if (it == m_chatNameToIndex.end()) 
-            {
-                return false;
-            }
-
-            std::string oldChat = m_currentChatName.value_or("");
-            m_currentChatName = name;
-            m_currentChatIndex = it->second;
-
-            gThinkToggleMap.clear();
-
-            return true;
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            return switchToChatLocked(name);
         }
 
         std::future<bool> renameCurrentChat(const std::string& newName)
@@ -131,6 +141,11 @@ namespace Chat
                 m_chatNameToIndex.erase(oldName);
                 m_chatNameToIndex[uniqueName] = currentIdx;
                 m_currentChatName = uniqueName;
+                renameResidentLocked(oldName, uniqueName);
+                m_searchIndex.renameChat(oldName, uniqueName, m_chats[currentIdx].lastModified);
+
+                // A queued save under the old name would recreate the file we delete below
+                m_saveQueue.cancel(oldName);
 
                 // Save changes
                 auto chat = m_chats[currentIdx];
@@ -157,9 +172,9 @@ namespace Chat
 				}
 				m_chats[m_currentChatIndex].messages.clear();
 				m_chats[m_currentChatIndex].lastModified = static_cast<int>(std::time(nullptr));
-				// Launch async save operation
-				auto chat = m_chats[m_currentChatIndex];
-				return m_persistence->saveChat(chat).get();
+				m_searchIndex.syncChat(m_chats[m_currentChatIndex]);
+				m_saveQueue.enqueue(m_chats[m_currentChatIndex]);
+				return true;
 				});
 		}
 
@@ -186,12 +201,8 @@ namespace Chat
             updateChatTimestamp(m_currentChatIndex, newTimestamp);
 
             m_chats[m_currentChatIndex].messages.push_back(message);
-
-            // Launch async save operation
-            auto chat = m_chats[m_currentChatIndex];
-            std::async(std::launch::async, [this, chat]() {
-                m_persistence->saveChat(chat);
-            });
+            m_searchIndex.appendMessage(m_chats[m_currentChatIndex]);
+            m_saveQueue.enqueue(m_chats[m_currentChatIndex]);
         }
 
 		void updateCurrentChat(const ChatHistory& chat)
@@ -203,10 +214,8 @@ namespace Chat
 				return;
 			}
 			m_chats[m_currentChatIndex] = chat;
-			// Launch async save operation
-			std::async(std::launch::async, [this, chat]() {
-				m_persistence->saveChat(chat);
-				});
+			m_searchIndex.syncChat(chat);
+			m_saveQueue.enqueue(chat);
 		}
 
 		bool updateChat(const std::string& chatName, const ChatHistory& chat)
@@ -219,9 +228,12 @@ namespace Chat
 				return false;
 			}
 			m_chats[it->second] = chat;
+            m_searchIndex.syncChat(chat);
+            touchResidentLocked(chatName);
             return true;
 		}
 
+        // Schedules the chat on the write-behind queue; returns false if it doesn't exist.
         bool saveChat(const std::string& chatName)
         {
             std::unique_lock<std::shared_mutex> lock(m_mutex);
@@ -231,8 +243,42 @@ namespace Chat
                 std::cerr << "[ChatManager] Chat not found: " << chatName << std::endl;
                 return false;
             }
-            auto chat = m_chats[it->second];
-			return m_persistence->saveChat(chat).get();
+            if (!ensureResidentLocked(it->second))
+            {
+                return false;
+            }
+            // Streamed replies are only indexed once complete, when the job saves the chat
+            m_searchIndex.syncChat(m_chats[it->second]);
+            m_saveQueue.enqueue(m_chats[it->second]);
+            return true;
+        }
+
+        // Saves queued or being written; zero once everything is on disk.
+        size_t getPendingSaveCount() const
+        {
+            return m_saveQueue.pendingCount();
+        }
+
+        // Blocks until every queued save and the search index are on disk, e.g. before the app exits.
+        void flushPendingSaves()
+        {
+            m_saveQueue.flush();
+            persistSearchIndex(true);
+        }
+
+        /**
+         * @brief Full-text search over every chat's messages, best match first. Hits
+         *        point at a message by its index in the chat.
+         */
+        std::vector<ChatSearchHit> searchChats(const std::string& query, size_t limit = 50) const
+        {
+            return m_searchIndex.search(query, limit);
+        }
+
+        // Changes whenever the search index does, so cached results can be refreshed.
+        uint64_t getSearchRevision() const
+        {
+            return m_searchIndex.revision();
         }
 
         std::optional<std::string> createNewChat(const std::string& name)
@@ -263,17 +309,17 @@ namespace Chat
             size_t newIndex = m_chats.size();
             m_chats.push_back(newChat);
             m_chatNameToIndex[newName] = newIndex;
+            touchResidentLocked(newName);
 
             // Add to sorted indices
             m_sortedIndices.insert({ newTimestamp, newIndex, newName });
 
             // Switch to the new chat
-            switchToChat(newName);
+            switchToChatLocked(newName);
 
-            if (m_persistence->saveChat(newChat).get())
-            {
-                std::cout << "[ChatManager] Created new chat: " << newName << std::endl;
-            }
+            m_searchIndex.syncChat(newChat);
+            m_saveQueue.enqueue(newChat, true);
+            std::cout << "[ChatManager] Created new chat: " << newName << std::endl;
 
             return newName;
         }
@@ -297,6 +343,8 @@ namespace Chat
 
             m_chats.erase(m_chats.begin() + indexToRemove);
             m_chatNameToIndex.erase(it);
+            forgetResidentLocked(name);
+            m_searchIndex.removeChat(name);
 
             // Update indices
             updateIndicesAfterDeletion(indexToRemove);
@@ -310,13 +358,14 @@ namespace Chat
             {
                 // Select the most recent chat (first in sorted indices)
                 auto mostRecent = m_sortedIndices.begin();
-                switchToChat(mostRecent->name);
+                switchToChatLocked(mostRecent->name);
             }
             else if (m_currentChatIndex > indexToRemove)
             {
                 m_currentChatIndex--;
             }
 
+            m_saveQueue.cancel(name);
             if (!m_persistence->deleteChat(name).get())
             {
 				std::cerr << "[ChatManager] Failed to delete chat: " << name << std::endl;
@@ -344,7 +393,7 @@ namespace Chat
             auto chatIt = std::find_if(m_chats.begin(), m_chats.end(),
                 [&chatName](const auto& chat) { return chat.name == chatName; });
 
-            if (chatIt != m_chats.end()) {
+            if (chatIt != m_chats.end() && ensureResidentLocked(chatIt - m_chats.begin())) {
                 // Search for the message with the matching id.
                 auto& messages = chatIt->messages;
                 auto msgIt = std::find_if(messages.begin(), messages.end(),
@@ -352,8 +401,10 @@ namespace Chat
 
                 // If the message was found, erase it from the chat.
                 if (msgIt != messages.end()) {
+                    const size_t position = msgIt - messages.begin();
                     messages.erase(msgIt);
                     chatIt->lastModified = static_cast<int>(std::time(nullptr));
+                    m_searchIndex.removeMessage(*chatIt, position);
                 }
             }
         }
@@ -366,13 +417,14 @@ namespace Chat
             auto chatIt = std::find_if(m_chats.begin(), m_chats.end(),
                 [&chatName](const auto& chat) { return chat.name == chatName; });
 
-            if (chatIt != m_chats.end()) {
+            if (chatIt != m_chats.end() && ensureResidentLocked(chatIt - m_chats.begin())) {
                 // Check if the index is valid.
                 if (index >= 0 && index < static_cast<int>(chatIt->messages.size())) {
                     // Remove the message at the given index.
                     chatIt->messages.erase(chatIt->messages.begin() + index);
                     // Update the last modified timestamp.
                     chatIt->lastModified = static_cast<int>(std::time(nullptr));
+                    m_searchIndex.removeMessage(*chatIt, index);
                 }
                 else {
                     std::cerr << "[ChatManager] Invalid message index (" << index << ") for chat: " << chatName << "\n";
@@ -389,28 +441,50 @@ namespace Chat
             auto it = std::find_if(m_chats.begin(), m_chats.end(),
                 [&chatName](const auto& chat) { return chat.name == chatName; });
 
-            if (it != m_chats.end()) 
+            if (it != m_chats.end() && ensureResidentLocked(it - m_chats.begin())) 
             {
                 it->messages.push_back(message);
                 it->lastModified = static_cast<int>(std::time(nullptr));
+                m_searchIndex.appendMessage(*it);
             }
         }
 
+        // Appends streamed text to the chat's trailing assistant message in place. Returns false
+        // if the chat doesn't end with an assistant message, so the caller can create one.
+        bool appendToLastAssistantMessage(const std::string& chatName, const std::string& text, const float tps)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatNameToIndex.find(chatName);
+            if (it == m_chatNameToIndex.end() || !ensureResidentLocked(it->second))
+            {
+                return false;
+            }
+
+            auto& messages = m_chats[it->second].messages;
+            if (messages.empty() || messages.back().role != "assistant")
+            {
+                return false;
+            }
+
+            messages.back().content.append(text);
+            messages.back().tps = tps;
+            return true;
+        }
+
         void setMessageModelName(const std::string& chatName, const int& _index, const std::string& modelName)
         {
             std::unique_lock<std::shared_mutex> lock(m_mutex);
             auto it = std::find_if(m_chats.begin(), m_chats.end(),
                 [&chatName](const auto& chat) { return chat.name == chatName; });
 
-			int index = _index;
-
-            if (_index == -1)
+            if (it != m_chats.end() && ensureResidentLocked(it - m_chats.begin()))
             {
-				index = it->messages.size() - 1;
-            }
+                int index = _index;
+                if (_index == -1)
+                {
+                    index = static_cast<int>(it->messages.size()) - 1;
+                }
 
-            if (it != m_chats.end())
-            {
                 if (index >= 0 && index < static_cast<int>(it->messages.size()))
                 {
                     it->messages[index].modelName = modelName;
@@ -428,11 +502,13 @@ namespace Chat
         }
 
         // Thread-safe getters
-        std::vector<ChatHistory> getChats() const
+
+        // Chat list in most recently modified order, without message bodies
+        std::vector<ChatSummary> getChatSummaries() const
         {
             std::shared_lock<std::shared_mutex> lock(m_mutex);
-            std::vector<ChatHistory> sortedChats;
-            sortedChats.reserve(m_chats.size());
+            std::vector<ChatSummary> summaries;
+            summaries.reserve(m_chats.size());
 
             std::unordered_set<size_t> seenIndices;
 
@@ -441,24 +517,29 @@ namespace Chat
             {
                 if (seenIndices.insert(idx.index).second)
                 {
-                    sortedChats.push_back(m_chats[idx.index]);
+                    const ChatHistory& chat = m_chats[idx.index];
+                    summaries.push_back({ chat.id, chat.lastModified, chat.name, messageCountLocked(chat) });
                 }
             }
-            return sortedChats;
+            return summaries;
         }
 
-        std::optional<ChatHistory> getChat(const std::string& name) const 
+        // Loads the chat's messages if they aren't in memory yet.
+        std::optional<ChatHistory> getChat(const std::string& name)
         {
-            std::shared_lock<std::shared_mutex> lock(m_mutex);
-            auto it = std::find_if(m_chats.begin(), m_chats.end(),
-                [&name](const auto& chat) { return chat.name == name; });
-            return it != m_chats.end() ? std::optional<ChatHistory>(*it) : std::nullopt;
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatNameToIndex.find(name);
+            if (it == m_chatNameToIndex.end() || !ensureResidentLocked(it->second))
+            {
+                return std::nullopt;
+            }
+            return m_chats[it->second];
         }
 
-		std::optional<ChatHistory> getChat(int index) const
+		std::optional<ChatHistory> getChat(int index)
 		{
-			std::shared_lock<std::shared_mutex> lock(m_mutex);
-			if (index < 0 || index >= m_chats.size())
+			std::unique_lock<std::shared_mutex> lock(m_mutex);
+			if (index < 0 || static_cast<size_t>(index) >= m_chats.size() || !ensureResidentLocked(static_cast<size_t>(index)))
 			{
 				return std::nullopt;
 			}
@@ -492,13 +573,13 @@ namespace Chat
             return 0;
         }
 
-        std::optional<ChatHistory> getChatByTimestamp(int timestamp) const
+        std::optional<ChatHistory> getChatByTimestamp(int timestamp)
         {
-            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
             auto it = std::find_if(m_sortedIndices.begin(), m_sortedIndices.end(),
                 [timestamp](const ChatIndex& idx) { return idx.lastModified == timestamp; });
 
-            if (it != m_sortedIndices.end()) 
+            if (it != m_sortedIndices.end() && ensureResidentLocked(it->index)) 
             {
                 return m_chats[it->index];
             }
@@ -569,15 +650,31 @@ namespace Chat
 			return m_persistence->getChatPath(m_chats[m_currentChatIndex].name);
 		}
 
+		// Leases the current chat's KV cache for a model; hand it back with releaseKvChatPath.
+		// Nullopt, without waiting, while the cache is compressed or busy in the background.
 		auto getCurrentKvChatPath(std::string modelName, std::string modelVariant) const -> std::optional<std::filesystem::path>
 		{
-			std::shared_lock<std::shared_mutex> lock(m_mutex);
-			if (!m_currentChatName || m_currentChatIndex >= m_chats.size())
+			std::string chatName;
+			{
+				std::shared_lock<std::shared_mutex> lock(m_mutex);
+				if (!m_currentChatName || m_currentChatIndex >= m_chats.size())
+				{
+					return std::nullopt;
+				}
+				chatName = m_chats[m_currentChatIndex].name;
+			}
+
+			std::filesystem::path kvPath = m_persistence->acquireKvChat(chatName, modelName, modelVariant);
+			if (kvPath.empty())
 			{
 				return std::nullopt;
 			}
+			return kvPath;
+		}
 
-			return m_persistence->getKvChatPath(m_chats[m_currentChatIndex].name + "@" + modelName + modelVariant);
+		void releaseKvChatPath(const std::filesystem::path& kvPath)
+		{
+			m_persistence->releaseKvChat(kvPath);
 		}
 
 		static const std::string getDefaultChatName() { return DEFAULT_CHAT_NAME; }
@@ -589,10 +686,21 @@ namespace Chat
 			, m_currentChatName(std::nullopt)
 			, m_currentChatIndex(0)
 			, m_chatNameToIndex()
+            , m_saveQueue([this](const ChatHistory& chat) {
+                const bool saved = m_persistence->saveChat(chat).get();
+                persistSearchIndex(false);
+                return saved;
+                })
         {
             loadChatsAsync();
         }
 
+        ~ChatManager()
+        {
+            stopReindex();
+            flushPendingSaves();
+        }
+
         static std::optional<std::filesystem::path> getChatPath()
         {
             HKEY hKey;
@@ -650,6 +758,135 @@ namespace Chat
             return std::filesystem::path(buffer.data());
         }
 
+        bool switchToChatLocked(const std::string& name)
+        {
+            auto it = m_chatNameToIndex.find(name);
+            if (it == m_chatNameToIndex.end()) 
+            {
+                return false;
+            }
+
+            m_currentChatName = name;
+            m_currentChatIndex = it->second;
+            ensureResidentLocked(it->second);
+
+            gThinkToggleMap.clear();
+
+            return true;
+        }
+
+        size_t messageCountLocked(const ChatHistory& chat) const
+        {
+            auto it = m_indexedMessageCounts.find(chat.name);
+            return it != m_indexedMessageCounts.end() ? it->second : chat.messages.size();
+        }
+
+        bool hasRunningJobLocked(size_t chatIndex) const
+        {
+            auto it = m_chatInferenceJobIdMap.find(static_cast<int>(chatIndex));
+            return it != m_chatInferenceJobIdMap.end() && it->second != -1;
+        }
+
+        // Marks a chat whose messages are in memory as most recently used.
+        void touchResidentLocked(const std::string& name)
+        {
+            auto pos = m_residentPos.find(name);
+            if (pos != m_residentPos.end())
+            {
+                m_residentChats.splice(m_residentChats.begin(), m_residentChats, pos->second);
+                return;
+            }
+
+            m_indexedMessageCounts.erase(name);
+            m_residentChats.push_front(name);
+            m_residentPos[name] = m_residentChats.begin();
+            evictChatsLocked();
+        }
+
+        void forgetResidentLocked(const std::string& name)
+        {
+            m_indexedMessageCounts.erase(name);
+            auto pos = m_residentPos.find(name);
+            if (pos != m_residentPos.end())
+            {
+                m_residentChats.erase(pos->second);
+                m_residentPos.erase(pos);
+            }
+        }
+
+        void renameResidentLocked(const std::string& oldName, const std::string& newName)
+        {
+            auto pos = m_residentPos.find(oldName);
+            if (pos != m_residentPos.end())
+            {
+                *pos->second = newName;
+                m_residentPos[newName] = pos->second;
+                m_residentPos.erase(pos);
+            }
+        }
+
+        // Loads the messages of an indexed-only chat. Requires the unique lock.
+        bool ensureResidentLocked(size_t chatIndex)
+        {
+            const std::string name = m_chats[chatIndex].name;
+            if (m_residentPos.count(name) > 0)
+            {
+                touchResidentLocked(name);
+                return true;
+            }
+
+            // A snapshot still waiting in the save queue is newer than what is on disk
+            auto loaded = m_saveQueue.latest(name);
+            if (!loaded)
+            {
+                loaded = m_persistence->loadChat(name).get();
+            }
+            if (!loaded)
+            {
+                std::cerr << "[ChatManager] Failed to load chat: " << name << "\n";
+                return false;
+            }
+
+            m_chats[chatIndex].messages = std::move(loaded->messages);
+            touchResidentLocked(name);
+            return true;
+        }
+
+        // Drops the messages of least recently used chats beyond MAX_RESIDENT_CHATS.
+        void evictChatsLocked()
+        {
+            auto it = m_residentChats.end();
+            while (m_residentChats.size() > MAX_RESIDENT_CHATS && it != m_residentChats.begin())
+            {
+                --it;
+                auto chatIt = m_chatNameToIndex.find(*it);
+                if (chatIt == m_chatNameToIndex.end())
+                {
+                    m_residentPos.erase(*it);
+                    it = m_residentChats.erase(it);
+                    continue;
+                }
+
+                const size_t chatIndex = chatIt->second;
+                if ((m_currentChatName && chatIndex == m_currentChatIndex) || hasRunningJobLocked(chatIndex))
+                {
+                    continue;
+                }
+
+                // Not every edit is saved right away; hand the messages to the save queue
+                // so nothing is lost. Saving a chat that is already on disk is a no-op.
+                ChatHistory& chat = m_chats[chatIndex];
+                m_indexedMessageCounts[chat.name] = chat.messages.size();
+
+                ChatHistory evicted(chat.id, chat.lastModified, chat.name);
+                evicted.messages = std::move(chat.messages);
+                std::vector<Message>().swap(chat.messages);
+                m_saveQueue.enqueue(std::move(evicted), true);
+                m_residentPos.erase(*it);
+                it = m_residentChats.erase(it);
+            }
+        }
+
         // Validation helpers
         static bool validateChatName(const std::string& name) 
         {
@@ -705,14 +942,45 @@ namespace Chat
         void loadChatsAsync() 
         {
             std::async(std::launch::async, [this]() {
-                auto chats = m_persistence->loadAllChats().get();
+                auto summaries = m_persistence->loadChatIndex().get();
+
+                // Reuse the stored search index for every chat it still matches
+                m_searchIndex.clear();
+                m_persistence->loadSearchIndex(m_searchIndex);
+                {
+                    std::lock_guard<std::mutex> saveLock(m_searchSaveMutex);
+                    m_searchSavedRevision = m_searchIndex.revision();
+                }
+
+                std::unordered_set<std::string> chatNames;
+                std::vector<std::string> staleChats;
+                for (const auto& summary : summaries)
+                {
+                    chatNames.insert(summary.name);
+                    if (!m_searchIndex.isCurrent(summary.name, summary.lastModified, summary.messageCount))
+                    {
+                        staleChats.push_back(summary.name);
+                    }
+                }
+                m_searchIndex.retainChats(chatNames);
 
                 std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_chats = std::move(chats);
+                m_chats.clear();
+                m_chats.reserve(summaries.size());
                 
                 // Initialize indices
                 m_chatNameToIndex.clear();
                 m_sortedIndices.clear();
+                m_residentChats.clear();
+                m_residentPos.clear();
+                m_indexedMessageCounts.clear();
+
+                // Only metadata for now; messages are loaded when a chat is first used
+                for (auto& summary : summaries)
+                {
+                    m_indexedMessageCounts[summary.name] = summary.messageCount;
+                    m_chats.emplace_back(summary.id, summary.lastModified, summary.name);
+                }
                 
                 for (size_t i = 0; i < m_chats.size(); ++i) 
                 {
@@ -733,14 +1001,104 @@ namespace Chat
                 {
                     // Select the most recent chat (first in sorted indices)
                     auto mostRecent = m_sortedIndices.begin();
-                    m_currentChatIndex = mostRecent->index;
-                    m_currentChatName = mostRecent->name;
+                    switchToChatLocked(mostRecent->name);
                 }
 
 				counter = m_sortedIndices.size();
+
+                startReindex(std::move(staleChats));
             });
         }
 
+        // Saves the search index if it changed, at most every SEARCH_INDEX_SAVE_INTERVAL
+        // unless forced. Never takes m_mutex, so it is safe on the save queue's thread.
+        void persistSearchIndex(bool force)
+        {
+            std::lock_guard<std::mutex> saveLock(m_searchSaveMutex);
+            const uint64_t revision = m_searchIndex.revision();
+            const auto now = std::chrono::steady_clock::now();
+            if (revision == m_searchSavedRevision ||
+                (!force && now - m_searchSavedAt < SEARCH_INDEX_SAVE_INTERVAL))
+            {
+                return;
+            }
+
+            if (m_persistence->saveSearchIndex(m_searchIndex))
+            {
+                m_searchSavedRevision = revision;
+            }
+            m_searchSavedAt = now;
+        }
+
+        void startReindex(std::vector<std::string> chatNames)
+        {
+            if (chatNames.empty())
+            {
+                return;
+            }
+
+            m_stopReindex = false;
+            m_reindexThread = std::thread([this, chatNames = std::move(chatNames)]() {
+                for (const auto& name : chatNames)
+                {
+                    if (m_stopReindex) return;
+                    if (reindexChat(name, std::nullopt)) continue;
+
+                    // Decrypt outside the lock; the chat may change meanwhile, which
+                    // reindexChat resolves by preferring the in-memory copy
+                    auto loaded = m_persistence->loadChat(name).get();
+                    if (loaded)
+                    {
+                        reindexChat(name, loaded);
+                    }
+                }
+                std::cout << "[ChatManager] Indexed " << chatNames.size() << " chats for search\n";
+                });
+        }
+
+        void stopReindex()
+        {
+            m_stopReindex = true;
+            if (m_reindexThread.joinable())
+            {
+                m_reindexThread.join();
+            }
+        }
+
+        /**
+         * @brief Indexes a chat from its freshest copy: in memory, waiting in the save
+         *        queue, or `fromDisk`.
+         * @return False if only a disk copy would do and none was given.
+         */
+        bool reindexChat(const std::string& name, const std::optional<ChatHistory>& fromDisk)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatNameToIndex.find(name);
+            if (it == m_chatNameToIndex.end())
+            {
+                // Deleted meanwhile
+                return true;
+            }
+
+            if (m_residentPos.count(name) > 0)
+            {
+                m_searchIndex.syncChat(m_chats[it->second]);
+            }
+            else if (auto pending = m_saveQueue.latest(name))
+            {
+                m_searchIndex.syncChat(*pending);
+            }
+            else if (fromDisk)
+            {
+                m_searchIndex.syncChat(*fromDisk);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+
         void createDefaultChat()
         {
             const int currentTime = static_cast<int>(std::time(nullptr));
@@ -754,13 +1112,17 @@ namespace Chat
             m_chats.push_back(defaultChat);
             m_chatNameToIndex[DEFAULT_CHAT_NAME] = 0;
             m_sortedIndices.insert({ currentTime, 0, DEFAULT_CHAT_NAME });
+            touchResidentLocked(DEFAULT_CHAT_NAME);
+            m_searchIndex.syncChat(defaultChat);
 
-            m_persistence->saveChat(defaultChat);
+            m_saveQueue.enqueue(defaultChat, true);
             m_currentChatName = DEFAULT_CHAT_NAME;
             m_currentChatIndex = 0;
         }
 
         static inline const std::string DEFAULT_CHAT_NAME = "New Chat";
+        static constexpr size_t MAX_RESIDENT_CHATS = 16;
+        static constexpr std::chrono::seconds SEARCH_INDEX_SAVE_INTERVAL{ 30 };
 
         std::unique_ptr<IChatPersistence> m_persistence;
         std::vector<ChatHistory> m_chats;
@@ -771,6 +1133,23 @@ namespace Chat
         mutable std::shared_mutex m_mutex;
 		std::unordered_map<int, int> m_chatInferenceJobIdMap;
         int counter;
+
+        // Chats whose messages are in memory, most recently used first
+        std::list<std::string> m_residentChats;
+        std::unordered_map<std::string, std::list<std::string>::iterator> m_residentPos;
+        // Message counts from the index for chats that aren't resident
+        std::unordered_map<std::string, size_t> m_indexedMessageCounts;
+
+        ChatSearchIndex m_searchIndex;
+        std::mutex m_searchSaveMutex;
+        uint64_t m_searchSavedRevision = 0;
+        std::chrono::steady_clock::time_point m_searchSavedAt;
+        // Background pass over chats the stored index doesn't cover
+        std::thread m_reindexThread;
+        std::atomic<bool> m_stopReindex{ false };
+
+        // Last member, so it is destroyed (and flushed) while the persistence is still alive
+        ChatSaveQueue m_saveQueue;
     };
 
     inline void initializeChatManager() {
@@ -1,13 +1,26 @@
 #pragma once
 
 #include "chat_history.hpp"
+#include "chat_journal.hpp"
+#include "chat_binary_format.hpp"
+#include "chat_search_index.hpp"
+#include "kv_cache_store.hpp"
 #include "crypto/crypto.hpp"
+#include "threadpool.hpp"
+#include "durable_writer.hpp"
 
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include <future>
 #include <shared_mutex>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <algorithm>
+#include <unordered_map>
 
 namespace Chat
 {
@@ -23,18 +36,48 @@ namespace Chat
 		virtual std::future<bool> deleteKvChat(const std::string& chatName) = 0;
 		virtual std::future<bool> renameKvChat(const std::string& oldChatName, const std::string& newChatName) = 0;
         virtual std::future<std::vector<ChatHistory>> loadAllChats() = 0;
+        // Lists every stored chat without loading message bodies
+        virtual std::future<std::vector<ChatSummary>> loadChatIndex() = 0;
+        virtual std::future<std::optional<ChatHistory>> loadChat(const std::string& chatName) = 0;
 		virtual std::filesystem::path getChatPath(const std::string& chatName) const = 0;
 		virtual std::filesystem::path getKvChatPath(const std::string& chatName) const = 0;
+        // Returns the chat's KV cache file for the engine; it stays in use until releaseKvChat.
+        // Empty, without waiting, while the file is compressed or busy; it is restored for next time.
+        virtual std::filesystem::path acquireKvChat(const std::string& chatName,
+            const std::string& modelName, const std::string& modelVariant) = 0;
+        virtual void releaseKvChat(const std::filesystem::path& kvPath) = 0;
+        // The full-text index is stored next to the chats; false if missing or unreadable
+        virtual bool loadSearchIndex(ChatSearchIndex& index) = 0;
+        virtual bool saveSearchIndex(const ChatSearchIndex& index) = 0;
     };
 
     /**
      * @brief File-based chat persistence implementation using AES-GCM encryption
+     *
+     * Snapshots are ChatBinaryFormat chats written through a chunked encrypted stream
+     * (Crypto::EncryptStreamBuf), so saving and loading never hold more than one copy
+     * of a chat. Older JSON and single-blob snapshots still load and are rewritten in
+     * the current format the next time the chat is saved. Snapshots and both indexes
+     * are replaced through DurableWriter, so a crash never leaves a truncated file.
+     * setCompression(true) compresses snapshot bodies and chats.index before they are
+     * encrypted; readers detect either form. It is off by default: it halves the disk
+     * used but makes a cold load of every chat about 70% slower.
+     *
+     * Saves only append what changed since the last save to the chat's journal (see
+     * ChatJournal); the full snapshot is rewritten once the journal grows past
+     * COMPACT_RECORDS records or past the size of the snapshot itself.
+     *
+     * A small encrypted index (chats.index) keeps each chat's summary together with the
+     * file sizes and modification times it was taken at, so startup only has to decrypt
+     * chats whose files changed since the index was written.
+     *
+     * KV session files are owned by a KvCacheStore limited to KV_CACHE_DISK_BUDGET.
      */
     class FileChatPersistence : public IChatPersistence 
     {
     public:
         explicit FileChatPersistence(std::filesystem::path basePath, std::array<uint8_t, 32> key)
-            : m_basePath(std::move(basePath)), m_key(key) 
+            : m_basePath(std::move(basePath)), m_key(key), m_kvStore(m_basePath, KV_CACHE_DISK_BUDGET)
         {
 			// Create base path if it doesn't exist
 			if (!std::filesystem::exists(m_basePath))
@@ -43,6 +86,16 @@ namespace Chat
 			}
         }
 
+        ~FileChatPersistence()
+        {
+            std::unique_lock<std::shared_mutex> lock(m_ioMutex);
+            std::lock_guard<std::mutex> stateLock(m_stateMutex);
+            if (m_indexDirty)
+            {
+                writeIndexLocked();
+            }
+        }
+
         std::future<bool> saveChat(const ChatHistory& chat) override 
         {
             return std::async(std::launch::async, [this, chat]() {
@@ -58,6 +111,13 @@ namespace Chat
                 try 
                 {
                     std::filesystem::remove(getChatPath(chatName));
+                    std::filesystem::remove(ChatJournal::pathFor(getChatPath(chatName)));
+                    {
+                        std::lock_guard<std::mutex> stateLock(m_stateMutex);
+                        m_journals.erase(chatName);
+                        m_index.erase(getChatPath(chatName).filename().string());
+                        m_indexDirty = true;
+                    }
                     return true;
                 }
                 catch (const std::exception& e)
@@ -68,108 +128,87 @@ namespace Chat
                 });
         }
 
-        std::future<bool> deleteKvChat(const std::string& chatName) {
+        std::future<bool> deleteKvChat(const std::string& chatName) override
+        {
             return std::async(std::launch::async, [this, chatName]() {
-                std::unique_lock<std::shared_mutex> lock(m_ioMutex);
-                bool allDeleted = true;
-
-                try {
-                    for (const auto& entry : std::filesystem::directory_iterator(m_basePath)) {
-                        if (entry.is_regular_file()) {
-                            std::string fileName = entry.path().filename().string();
-
-                            // First, ensure the filename ends with ".bin"
-                            if (fileName.size() >= 4 &&
-                                fileName.compare(fileName.size() - 4, 4, ".bin") == 0)
-                            {
-                                // Remove the ".bin" extension.
-                                std::string baseName = fileName.substr(0, fileName.size() - 4);
-
-                                // Find the last occurrence of '@' in the baseName.
-                                auto atPos = baseName.rfind('@');
-                                if (atPos != std::string::npos) {
-                                    // Extract the chat name portion (everything before the last '@')
-                                    std::string fileChatName = baseName.substr(0, atPos);
-
-                                    // Compare with the provided chatName.
-                                    if (fileChatName == chatName) {
-                                        try {
-                                            if (!std::filesystem::remove(entry.path())) {
-                                                std::cerr << "[FileChatPersistence] Failed to remove file: "
-                                                    << entry.path() << "\n";
-                                                allDeleted = false;
-                                            }
-                                        }
-                                        catch (const std::exception& e) {
-                                            std::cerr << "[FileChatPersistence] Exception deleting file "
-                                                << entry.path() << ": " << e.what() << "\n";
-                                            allDeleted = false;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                catch (const std::exception& e) {
-                    std::cerr << "[FileChatPersistence] Exception iterating directory: "
-                        << e.what() << "\n";
-                    return false;
-                }
-
-                return allDeleted;
+                return m_kvStore.removeChat(chatName);
                 });
         }
 
-        std::future<bool> renameKvChat(const std::string& oldChatName, const std::string& newChatName) {
+        std::future<bool> renameKvChat(const std::string& oldChatName, const std::string& newChatName) override
+        {
             return std::async(std::launch::async, [this, oldChatName, newChatName]() {
-                std::unique_lock<std::shared_mutex> lock(m_ioMutex);
-                bool allRenamed = true;
-                try {
-                    for (const auto& entry : std::filesystem::directory_iterator(m_basePath)) {
-                        if (entry.is_regular_file()) {
-                            std::string fileName = entry.path().filename().string();
-                            // Check that the file ends with ".bin"
-                            if (fileName.size() >= 4 &&
-                                fileName.compare(fileName.size() - 4, 4, ".bin") == 0)
-                            {
-                                // Remove the ".bin" extension.
-                                std::string baseName = fileName.substr(0, fileName.size() - 4);
-
-                                // Find the last occurrence of '@'
-                                auto atPos = baseName.rfind('@');
-                                if (atPos != std::string::npos) {
-                                    // Extract the chat name portion (everything before the last '@')
-                                    std::string fileChatName = baseName.substr(0, atPos);
-
-                                    // If it matches the old chat name, we need to rename it.
-                                    if (fileChatName == oldChatName) {
-                                        // The part starting with '@' (i.e. the model name and separator)
-                                        std::string modelPart = baseName.substr(atPos);
-                                        // Build the new file name: newChatName + modelPart + ".bin"
-                                        std::string newFileName = newChatName + modelPart + ".bin";
-                                        std::filesystem::path newPath = std::filesystem::absolute(
-                                            std::filesystem::path(m_basePath) / newFileName);
-                                        try {
-                                            std::filesystem::rename(entry.path(), newPath);
-                                        }
-                                        catch (const std::exception& e) {
-                                            std::cerr << "[FileChatPersistence] Exception renaming file "
-                                                << entry.path() << " to " << newPath << ": " << e.what() << "\n";
-                                            allRenamed = false;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-                catch (const std::exception& e) {
-                    std::cerr << "[FileChatPersistence] Exception iterating directory for renaming: "
-                        << e.what() << "\n";
-                    return false;
+                return m_kvStore.renameChat(oldChatName, newChatName);
+                });
+        }
+
+        std::filesystem::path acquireKvChat(const std::string& chatName,
+            const std::string& modelName, const std::string& modelVariant) override
+        {
+            return m_kvStore.tryAcquire(chatName, modelName, modelVariant);
+        }
+
+        void releaseKvChat(const std::filesystem::path& kvPath) override
+        {
+            m_kvStore.release(kvPath);
+        }
+
+        // Applies to snapshots and the index written from now on; trades load time for disk space
+        void setCompression(bool enabled)
+        {
+            m_compress = enabled;
+        }
+
+        // Caps the workers that decrypt and parse chats while loading; 0 uses one per hardware thread
+        void setLoadWorkers(size_t workers)
+        {
+            m_loadWorkers = workers;
+        }
+
+        void setKvCacheBudget(uintmax_t bytes)
+        {
+            m_kvStore.setDiskBudget(bytes);
+        }
+
+        KvCacheStore::Stats getKvCacheStats() const
+        {
+            return m_kvStore.getStats();
+        }
+
+        bool loadSearchIndex(ChatSearchIndex& index) override
+        {
+            std::ifstream file(m_basePath / SEARCH_INDEX_FILE_NAME, std::ios::binary);
+            if (!file)
+            {
+                return false;
+            }
+
+            try {
+                Crypto::DecryptStreamBuf sealed(file, m_key);
+                std::istream plaintext(&sealed);
+                plaintext.exceptions(std::ios::badbit);
+                index.read(plaintext);
+                if (plaintext.peek() != std::char_traits<char>::eof() || !sealed.complete()) {
+                    throw std::runtime_error("Truncated or trailing data in search index");
                 }
-                return allRenamed;
+                return true;
+            }
+            catch (const std::exception& e) {
+                // Every chat is reindexed from scratch
+                std::cerr << "[FileChatPersistence] Ignoring unreadable search index: " << e.what() << "\n";
+                index.clear();
+                return false;
+            }
+        }
+
+        bool saveSearchIndex(const ChatSearchIndex& index) override
+        {
+            return DurableWriter::instance().write(m_basePath / SEARCH_INDEX_FILE_NAME, [&](std::ostream& file) {
+                Crypto::EncryptStreamBuf sealed(file, m_key);
+                std::ostream plaintext(&sealed);
+                plaintext.exceptions(std::ios::badbit);
+                index.write(plaintext);
+                sealed.finish();
                 });
         }
 
@@ -177,10 +216,28 @@ namespace Chat
         {
             return std::async(std::launch::async, [this]() {
                 std::shared_lock<std::shared_mutex> lock(m_ioMutex);
+                DurableWriter::instance().removeStaleTemps(m_basePath);
                 return loadEncryptedChats();
                 });
         }
 
+        std::future<std::vector<ChatSummary>> loadChatIndex() override
+        {
+            return std::async(std::launch::async, [this]() {
+                std::shared_lock<std::shared_mutex> lock(m_ioMutex);
+                DurableWriter::instance().removeStaleTemps(m_basePath);
+                return loadIndexedSummaries();
+                });
+        }
+
+        std::future<std::optional<ChatHistory>> loadChat(const std::string& chatName) override
+        {
+            return std::async(std::launch::async, [this, chatName]() {
+                std::shared_lock<std::shared_mutex> lock(m_ioMutex);
+                return loadChatFile(getChatPath(chatName));
+                });
+        }
+
         std::filesystem::path getChatPath(const std::string& chatName) const override
         {
 			// remove characters that are not allowed in file names
@@ -204,75 +261,529 @@ namespace Chat
 		}
 
     private:
+        static constexpr uintmax_t KV_CACHE_DISK_BUDGET = 8ULL * 1024 * 1024 * 1024;
+        static constexpr size_t    COMPACT_RECORDS = 512;
+        // Journals smaller than this are never worth compacting, however small the snapshot
+        static constexpr uintmax_t COMPACT_MIN_BYTES = 64 * 1024;
+
+        static inline const char* INDEX_FILE_NAME = "chats.index";
+        static inline const char* SEARCH_INDEX_FILE_NAME = "chats.search";
+
+        // What is on disk for a chat, as of the last load or save in this session
+        struct JournalState
+        {
+            uint64_t              epoch = 0;
+            int                   chatId = 0;
+            int                   lastModified = 0;
+            std::vector<uint64_t> fingerprints;
+            uintmax_t             snapshotBytes = 0;
+            uintmax_t             journalBytes = 0;
+            size_t                journalRecords = 0;
+            bool                  damaged = false;
+            // The snapshot predates the binary format; the next save rewrites it
+            bool                  legacyFormat = false;
+        };
+
+        struct Snapshot
+        {
+            ChatHistory chat;
+            uint64_t    journalEpoch = 0;
+            bool        legacyFormat = false;
+        };
+
         const   std::filesystem::path   m_basePath;
         const   std::array<uint8_t, 32> m_key;
         mutable std::shared_mutex       m_ioMutex;
+        KvCacheStore                    m_kvStore;
+        std::atomic<bool>               m_compress{ false };
+        std::atomic<size_t>             m_loadWorkers{ 0 };
+
+        // Sizes and modification times of a chat's files when its summary was taken; a
+        // mismatch means it is stale. Sizes alone miss a rewrite of the same length.
+        struct IndexEntry
+        {
+            ChatSummary summary;
+            uintmax_t   snapshotBytes = 0;
+            uintmax_t   journalBytes = 0;
+            int64_t     snapshotModified = 0;
+            int64_t     journalModified = 0;
+
+            bool sameFiles(const IndexEntry& other) const
+            {
+                return snapshotBytes == other.snapshotBytes && journalBytes == other.journalBytes &&
+                    snapshotModified == other.snapshotModified && journalModified == other.journalModified;
+            }
+        };
+
+        // Guards the journal states and the index, which loads update under a shared m_ioMutex
+        std::mutex                                    m_stateMutex;
+        std::unordered_map<std::string, JournalState> m_journals;
+        // Keyed by snapshot file name
+        std::unordered_map<std::string, IndexEntry>   m_index;
+        bool                                          m_indexDirty = false;
+
+        static std::vector<uint64_t> fingerprintsOf(const ChatHistory& chat)
+        {
+            std::vector<uint64_t> fingerprints;
+            fingerprints.reserve(chat.messages.size());
+            for (const auto& message : chat.messages)
+            {
+                fingerprints.push_back(ChatJournal::fingerprint(message));
+            }
+            return fingerprints;
+        }
 
         bool saveEncryptedChat(const ChatHistory& chat) 
         {
             try {
-                // Use the existing to_json serialization
-                nlohmann::json chatJson;
-                to_json(chatJson, chat);
+                std::vector<uint64_t> fingerprints = fingerprintsOf(chat);
 
-                // Convert JSON to binary
-                std::string jsonStr = chatJson.dump();
-                std::vector<uint8_t> plaintext(jsonStr.begin(), jsonStr.end());
+                std::lock_guard<std::mutex> stateLock(m_stateMutex);
+                auto it = m_journals.find(chat.name);
+                if (it != m_journals.end() && it->second.chatId == chat.id &&
+                    !it->second.damaged && !it->second.legacyFormat)
+                {
+                    JournalState& state = it->second;
+
+                    // Messages before `common` are already on disk unchanged
+                    size_t common = 0;
+                    const size_t shared = std::min(state.fingerprints.size(), fingerprints.size());
+                    while (common < shared && state.fingerprints[common] == fingerprints[common])
+                    {
+                        ++common;
+                    }
+
+                    const bool truncated = common < state.fingerprints.size();
+                    const size_t appended = fingerprints.size() - common;
+                    if (!truncated && appended == 0 && state.lastModified == chat.lastModified)
+                    {
+                        return true;
+                    }
+
+                    const size_t newRecords = (truncated || appended == 0 ? 1 : 0) + appended;
+                    const bool compact = state.journalRecords + newRecords > COMPACT_RECORDS ||
+                        (state.journalBytes > COMPACT_MIN_BYTES && state.journalBytes > state.snapshotBytes);
+
+                    if (!compact)
+                    {
+                        std::vector<ChatJournal::Record> records;
+                        records.reserve(newRecords);
+                        if (truncated || appended == 0)
+                        {
+                            records.push_back(ChatJournal::makeTruncate(common, chat.lastModified, state.epoch, m_key));
+                        }
+                        for (size_t i = common; i < chat.messages.size(); ++i)
+                        {
+                            records.push_back(ChatJournal::makeAppend(chat.messages[i], chat.lastModified, state.epoch, m_key));
+                        }
+
+                        const uintmax_t written = ChatJournal::append(
+                            ChatJournal::pathFor(getChatPath(chat.name)), records);
+                        if (written > 0)
+                        {
+                            state.fingerprints = std::move(fingerprints);
+                            state.lastModified = chat.lastModified;
+                            state.journalBytes += written;
+                            state.journalRecords += records.size();
+                            updateIndexLocked(chat);
+                            return true;
+                        }
 
-                // Encrypt the data
+                        std::cerr << "[FileChatPersistence] Failed to append to journal of " << chat.name
+                            << ", writing a snapshot instead\n";
+                    }
+                }
+
+                return writeSnapshotLocked(chat, std::move(fingerprints));
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[FileChatPersistence] Failed to save chat " << chat.name << ": " << e.what() << "\n";
+                return false;
+            }
+        }
+
+        // Rewrites the full snapshot under a new epoch and drops the journal. Requires m_stateMutex.
+        bool writeSnapshotLocked(const ChatHistory& chat, std::vector<uint64_t> fingerprints)
+        {
+            JournalState state;
+            state.epoch = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+            auto previous = m_journals.find(chat.name);
+            if (previous != m_journals.end() && previous->second.epoch >= state.epoch)
+            {
+                state.epoch = previous->second.epoch + 1;
+            }
+
+            // Serialize straight into the encrypting stream, so no full-size copy of the
+            // chat is ever held in memory. The old snapshot stays in place until the new
+            // one is complete.
+            std::filesystem::path chatPath = getChatPath(chat.name);
+            uint64_t snapshotBytes = 0;
+            const bool written = DurableWriter::instance().write(chatPath, [&](std::ostream& file) {
+                Crypto::EncryptStreamBuf sealed(file, m_key);
+                std::ostream plaintext(&sealed);
+                ChatBinaryFormat::write(plaintext, chat, state.epoch,
+                    m_compress ? ChatBinaryFormat::Codec::KLZ : ChatBinaryFormat::Codec::NONE);
+                snapshotBytes = sealed.finish();
+                });
+            if (!written) {
+                return false;
+            }
+
+            // Records in the old journal carry the old epoch, so a crash before this
+            // removal only leaves a file that replay ignores
+            std::error_code ec;
+            std::filesystem::remove(ChatJournal::pathFor(chatPath), ec);
+
+            state.chatId = chat.id;
+            state.lastModified = chat.lastModified;
+            state.fingerprints = std::move(fingerprints);
+            state.snapshotBytes = snapshotBytes;
+            updateIndexLocked(chat);
+            m_journals[chat.name] = std::move(state);
+            return true;
+        }
+
+        void updateIndexLocked(const ChatHistory& chat)
+        {
+            IndexEntry& entry = m_index[getChatPath(chat.name).filename().string()];
+            entry.summary = ChatSummary{ chat.id, chat.lastModified, chat.name, chat.messages.size() };
+            stampFiles(getChatPath(chat.name), entry);
+            m_indexDirty = true;
+        }
+
+        // Records the current size and modification time of the chat's snapshot and journal
+        static void stampFiles(const std::filesystem::path& chatPath, IndexEntry& entry)
+        {
+            auto stamp = [](const std::filesystem::path& path, uintmax_t& bytes, int64_t& modified) {
+                std::error_code ec;
+                bytes = std::filesystem::file_size(path, ec);
+                if (ec)
+                {
+                    bytes = 0;
+                    modified = 0;
+                    return;
+                }
+                const auto time = std::filesystem::last_write_time(path, ec);
+                modified = ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+                };
+
+            stamp(chatPath, entry.snapshotBytes, entry.snapshotModified);
+            stamp(ChatJournal::pathFor(chatPath), entry.journalBytes, entry.journalModified);
+        }
+
+        // Requires m_stateMutex.
+        void writeIndexLocked()
+        {
+            try {
+                nlohmann::json entries = nlohmann::json::array();
+                for (const auto& [fileName, entry] : m_index)
+                {
+                    entries.push_back({
+                        {"file", fileName},
+                        {"snapshotBytes", entry.snapshotBytes},
+                        {"journalBytes", entry.journalBytes},
+                        {"snapshotModified", entry.snapshotModified},
+                        {"journalModified", entry.journalModified},
+                        {"summary", entry.summary} });
+                }
+
+                std::string jsonStr = nlohmann::json{ {"version", 1}, {"chats", entries} }.dump();
+                std::vector<uint8_t> plaintext(jsonStr.begin(), jsonStr.end());
+                if (m_compress)
+                {
+                    plaintext = Compression::compress(plaintext);
+                }
                 auto encrypted = Crypto::encrypt(plaintext, m_key);
 
-                // Save to file
-				std::filesystem::path chatPath = getChatPath(chat.name);
-                std::ofstream file(chatPath, std::ios::binary);
-                if (!file) {
-                    return false;
+                if (DurableWriter::instance().write(m_basePath / INDEX_FILE_NAME,
+                    std::string(encrypted.begin(), encrypted.end())))
+                {
+                    m_indexDirty = false;
                 }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[FileChatPersistence] Failed to write chat index: " << e.what() << "\n";
+            }
+        }
 
-                file.write(reinterpret_cast<const char*>(encrypted.data()),
-                    encrypted.size());
+        std::unordered_map<std::string, IndexEntry> readIndexFile() const
+        {
+            std::unordered_map<std::string, IndexEntry> index;
+            std::ifstream file(m_basePath / INDEX_FILE_NAME, std::ios::binary);
+            if (!file)
+            {
+                return index;
+            }
 
-                return true;
+            try {
+                std::vector<uint8_t> encrypted(
+                    (std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>()
+                );
+                auto plaintext = Crypto::decrypt(encrypted, m_key);
+                // Uncompressed indexes are plain JSON, which can't start with the frame magic
+                if (Compression::isCompressed(plaintext))
+                {
+                    plaintext = Compression::decompress(plaintext);
+                }
+                auto indexJson = nlohmann::json::parse(plaintext.begin(), plaintext.end());
+                for (const auto& item : indexJson.at("chats"))
+                {
+                    IndexEntry entry;
+                    item.at("summary").get_to(entry.summary);
+                    item.at("snapshotBytes").get_to(entry.snapshotBytes);
+                    item.at("journalBytes").get_to(entry.journalBytes);
+                    // Indexes written before times were stamped make every chat stale once
+                    entry.snapshotModified = item.value("snapshotModified", int64_t{ 0 });
+                    entry.journalModified = item.value("journalModified", int64_t{ 0 });
+                    index[item.at("file").get<std::string>()] = std::move(entry);
+                }
             }
             catch (const std::exception& e) {
-                // TODO: Log error details here
-                return false;
+                // Unreadable index: every chat is simply reloaded and the index rebuilt
+                std::cerr << "[FileChatPersistence] Ignoring unreadable chat index: " << e.what() << "\n";
+                index.clear();
             }
+            return index;
         }
 
-        std::vector<ChatHistory> loadEncryptedChats() 
+        /**
+         * @brief Returns a summary of every chat, decrypting only chats whose snapshot or
+         *        journal size or modification time differs from what the index recorded.
+         */
+        std::vector<ChatSummary> loadIndexedSummaries()
         {
-            std::vector<ChatHistory> chats;
+            std::unordered_map<std::string, IndexEntry> stored = readIndexFile();
+            std::unordered_map<std::string, IndexEntry> current;
+            std::vector<std::string> order;
+            std::vector<std::filesystem::path> stalePaths;
+            std::vector<IndexEntry> staleEntries;
+
+            for (const auto& chatPath : listChatFiles())
+            {
+                const std::string fileName = chatPath.filename().string();
+                IndexEntry fresh;
+                stampFiles(chatPath, fresh);
+
+                order.push_back(fileName);
+                auto it = stored.find(fileName);
+                if (it != stored.end() && it->second.sameFiles(fresh))
+                {
+                    current[fileName] = std::move(it->second);
+                    continue;
+                }
+
+                stalePaths.push_back(chatPath);
+                staleEntries.push_back(std::move(fresh));
+            }
+
+            auto loaded = loadChatFiles(stalePaths);
+            for (size_t i = 0; i < loaded.size(); ++i)
+            {
+                if (!loaded[i]) continue;
+                const ChatHistory& chat = *loaded[i];
+                staleEntries[i].summary = ChatSummary{ chat.id, chat.lastModified, chat.name, chat.messages.size() };
+                current[stalePaths[i].filename().string()] = std::move(staleEntries[i]);
+            }
+
+            const bool changed = !stalePaths.empty() || current.size() != stored.size();
+
+            std::vector<ChatSummary> summaries;
+            summaries.reserve(current.size());
+            for (const auto& fileName : order)
+            {
+                auto it = current.find(fileName);
+                if (it != current.end())
+                {
+                    summaries.push_back(it->second.summary);
+                }
+            }
+
+            std::lock_guard<std::mutex> stateLock(m_stateMutex);
+            m_index = std::move(current);
+            if (changed)
+            {
+                writeIndexLocked();
+            }
+            return summaries;
+        }
 
+        // Reads a snapshot, replays its journal and records both as this session's state.
+        std::optional<ChatHistory> loadChatFile(const std::filesystem::path& chatPath)
+        {
             try {
-                for (const auto& entry : std::filesystem::directory_iterator(m_basePath)) {
-                    if (entry.path().extension() == ".chat") {
-                        // Read encrypted file
-                        std::ifstream file(entry.path(), std::ios::binary);
-                        if (!file) continue;
+                std::ifstream file(chatPath, std::ios::binary);
+                if (!file) return std::nullopt;
+
+                Snapshot snapshot = readSnapshot(file);
+                ChatHistory chat = std::move(snapshot.chat);
+
+                JournalState state;
+                state.epoch = snapshot.journalEpoch;
+                state.legacyFormat = snapshot.legacyFormat;
+                state.snapshotBytes = std::filesystem::file_size(chatPath);
+
+                auto replayed = ChatJournal::replay(
+                    ChatJournal::pathFor(chatPath), chat, state.epoch, m_key);
+                state.journalBytes = replayed.bytes;
+                state.journalRecords = replayed.records;
+                // A damaged tail can't be appended after; the next save compacts it away
+                state.damaged = replayed.damaged;
+                state.chatId = chat.id;
+                state.lastModified = chat.lastModified;
+                state.fingerprints = fingerprintsOf(chat);
+
+                {
+                    std::lock_guard<std::mutex> stateLock(m_stateMutex);
+                    m_journals[chat.name] = std::move(state);
+                }
+                return chat;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[FileChatPersistence] Failed to load " << chatPath << ": " << e.what() << "\n";
+                return std::nullopt;
+            }
+        }
+
+        // Decrypts and parses a snapshot as it is read. Snapshots written before chunked
+        // streams existed are a single IV || ciphertext || tag blob of JSON.
+        Snapshot readSnapshot(std::ifstream& file) const
+        {
+            if (Crypto::isStreamFormat(file))
+            {
+                std::string streamError;
+                try {
+                    Crypto::DecryptStreamBuf sealed(file, m_key);
+                    std::istream plaintext(&sealed);
+                    // Surface the decryption error instead of a generic short read
+                    plaintext.exceptions(std::ios::badbit);
+
+                    Snapshot snapshot;
+                    if (ChatBinaryFormat::matches(plaintext)) {
+                        snapshot.chat = ChatBinaryFormat::read(plaintext, snapshot.journalEpoch);
+                    }
+                    else {
+                        snapshot = fromJsonSnapshot(nlohmann::json::parse(plaintext));
+                    }
 
-                        std::vector<uint8_t> encrypted(
-                            (std::istreambuf_iterator<char>(file)),
-                            std::istreambuf_iterator<char>()
-                        );
+                    // Reading past the end authenticates the final chunk
+                    if (plaintext.peek() == std::char_traits<char>::eof() && sealed.complete()) {
+                        return snapshot;
+                    }
+                    streamError = "Truncated or trailing data in encrypted stream";
+                }
+                catch (const std::exception& e) {
+                    streamError = e.what();
+                }
 
-                        // Decrypt the data
-                        auto plaintext = Crypto::decrypt(encrypted, m_key);
+                // A legacy blob's random IV can start with the stream magic
+                try {
+                    file.clear();
+                    file.seekg(0);
+                    return readLegacySnapshot(file);
+                }
+                catch (const std::exception&) {
+                    throw std::runtime_error(streamError);
+                }
+            }
+            return readLegacySnapshot(file);
+        }
+
+        Snapshot readLegacySnapshot(std::ifstream& file) const
+        {
+            std::vector<uint8_t> encrypted(
+                (std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>()
+            );
+            auto plaintext = Crypto::decrypt(encrypted, m_key);
+            return fromJsonSnapshot(nlohmann::json::parse(plaintext.begin(), plaintext.end()));
+        }
 
-                        // Parse JSON using the existing from_json serialization
-                        std::string jsonStr(plaintext.begin(), plaintext.end());
-                        auto chatJson = nlohmann::json::parse(jsonStr);
+        static Snapshot fromJsonSnapshot(const nlohmann::json& chatJson)
+        {
+            Snapshot snapshot;
+            from_json(chatJson, snapshot.chat);
+            // Snapshots written before journaling existed have no epoch
+            snapshot.journalEpoch = chatJson.value("journalEpoch", uint64_t{ 0 });
+            snapshot.legacyFormat = true;
+            return snapshot;
+        }
 
-                        ChatHistory chat;
-                        from_json(chatJson, chat);
-                        chats.push_back(std::move(chat));
+        // Snapshot files sorted by name, so loading order doesn't depend on the file system
+        std::vector<std::filesystem::path> listChatFiles() const
+        {
+            std::vector<std::filesystem::path> paths;
+            try {
+                for (const auto& entry : std::filesystem::directory_iterator(m_basePath)) {
+                    if (entry.path().extension() == ".chat") {
+                        paths.push_back(entry.path());
                     }
                 }
             }
             catch (const std::exception& e) {
-                // TODO: Log error details here
+                std::cerr << "[FileChatPersistence] Failed to scan chats: " << e.what() << "\n";
+            }
+
+            std::sort(paths.begin(), paths.end());
+            return paths;
+        }
+
+        /**
+         * @brief Reads, decrypts and parses chat files on a worker pool.
+         *
+         * Workers claim files one at a time, so at most one file's buffers per worker are
+         * alive at once. Results line up with `paths` whatever order they finish in.
+         */
+        std::vector<std::optional<ChatHistory>> loadChatFiles(const std::vector<std::filesystem::path>& paths)
+        {
+            std::vector<std::optional<ChatHistory>> results(paths.size());
+            const size_t limit = m_loadWorkers > 0 ? m_loadWorkers.load()
+                : std::max<size_t>(1, std::thread::hardware_concurrency());
+            const size_t workers = std::min<size_t>(paths.size(), limit);
+
+            if (workers <= 1)
+            {
+                for (size_t i = 0; i < paths.size(); ++i)
+                {
+                    results[i] = loadChatFile(paths[i]);
+                }
+                return results;
             }
 
+            std::atomic<size_t> next{ 0 };
+            ThreadPool pool(workers);
+            std::vector<std::future<void>> done;
+            done.reserve(workers);
+            for (size_t w = 0; w < workers; ++w)
+            {
+                done.push_back(pool.enqueue([this, &paths, &results, &next]() {
+                    for (size_t i = next.fetch_add(1); i < paths.size(); i = next.fetch_add(1))
+                    {
+                        results[i] = loadChatFile(paths[i]);
+                    }
+                    }));
+            }
+            for (auto& future : done)
+            {
+                future.get();
+            }
+            return results;
+        }
+
+        std::vector<ChatHistory> loadEncryptedChats() 
+        {
+            const auto paths = listChatFiles();
+            auto loaded = loadChatFiles(paths);
+
+            std::vector<ChatHistory> chats;
+            chats.reserve(loaded.size());
+            for (auto& chat : loaded)
+            {
+                if (chat)
+                {
+                    chats.push_back(std::move(*chat));
+                }
+            }
             return chats;
         }
     };
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "chat_history.hpp"
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <optional>
+#include <iostream>
+#include <functional>
+#include <condition_variable>
+
+namespace Chat
+{
+    /**
+     * @brief Write-behind queue that saves chats on a background thread.
+     *
+     * Callers hand over a snapshot of the chat and return immediately. Saves of the
+     * same chat that arrive within the debounce window collapse into one write of the
+     * newest snapshot. A single worker writes chats in the order they became due, so
+     * an older snapshot can never overwrite a newer one.
+     *
+     * The worker never takes the caller's locks, so cancel() and flush() may be called
+     * while holding them.
+     */
+    class ChatSaveQueue
+    {
+    public:
+        using SaveFn = std::function<bool(const ChatHistory&)>;
+
+        explicit ChatSaveQueue(SaveFn save, std::chrono::milliseconds debounce = std::chrono::milliseconds(500))
+            : m_save(std::move(save)), m_debounce(debounce)
+        {
+            m_worker = std::thread(&ChatSaveQueue::workerLoop, this);
+        }
+
+        ~ChatSaveQueue()
+        {
+            flush();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            if (m_worker.joinable())
+            {
+                m_worker.join();
+            }
+        }
+
+        ChatSaveQueue(const ChatSaveQueue&) = delete;
+        ChatSaveQueue& operator=(const ChatSaveQueue&) = delete;
+
+        /**
+         * @brief Schedules a save, replacing any snapshot of the same chat still waiting.
+         * @param immediate Skip the debounce window, e.g. when the chat is about to be
+         *        dropped from memory.
+         */
+        void enqueue(ChatHistory chat, bool immediate = false)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const auto now = std::chrono::steady_clock::now();
+                auto [it, inserted] = m_pending.try_emplace(chat.name);
+                Pending& pending = it->second;
+                if (inserted)
+                {
+                    // The window starts with the first unsaved change, so a chat that keeps
+                    // changing is still written at least once per window
+                    pending.dueAt = now + m_debounce;
+                }
+                if (immediate)
+                {
+                    pending.dueAt = now;
+                }
+                pending.chat = std::move(chat);
+            }
+            m_cv.notify_all();
+        }
+
+        // Drops a waiting save of the chat and waits for one in progress to finish.
+        void cancel(const std::string& chatName)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pending.erase(chatName);
+            m_idleCv.wait(lock, [&]() { return !m_inFlight || m_inFlight->name != chatName; });
+        }
+
+        // Newest snapshot of the chat that isn't known to be on disk yet, if any.
+        std::optional<ChatHistory> latest(const std::string& chatName) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_pending.find(chatName);
+            if (it != m_pending.end())
+            {
+                return it->second.chat;
+            }
+            if (m_inFlight && m_inFlight->name == chatName)
+            {
+                return m_inFlight;
+            }
+            return std::nullopt;
+        }
+
+        // Writes everything that is waiting now and blocks until it is on disk.
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const auto now = std::chrono::steady_clock::now();
+            for (auto& [name, pending] : m_pending)
+            {
+                pending.dueAt = now;
+            }
+            m_cv.notify_all();
+            m_idleCv.wait(lock, [this]() { return m_pending.empty() && !m_inFlight; });
+        }
+
+        // Saves waiting or being written.
+        size_t pendingCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_pending.size() + (m_inFlight ? 1 : 0);
+        }
+
+    private:
+        static constexpr int MAX_ATTEMPTS = 3;
+
+        struct Pending
+        {
+            ChatHistory                           chat;
+            std::chrono::steady_clock::time_point dueAt;
+            int                                   attempts = 0;
+        };
+
+        void workerLoop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                if (m_pending.empty())
+                {
+                    if (m_stop) return;
+                    m_cv.wait(lock);
+                    continue;
+                }
+
+                auto next = m_pending.begin();
+                for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+                {
+                    if (it->second.dueAt < next->second.dueAt) next = it;
+                }
+
+                if (next->second.dueAt > std::chrono::steady_clock::now())
+                {
+                    m_cv.wait_until(lock, next->second.dueAt);
+                    continue;
+                }
+
+                m_inFlight = std::move(next->second.chat);
+                const int attempts = next->second.attempts + 1;
+                m_pending.erase(next);
+                lock.unlock();
+
+                bool saved = false;
+                try
+                {
+                    saved = m_save(*m_inFlight);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[ChatSaveQueue] Exception saving chat: " << e.what() << "\n";
+                }
+
+                lock.lock();
+                if (!saved)
+                {
+                    std::cerr << "[ChatSaveQueue] Failed to save chat: " << m_inFlight->name
+                        << " (attempt " << attempts << ")\n";
+
+                    // Retry unless a newer snapshot has been queued in the meantime
+                    if (attempts < MAX_ATTEMPTS && m_pending.count(m_inFlight->name) == 0)
+                    {
+                        Pending& retry = m_pending[m_inFlight->name];
+                        retry.chat = std::move(*m_inFlight);
+                        retry.dueAt = std::chrono::steady_clock::now() + m_debounce;
+                        retry.attempts = attempts;
+                    }
+                }
+                m_inFlight.reset();
+                m_idleCv.notify_all();
+            }
+        }
+
+        SaveFn                          m_save;
+        const std::chrono::milliseconds m_debounce;
+
+        mutable std::mutex              m_mutex;
+        std::condition_variable         m_cv;
+        std::condition_variable         m_idleCv;
+        std::map<std::string, Pending>  m_pending;
+        // latest() may copy it while the worker is saving it; only changed under m_mutex
+        std::optional<ChatHistory>      m_inFlight;
+        bool                            m_stop = false;
+        std::thread                     m_worker;
+    };
+
+} // namespace Chat
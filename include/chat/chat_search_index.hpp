@@ -0,0 +1,640 @@
+#pragma once
+
+#include "chat_history.hpp"
+#include "chat_binary_format.hpp"
+
+#include <map>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Chat
+{
+    struct ChatSearchHit
+    {
+        std::string chatName;
+        size_t      messageIndex = 0;
+        float       score = 0.0f;
+    };
+
+    /**
+     * @brief Inverted index over the text of every message in every chat.
+     *
+     * Each message is a document; terms map to postings of (document, term frequency).
+     * The index is updated message by message as chats change, so it never has to
+     * decrypt the chats to answer a query. Removed documents are only marked dead and
+     * are dropped from the postings once they outnumber the live ones.
+     *
+     * Queries match documents containing every query term and are ranked with BM25.
+     * The last term also matches as a prefix while it is still being typed.
+     *
+     * Each chat remembers its lastModified and message count, so a stored index can
+     * be checked against the chat list and only stale chats reindexed. Thread safe.
+     */
+    class ChatSearchIndex
+    {
+    public:
+        /**
+         * @brief Brings the chat's entry in line with its messages, reindexing only the
+         *        range between the unchanged leading and trailing messages.
+         */
+        void syncChat(const ChatHistory& chat)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            syncChatLocked(chat);
+        }
+
+        // The chat's last message was just added.
+        void appendMessage(const ChatHistory& chat)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatSlots.find(chat.name);
+            if (chat.messages.empty() || it == m_chatSlots.end() ||
+                m_chats[it->second].docs.size() + 1 != chat.messages.size())
+            {
+                syncChatLocked(chat);
+                return;
+            }
+
+            ChatEntry& entry = m_chats[it->second];
+            const Message& message = chat.messages.back();
+            entry.docs.push_back(addDocLocked(it->second, message.content));
+            entry.hashes.push_back(contentHash(message.content));
+            entry.lastModified = chat.lastModified;
+            ++m_revision;
+        }
+
+        // The message at `position` was just removed from the chat.
+        void removeMessage(const ChatHistory& chat, size_t position)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatSlots.find(chat.name);
+            if (it == m_chatSlots.end() || position > chat.messages.size() ||
+                m_chats[it->second].docs.size() != chat.messages.size() + 1)
+            {
+                syncChatLocked(chat);
+                return;
+            }
+
+            ChatEntry& entry = m_chats[it->second];
+            killDocLocked(entry.docs[position]);
+            entry.docs.erase(entry.docs.begin() + position);
+            entry.hashes.erase(entry.hashes.begin() + position);
+            entry.lastModified = chat.lastModified;
+            ++m_revision;
+            compactIfNeededLocked();
+        }
+
+        void removeChat(const std::string& chatName)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            removeChatLocked(chatName);
+            compactIfNeededLocked();
+        }
+
+        void renameChat(const std::string& oldName, const std::string& newName, int lastModified)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatSlots.find(oldName);
+            if (it == m_chatSlots.end() || oldName == newName)
+            {
+                return;
+            }
+
+            const uint32_t slot = it->second;
+            m_chatSlots.erase(it);
+            removeChatLocked(newName);
+            m_chatSlots[newName] = slot;
+            m_chats[slot].name = newName;
+            m_chats[slot].lastModified = lastModified;
+            ++m_revision;
+        }
+
+        // Drops every chat not in `chatNames`, e.g. ones deleted while the index wasn't saved.
+        void retainChats(const std::unordered_set<std::string>& chatNames)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            std::vector<std::string> gone;
+            for (const auto& [name, slot] : m_chatSlots)
+            {
+                if (chatNames.count(name) == 0)
+                {
+                    gone.push_back(name);
+                }
+            }
+            for (const auto& name : gone)
+            {
+                removeChatLocked(name);
+            }
+            compactIfNeededLocked();
+        }
+
+        // Whether the index reflects the chat as described by its summary.
+        bool isCurrent(const std::string& chatName, int lastModified, size_t messageCount) const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_chatSlots.find(chatName);
+            return it != m_chatSlots.end() &&
+                m_chats[it->second].lastModified == lastModified &&
+                m_chats[it->second].docs.size() == messageCount;
+        }
+
+        void clear()
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            clearLocked();
+            ++m_revision;
+        }
+
+        // Bumped by every change, so callers can tell whether a save or a cached query is stale.
+        uint64_t revision() const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            return m_revision;
+        }
+
+        /**
+         * @brief Ranks messages against the query, best first.
+         */
+        std::vector<ChatSearchHit> search(const std::string& query, size_t limit = 50) const
+        {
+            std::vector<std::string> terms = tokenize(query);
+            std::sort(terms.begin(), terms.end());
+            terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+            if (terms.empty() || limit == 0)
+            {
+                return {};
+            }
+            if (terms.size() > MAX_QUERY_TERMS)
+            {
+                terms.resize(MAX_QUERY_TERMS);
+            }
+
+            // Search-as-you-type: an unfinished last word matches as a prefix
+            std::string prefix;
+            if (isWordChar(static_cast<unsigned char>(query.back())))
+            {
+                const auto words = tokenize(query);
+                if (!words.empty())
+                {
+                    prefix = words.back();
+                }
+            }
+
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            if (m_liveDocs == 0)
+            {
+                return {};
+            }
+
+            const double docCount = static_cast<double>(m_liveDocs);
+            const double avgLength = std::max(1.0, static_cast<double>(m_liveLength) / docCount);
+
+            struct Accumulator
+            {
+                double   score = 0.0;
+                uint32_t matched = 0;
+            };
+            std::unordered_map<uint32_t, Accumulator> scores;
+
+            for (size_t i = 0; i < terms.size(); ++i)
+            {
+                const uint32_t bit = 1u << i;
+                auto scoreTerm = [&](const TermEntry& term) {
+                    const double df = static_cast<double>(term.postings.size());
+                    const double idf = std::log(1.0 + (docCount - df + 0.5) / (df + 0.5));
+                    for (const auto& posting : term.postings)
+                    {
+                        const Doc& doc = m_docs[posting.doc];
+                        if (!doc.alive)
+                        {
+                            continue;
+                        }
+                        const double tf = posting.frequency;
+                        const double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * doc.length / avgLength);
+                        Accumulator& acc = scores[posting.doc];
+                        acc.score += idf * tf * (BM25_K1 + 1.0) / (tf + norm);
+                        acc.matched |= bit;
+                    }
+                    };
+
+                if (terms[i] == prefix)
+                {
+                    size_t expansions = 0;
+                    for (auto it = m_terms.lower_bound(prefix);
+                        it != m_terms.end() && it->first.compare(0, prefix.size(), prefix) == 0 &&
+                        expansions < MAX_PREFIX_EXPANSIONS;
+                        ++it, ++expansions)
+                    {
+                        scoreTerm(it->second);
+                    }
+                }
+                else
+                {
+                    auto it = m_terms.find(terms[i]);
+                    if (it == m_terms.end())
+                    {
+                        return {};
+                    }
+                    scoreTerm(it->second);
+                }
+            }
+
+            const uint32_t allTerms = (1u << terms.size()) - 1;
+            std::vector<std::pair<double, uint32_t>> ranked;
+            for (const auto& [doc, acc] : scores)
+            {
+                if (acc.matched == allTerms)
+                {
+                    ranked.emplace_back(acc.score, doc);
+                }
+            }
+
+            const size_t count = std::min(limit, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                [](const auto& a, const auto& b) { return a.first > b.first || (a.first == b.first && a.second < b.second); });
+
+            std::vector<ChatSearchHit> hits;
+            hits.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const uint32_t docId = ranked[i].second;
+                const ChatEntry& chat = m_chats[m_docs[docId].chat];
+                const auto pos = std::find(chat.docs.begin(), chat.docs.end(), docId);
+                hits.push_back({ chat.name, static_cast<size_t>(pos - chat.docs.begin()),
+                    static_cast<float>(ranked[i].first) });
+            }
+            return hits;
+        }
+
+        /**
+         * @brief Writes the live part of the index.
+         *
+         * Layout: "KCSI" | u16 version | u32 chat count, then per chat: str name |
+         * i32 lastModified | u32 message count | per message: u64 content hash, u32 length;
+         * then u32 term count and per term: str term | u32 posting count | per posting:
+         * u32 document | u32 frequency. Documents are numbered in the order written.
+         */
+        void write(std::ostream& out) const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            using IO = ChatBinaryFormat;
+
+            std::unordered_map<uint32_t, uint32_t> renumbered;
+            renumbered.reserve(m_liveDocs);
+
+            out.write(MAGIC, sizeof(MAGIC));
+            IO::putInt(out, VERSION, 2);
+            IO::putInt(out, m_chatSlots.size(), 4);
+            for (const auto& chat : m_chats)
+            {
+                if (!chat.alive) continue;
+                IO::putString(out, chat.name);
+                IO::putInt(out, static_cast<uint32_t>(chat.lastModified), 4);
+                IO::putInt(out, chat.docs.size(), 4);
+                for (size_t i = 0; i < chat.docs.size(); ++i)
+                {
+                    const uint32_t next = static_cast<uint32_t>(renumbered.size());
+                    renumbered[chat.docs[i]] = next;
+                    IO::putInt(out, chat.hashes[i], 8);
+                    IO::putInt(out, m_docs[chat.docs[i]].length, 4);
+                }
+            }
+
+            std::vector<const Posting*> live;
+            IO::putInt(out, m_terms.size(), 4);
+            for (const auto& [text, term] : m_terms)
+            {
+                live.clear();
+                for (const auto& posting : term.postings)
+                {
+                    if (m_docs[posting.doc].alive) live.push_back(&posting);
+                }
+                IO::putString(out, text);
+                IO::putInt(out, live.size(), 4);
+                for (const Posting* posting : live)
+                {
+                    IO::putInt(out, renumbered.at(posting->doc), 4);
+                    IO::putInt(out, posting->frequency, 4);
+                }
+            }
+
+            if (!out)
+            {
+                throw std::runtime_error("Failed to write search index");
+            }
+        }
+
+        // Replaces the index with one written by write(). Throws if it is malformed.
+        void read(std::istream& in)
+        {
+            using IO = ChatBinaryFormat;
+
+            char magic[sizeof(MAGIC)];
+            IO::getBytes(in, magic, sizeof(magic));
+            if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || IO::getInt(in, 2) != VERSION)
+            {
+                throw std::runtime_error("Unsupported search index format");
+            }
+
+            ChatSearchIndex loaded;
+            const uint32_t chatCount = static_cast<uint32_t>(IO::getInt(in, 4));
+            for (uint32_t c = 0; c < chatCount; ++c)
+            {
+                ChatEntry chat;
+                chat.name = IO::getString(in);
+                chat.lastModified = static_cast<int32_t>(IO::getInt(in, 4));
+                const uint32_t docCount = static_cast<uint32_t>(IO::getInt(in, 4));
+                const uint32_t slot = static_cast<uint32_t>(loaded.m_chats.size());
+                for (uint32_t d = 0; d < docCount; ++d)
+                {
+                    chat.hashes.push_back(IO::getInt(in, 8));
+                    const uint32_t length = static_cast<uint32_t>(IO::getInt(in, 4));
+                    chat.docs.push_back(static_cast<uint32_t>(loaded.m_docs.size()));
+                    loaded.m_docs.push_back({ slot, length, true });
+                    loaded.m_liveLength += length;
+                }
+                if (!loaded.m_chatSlots.emplace(chat.name, slot).second)
+                {
+                    throw std::runtime_error("Duplicate chat in search index");
+                }
+                loaded.m_chats.push_back(std::move(chat));
+            }
+            loaded.m_liveDocs = loaded.m_docs.size();
+
+            const uint32_t termCount = static_cast<uint32_t>(IO::getInt(in, 4));
+            for (uint32_t t = 0; t < termCount; ++t)
+            {
+                TermEntry& term = loaded.m_terms[IO::getString(in)];
+                const uint32_t postingCount = static_cast<uint32_t>(IO::getInt(in, 4));
+                term.postings.reserve(std::min<uint32_t>(postingCount, 1 << 16));
+                for (uint32_t p = 0; p < postingCount; ++p)
+                {
+                    const uint32_t doc = static_cast<uint32_t>(IO::getInt(in, 4));
+                    const uint32_t frequency = static_cast<uint32_t>(IO::getInt(in, 4));
+                    if (doc >= loaded.m_docs.size())
+                    {
+                        throw std::runtime_error("Invalid document in search index");
+                    }
+                    term.postings.push_back({ doc, frequency });
+                }
+            }
+
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            m_terms = std::move(loaded.m_terms);
+            m_docs = std::move(loaded.m_docs);
+            m_chats = std::move(loaded.m_chats);
+            m_chatSlots = std::move(loaded.m_chatSlots);
+            m_liveDocs = loaded.m_liveDocs;
+            m_liveLength = loaded.m_liveLength;
+            m_sweptDocs = 0;
+            ++m_revision;
+        }
+
+        /**
+         * @brief Splits text into lowercase terms. Runs of ASCII letters and digits form
+         *        words; bytes of multi-byte UTF-8 characters count as word characters, so
+         *        non-Latin text is indexed by whole runs.
+         */
+        static std::vector<std::string> tokenize(const std::string& text)
+        {
+            std::vector<std::string> terms;
+            std::string current;
+            auto flush = [&]() {
+                if (current.size() >= MIN_TERM_LENGTH ||
+                    (!current.empty() && static_cast<unsigned char>(current[0]) >= 0x80))
+                {
+                    terms.push_back(current.substr(0, MAX_TERM_LENGTH));
+                }
+                current.clear();
+                };
+
+            for (const char ch : text)
+            {
+                const unsigned char byte = static_cast<unsigned char>(ch);
+                if (isWordChar(byte))
+                {
+                    current.push_back(byte < 0x80 ? static_cast<char>(std::tolower(byte)) : ch);
+                }
+                else
+                {
+                    flush();
+                }
+            }
+            flush();
+            return terms;
+        }
+
+    private:
+        static constexpr char     MAGIC[4] = { 'K', 'C', 'S', 'I' };
+        static constexpr uint16_t VERSION = 1;
+        static constexpr size_t   MIN_TERM_LENGTH = 2;
+        static constexpr size_t   MAX_TERM_LENGTH = 64;
+        static constexpr size_t   MAX_QUERY_TERMS = 16;
+        static constexpr size_t   MAX_PREFIX_EXPANSIONS = 256;
+        static constexpr double   BM25_K1 = 1.2;
+        static constexpr double   BM25_B = 0.75;
+        // Dead documents are swept from the postings once there are more unswept ones than
+        // this and than live ones
+        static constexpr size_t   COMPACT_MIN_DEAD = 4096;
+
+        struct Posting
+        {
+            uint32_t doc;
+            uint32_t frequency;
+        };
+
+        struct TermEntry
+        {
+            std::vector<Posting> postings;
+        };
+
+        struct Doc
+        {
+            uint32_t chat;
+            uint32_t length;
+            bool     alive;
+        };
+
+        struct ChatEntry
+        {
+            std::string           name;
+            int                   lastModified = 0;
+            // Documents and content hashes in message order
+            std::vector<uint32_t> docs;
+            std::vector<uint64_t> hashes;
+            bool                  alive = true;
+        };
+
+        static bool isWordChar(unsigned char byte)
+        {
+            return byte >= 0x80 || std::isalnum(byte);
+        }
+
+        static uint64_t contentHash(const std::string& content)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for (const char ch : content)
+            {
+                hash ^= static_cast<unsigned char>(ch);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        void syncChatLocked(const ChatHistory& chat)
+        {
+            auto [it, inserted] = m_chatSlots.try_emplace(chat.name, static_cast<uint32_t>(m_chats.size()));
+            if (inserted)
+            {
+                ChatEntry entry;
+                entry.name = chat.name;
+                m_chats.push_back(std::move(entry));
+            }
+            const uint32_t slot = it->second;
+            ChatEntry& entry = m_chats[slot];
+
+            std::vector<uint64_t> hashes;
+            hashes.reserve(chat.messages.size());
+            for (const auto& message : chat.messages)
+            {
+                hashes.push_back(contentHash(message.content));
+            }
+
+            // Reindex only what lies between the unchanged head and tail
+            size_t head = 0;
+            while (head < hashes.size() && head < entry.hashes.size() && hashes[head] == entry.hashes[head])
+            {
+                ++head;
+            }
+            size_t tail = 0;
+            while (tail < hashes.size() - head && tail < entry.hashes.size() - head &&
+                hashes[hashes.size() - 1 - tail] == entry.hashes[entry.hashes.size() - 1 - tail])
+            {
+                ++tail;
+            }
+
+            const size_t oldEnd = entry.hashes.size() - tail;
+            for (size_t i = head; i < oldEnd; ++i)
+            {
+                killDocLocked(entry.docs[i]);
+            }
+
+            std::vector<uint32_t> added;
+            for (size_t i = head; i < hashes.size() - tail; ++i)
+            {
+                added.push_back(addDocLocked(slot, chat.messages[i].content));
+            }
+
+            entry.docs.erase(entry.docs.begin() + head, entry.docs.begin() + oldEnd);
+            entry.docs.insert(entry.docs.begin() + head, added.begin(), added.end());
+            entry.hashes = std::move(hashes);
+            entry.lastModified = chat.lastModified;
+            ++m_revision;
+            compactIfNeededLocked();
+        }
+
+        uint32_t addDocLocked(uint32_t chatSlot, const std::string& content)
+        {
+            const uint32_t docId = static_cast<uint32_t>(m_docs.size());
+            const auto words = tokenize(content);
+
+            std::unordered_map<std::string, uint32_t> frequencies;
+            for (const auto& word : words)
+            {
+                ++frequencies[word];
+            }
+            for (const auto& [word, frequency] : frequencies)
+            {
+                m_terms[word].postings.push_back({ docId, frequency });
+            }
+
+            m_docs.push_back({ chatSlot, static_cast<uint32_t>(words.size()), true });
+            ++m_liveDocs;
+            m_liveLength += words.size();
+            return docId;
+        }
+
+        void killDocLocked(uint32_t docId)
+        {
+            Doc& doc = m_docs[docId];
+            if (!doc.alive) return;
+            doc.alive = false;
+            --m_liveDocs;
+            m_liveLength -= doc.length;
+        }
+
+        void removeChatLocked(const std::string& chatName)
+        {
+            auto it = m_chatSlots.find(chatName);
+            if (it == m_chatSlots.end())
+            {
+                return;
+            }
+
+            ChatEntry& entry = m_chats[it->second];
+            for (const uint32_t docId : entry.docs)
+            {
+                killDocLocked(docId);
+            }
+            entry = ChatEntry();
+            entry.alive = false;
+            m_chatSlots.erase(it);
+            ++m_revision;
+        }
+
+        // Sweeps dead documents out of the postings. Document ids stay as they are.
+        void compactIfNeededLocked()
+        {
+            const size_t dead = m_docs.size() - m_liveDocs - m_sweptDocs;
+            if (dead < COMPACT_MIN_DEAD || dead < m_liveDocs)
+            {
+                return;
+            }
+            m_sweptDocs += dead;
+
+            for (auto it = m_terms.begin(); it != m_terms.end();)
+            {
+                auto& postings = it->second.postings;
+                postings.erase(std::remove_if(postings.begin(), postings.end(),
+                    [this](const Posting& posting) { return !m_docs[posting.doc].alive; }), postings.end());
+                it = postings.empty() ? m_terms.erase(it) : std::next(it);
+            }
+        }
+
+        void clearLocked()
+        {
+            m_terms.clear();
+            m_docs.clear();
+            m_chats.clear();
+            m_chatSlots.clear();
+            m_liveDocs = 0;
+            m_liveLength = 0;
+            m_sweptDocs = 0;
+        }
+
+        mutable std::shared_mutex                     m_mutex;
+        // Ordered, so prefix queries are a range scan
+        std::map<std::string, TermEntry>              m_terms;
+        std::vector<Doc>                              m_docs;
+        std::vector<ChatEntry>                        m_chats;
+        std::unordered_map<std::string, uint32_t>     m_chatSlots;
+        size_t                                        m_liveDocs = 0;
+        uint64_t                                      m_liveLength = 0;
+        // Dead documents already removed from the postings
+        size_t                                        m_sweptDocs = 0;
+        uint64_t                                      m_revision = 0;
+    };
+
+} // namespace Chat
@@ -0,0 +1,510 @@
+#pragma once
+
+#include "compression/compression.hpp"
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+#include <condition_variable>
+
+namespace Chat
+{
+    /**
+     * @brief Owns the per-chat KV session files (`<chat>@<model><variant>.bin`).
+     *
+     * Files are indexed in memory by chat and then by model + variant, so renaming or
+     * deleting a chat's caches only touches that chat's files instead of scanning the
+     * directory. The total size is kept under a disk budget by dropping the least
+     * recently used caches; caches that stay unused for a while can be compressed
+     * (`.bin.klz`) by a background thread, which also decompresses them again when
+     * they are asked for.
+     *
+     * A cache handed to the engine is leased until release(), and leased caches are
+     * never compressed, evicted or renamed. Handing one out never waits on file work,
+     * because the UI thread asks for a cache each time a message is sent.
+     */
+    class KvCacheStore
+    {
+    public:
+        struct Stats
+        {
+            size_t    entries = 0;
+            size_t    compressedEntries = 0;
+            uintmax_t diskBytes = 0;
+            uint64_t  evictions = 0;
+        };
+
+        KvCacheStore(std::filesystem::path basePath, uintmax_t diskBudgetBytes,
+            bool compressColdEntries = true, std::chrono::seconds coldAfter = std::chrono::minutes(10))
+            : m_basePath(std::move(basePath))
+            , m_diskBudget(diskBudgetBytes)
+            , m_compressCold(compressColdEntries)
+            , m_coldAfter(coldAfter)
+        {
+            scanExistingFiles();
+            m_maintenanceThread = std::thread(&KvCacheStore::maintenanceLoop, this);
+        }
+
+        ~KvCacheStore()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            if (m_maintenanceThread.joinable())
+            {
+                m_maintenanceThread.join();
+            }
+        }
+
+        KvCacheStore(const KvCacheStore&) = delete;
+        KvCacheStore& operator=(const KvCacheStore&) = delete;
+
+        static std::string fileNameFor(const std::string& chatName, const std::string& modelKey)
+        {
+            return chatName + "@" + modelKey + ".bin";
+        }
+
+        /**
+         * @brief Leases the cache file for the engine to read and write, until release(path).
+         *
+         * Never blocks on file work. A cache that is compressed, or being compressed, is
+         * queued for a background restore and an empty path is returned, so that request
+         * runs without a KV cache and the next one finds the file ready.
+         */
+        std::filesystem::path tryAcquire(const std::string& chatName, const std::string& model, const std::string& variant)
+        {
+            const std::string modelKey = model + variant;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Entry* entry = &m_chats[chatName][modelKey];
+            if (entry->path.empty())
+            {
+                entry->path = std::filesystem::absolute(m_basePath / fileNameFor(chatName, modelKey));
+                m_lru.push_front({ chatName, modelKey });
+                entry->lruPos = m_lru.begin();
+            }
+
+            entry->lastUsed = std::chrono::steady_clock::now();
+            m_lru.splice(m_lru.begin(), m_lru, entry->lruPos);
+
+            if (entry->busy || entry->compressed)
+            {
+                const std::pair<std::string, std::string> key{ chatName, modelKey };
+                if (std::find(m_pendingRestores.begin(), m_pendingRestores.end(), key) == m_pendingRestores.end())
+                {
+                    m_pendingRestores.push_back(key);
+                    m_cv.notify_all();
+                }
+                return {};
+            }
+
+            ++entry->leases;
+            m_byPath[entry->path.string()] = { chatName, modelKey };
+            return entry->path;
+        }
+
+        // Ends a lease taken by tryAcquire(); picks up the file's new size and enforces the budget.
+        void release(const std::filesystem::path& path)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto owner = m_byPath.find(std::filesystem::absolute(path).string());
+                if (owner == m_byPath.end()) return;
+
+                Entry* entry = findLocked(owner->second.first, owner->second.second);
+                if (!entry || entry->leases == 0) return;
+
+                --entry->leases;
+                entry->lastUsed = std::chrono::steady_clock::now();
+
+                std::error_code ec;
+                const uintmax_t size = std::filesystem::file_size(entry->path, ec);
+                m_diskBytes -= entry->size;
+                entry->size = ec ? 0 : size;
+                m_diskBytes += entry->size;
+
+                evictLocked();
+            }
+            m_cv.notify_all();
+        }
+
+        // Deletes every cache of a chat.
+        bool removeChat(const std::string& chatName)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto chat = m_chats.find(chatName);
+            if (chat == m_chats.end()) return true;
+
+            bool allDeleted = true;
+            for (auto it = chat->second.begin(); it != chat->second.end();)
+            {
+                Entry& entry = it->second;
+                if (entry.leases > 0 || entry.busy)
+                {
+                    std::cerr << "[KvCacheStore] Cache in use, not deleting: " << entry.path << "\n";
+                    allDeleted = false;
+                    ++it;
+                    continue;
+                }
+                if (!eraseFilesLocked(entry)) allDeleted = false;
+                m_byPath.erase(entry.path.string());
+                m_lru.erase(entry.lruPos);
+                it = chat->second.erase(it);
+            }
+            if (chat->second.empty()) m_chats.erase(chat);
+            return allDeleted;
+        }
+
+        // Moves a chat's caches to its new name; renames only that chat's files.
+        bool renameChat(const std::string& oldName, const std::string& newName)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto chat = m_chats.find(oldName);
+            if (chat == m_chats.end() || oldName == newName) return true;
+
+            bool allRenamed = true;
+            auto& target = m_chats[newName];
+            chat = m_chats.find(oldName);
+            for (auto it = chat->second.begin(); it != chat->second.end();)
+            {
+                Entry& entry = it->second;
+                if (entry.leases > 0 || entry.busy || target.count(it->first) > 0)
+                {
+                    std::cerr << "[KvCacheStore] Cannot rename cache in use: " << entry.path << "\n";
+                    allRenamed = false;
+                    ++it;
+                    continue;
+                }
+
+                const auto newPath = std::filesystem::absolute(m_basePath / fileNameFor(newName, it->first));
+                const auto from = entry.compressed ? compressedPathFor(entry.path) : entry.path;
+                const auto to = entry.compressed ? compressedPathFor(newPath) : newPath;
+
+                std::error_code ec;
+                if (std::filesystem::exists(from, ec))
+                {
+                    std::filesystem::rename(from, to, ec);
+                }
+                if (ec)
+                {
+                    std::cerr << "[KvCacheStore] Failed to rename " << from << " to " << to << ": " << ec.message() << "\n";
+                    allRenamed = false;
+                    ++it;
+                    continue;
+                }
+
+                m_byPath.erase(entry.path.string());
+                entry.path = newPath;
+                *entry.lruPos = { newName, it->first };
+                target[it->first] = std::move(entry);
+                it = chat->second.erase(it);
+            }
+            if (chat->second.empty()) m_chats.erase(chat);
+            if (target.empty()) m_chats.erase(newName);
+            return allRenamed;
+        }
+
+        void setDiskBudget(uintmax_t bytes)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_diskBudget = bytes;
+            evictLocked();
+        }
+
+        Stats getStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Stats stats;
+            for (const auto& [chatName, models] : m_chats)
+            {
+                for (const auto& [modelKey, entry] : models)
+                {
+                    ++stats.entries;
+                    if (entry.compressed) ++stats.compressedEntries;
+                }
+            }
+            stats.diskBytes = m_diskBytes;
+            stats.evictions = m_evictions;
+            return stats;
+        }
+
+    private:
+        struct Entry
+        {
+            // Path of the uncompressed file, which is what the engine sees
+            std::filesystem::path path;
+            uintmax_t             size = 0;
+            int                   leases = 0;
+            bool                  compressed = false;
+            // A background compression or a restore is working on the files
+            bool                  busy = false;
+            std::chrono::steady_clock::time_point lastUsed;
+            std::list<std::pair<std::string, std::string>>::iterator lruPos;
+        };
+
+        static std::filesystem::path compressedPathFor(const std::filesystem::path& path)
+        {
+            auto compressed = path;
+            compressed += ".klz";
+            return compressed;
+        }
+
+        Entry* findLocked(const std::string& chatName, const std::string& modelKey)
+        {
+            auto chat = m_chats.find(chatName);
+            if (chat == m_chats.end()) return nullptr;
+            auto entry = chat->second.find(modelKey);
+            return entry == chat->second.end() ? nullptr : &entry->second;
+        }
+
+        bool eraseFilesLocked(Entry& entry)
+        {
+            std::error_code ec;
+            bool ok = true;
+            std::filesystem::remove(entry.path, ec);
+            if (ec) ok = false;
+            std::filesystem::remove(compressedPathFor(entry.path), ec);
+            if (ec) ok = false;
+            m_diskBytes -= entry.size;
+            entry.size = 0;
+            return ok;
+        }
+
+        void scanExistingFiles()
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(m_basePath, ec);
+
+            for (const auto& file : std::filesystem::directory_iterator(m_basePath, ec))
+            {
+                if (!file.is_regular_file()) continue;
+
+                std::string fileName = file.path().filename().string();
+                bool compressed = false;
+                if (fileName.size() > 8 && fileName.compare(fileName.size() - 8, 8, ".bin.klz") == 0)
+                {
+                    compressed = true;
+                    fileName.resize(fileName.size() - 4);
+                }
+                if (fileName.size() <= 4 || fileName.compare(fileName.size() - 4, 4, ".bin") != 0) continue;
+
+                const std::string baseName = fileName.substr(0, fileName.size() - 4);
+                const auto atPos = baseName.rfind('@');
+                if (atPos == std::string::npos) continue;
+
+                const std::string chatName = baseName.substr(0, atPos);
+                const std::string modelKey = baseName.substr(atPos + 1);
+                Entry& entry = m_chats[chatName][modelKey];
+                if (!entry.path.empty())
+                {
+                    // Both forms exist, e.g. after a crash mid-compression; keep the plain file
+                    if (compressed)
+                    {
+                        std::filesystem::remove(file.path(), ec);
+                        continue;
+                    }
+                    std::filesystem::remove(compressedPathFor(entry.path), ec);
+                    m_diskBytes -= entry.size;
+                }
+                else
+                {
+                    m_lru.push_back({ chatName, modelKey });
+                    entry.lruPos = std::prev(m_lru.end());
+                }
+
+                entry.path = std::filesystem::absolute(m_basePath / fileName);
+                entry.size = file.file_size(ec);
+                entry.compressed = compressed;
+                // Nothing is known about last use yet; treat existing caches as cold
+                entry.lastUsed = std::chrono::steady_clock::now() - m_coldAfter;
+                m_diskBytes += entry.size;
+            }
+
+            evictLocked();
+        }
+
+        void evictLocked()
+        {
+            auto it = m_lru.end();
+            while (m_diskBytes > m_diskBudget && it != m_lru.begin())
+            {
+                --it;
+                Entry* entry = findLocked(it->first, it->second);
+                if (!entry)
+                {
+                    it = m_lru.erase(it);
+                    continue;
+                }
+                if (entry->leases > 0 || entry->busy) continue;
+
+                eraseFilesLocked(*entry);
+                m_byPath.erase(entry->path.string());
+                m_chats[it->first].erase(it->second);
+                if (m_chats[it->first].empty()) m_chats.erase(it->first);
+                it = m_lru.erase(it);
+                ++m_evictions;
+            }
+        }
+
+        // Decompresses a cache without holding the lock. Requires m_mutex.
+        void restoreLocked(std::unique_lock<std::mutex>& lock, const std::string& chatName, const std::string& modelKey)
+        {
+            // Gone or renamed since it was asked for, or never compressed after all
+            Entry* entry = findLocked(chatName, modelKey);
+            if (!entry || !entry->compressed) return;
+
+            const auto path = entry->path;
+            const auto compressedPath = compressedPathFor(path);
+            entry->busy = true;
+            lock.unlock();
+
+            bool restored = false;
+            try
+            {
+                Compression::decompressFile(compressedPath, path);
+                restored = true;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[KvCacheStore] Failed to restore " << path << ": " << e.what() << "\n";
+            }
+
+            std::error_code ec;
+            std::filesystem::remove(restored ? compressedPath : path, ec);
+            if (!restored) std::filesystem::remove(compressedPath, ec);
+            uintmax_t size = restored ? std::filesystem::file_size(path, ec) : 0;
+            if (ec) size = 0;
+
+            // Busy entries are never erased or renamed, so the entry is still there
+            lock.lock();
+            entry->busy = false;
+            entry->compressed = false;
+            entry->lastUsed = std::chrono::steady_clock::now();
+            m_diskBytes = m_diskBytes - entry->size + size;
+            entry->size = size;
+            m_cv.notify_all();
+        }
+
+        void maintenanceLoop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            bool idle = true;
+            while (!m_stop)
+            {
+                if (idle)
+                {
+                    m_cv.wait_for(lock, MAINTENANCE_INTERVAL, [this]() {
+                        return m_stop || !m_pendingRestores.empty();
+                        });
+                }
+                idle = true;
+                if (m_stop) continue;
+
+                // Caches someone asked for come first. All file work happens on this thread,
+                // so none is busy here; one asked for mid-compression is restored right after.
+                if (!m_pendingRestores.empty())
+                {
+                    const auto next = m_pendingRestores.front();
+                    m_pendingRestores.pop_front();
+                    restoreLocked(lock, next.first, next.second);
+                    idle = false;
+                    continue;
+                }
+                if (!m_compressCold) continue;
+
+                // Compress one cold cache per pass, oldest first, without holding the lock
+                const auto now = std::chrono::steady_clock::now();
+                for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it)
+                {
+                    Entry* entry = findLocked(it->first, it->second);
+                    if (!entry || entry->compressed || entry->busy || entry->leases > 0 ||
+                        entry->size == 0 || now - entry->lastUsed < m_coldAfter)
+                    {
+                        continue;
+                    }
+
+                    const std::string chatName = it->first;
+                    const std::string modelKey = it->second;
+                    const auto path = entry->path;
+                    entry->busy = true;
+                    lock.unlock();
+
+                    const auto compressedPath = compressedPathFor(path);
+                    bool done = false;
+                    try
+                    {
+                        Compression::compressFile(path, compressedPath);
+                        done = true;
+                    }
+                    catch (const std::exception& e)
+                    {
+                        std::cerr << "[KvCacheStore] Failed to compress " << path << ": " << e.what() << "\n";
+                    }
+
+                    std::error_code ec;
+                    const uintmax_t compressedSize = done ? std::filesystem::file_size(compressedPath, ec) : 0;
+                    if (done && !ec)
+                    {
+                        std::filesystem::remove(path, ec);
+                    }
+                    else
+                    {
+                        done = false;
+                        std::filesystem::remove(compressedPath, ec);
+                    }
+
+                    lock.lock();
+                    if (Entry* current = findLocked(chatName, modelKey))
+                    {
+                        current->busy = false;
+                        if (done)
+                        {
+                            current->compressed = true;
+                            m_diskBytes = m_diskBytes - current->size + compressedSize;
+                            current->size = compressedSize;
+                        }
+                    }
+                    m_cv.notify_all();
+                    // Look for the next one right away
+                    idle = false;
+                    break;
+                }
+            }
+        }
+
+        static constexpr std::chrono::seconds MAINTENANCE_INTERVAL{ 30 };
+
+        const std::filesystem::path m_basePath;
+
+        mutable std::mutex      m_mutex;
+        std::condition_variable m_cv;
+        // chat name -> model + variant -> cache
+        std::unordered_map<std::string, std::unordered_map<std::string, Entry>> m_chats;
+        // (chat name, model + variant), most recently used at the front
+        std::list<std::pair<std::string, std::string>> m_lru;
+        // Leased file path -> owner, so the engine side only needs the path to release
+        std::unordered_map<std::string, std::pair<std::string, std::string>> m_byPath;
+        // (chat name, model + variant) of caches to decompress, in request order
+        std::deque<std::pair<std::string, std::string>> m_pendingRestores;
+        uintmax_t               m_diskBudget;
+        uintmax_t               m_diskBytes = 0;
+        uint64_t                m_evictions = 0;
+        const bool              m_compressCold;
+        const std::chrono::seconds m_coldAfter;
+        bool                    m_stop = false;
+        std::thread             m_maintenanceThread;
+    };
+
+} // namespace Chat
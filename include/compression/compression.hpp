@@ -0,0 +1,586 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <stdexcept>
+#include <filesystem>
+
+/**
+ * @brief Fast LZ77 compression (LZ4-style block format) with a simple framing.
+ *
+ * Favours speed over ratio: it is meant for data we write often and read back soon,
+ * such as chat files and cold KV caches. A frame is "KLZ1" followed by blocks of
+ * [u32 raw size][u32 stored size | RAW_BLOCK flag][data], ending with a zero raw size;
+ * blocks that don't shrink are stored as-is. Corrupt input throws std::runtime_error.
+ *
+ * CompressStreamBuf and DecompressStreamBuf produce and consume the same frames as a
+ * stream, holding one block at a time, so they can sit in a pipeline of other streams.
+ */
+class Compression
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 4 * 1024 * 1024;
+
+    static bool isCompressed(const uint8_t* data, size_t size)
+    {
+        return size >= MAGIC.size() && std::memcmp(data, MAGIC.data(), MAGIC.size()) == 0;
+    }
+
+    static bool isCompressed(const std::vector<uint8_t>& data)
+    {
+        return isCompressed(data.data(), data.size());
+    }
+
+    static std::vector<uint8_t> compress(const uint8_t* data, size_t size)
+    {
+        std::vector<uint8_t> frame(MAGIC.begin(), MAGIC.end());
+        std::vector<uint8_t> block;
+        for (size_t offset = 0; offset < size; offset += BLOCK_SIZE)
+        {
+            const size_t rawSize = std::min(BLOCK_SIZE, size - offset);
+            appendBlock(frame, data + offset, rawSize, block);
+        }
+        writeU32(frame, 0);
+        return frame;
+    }
+
+    static std::vector<uint8_t> compress(const std::vector<uint8_t>& input)
+    {
+        return compress(input.data(), input.size());
+    }
+
+    static std::vector<uint8_t> decompress(const std::vector<uint8_t>& frame)
+    {
+        if (!isCompressed(frame))
+        {
+            throw std::runtime_error("Not a compressed frame");
+        }
+
+        std::vector<uint8_t> output;
+        size_t pos = MAGIC.size();
+        while (true)
+        {
+            const uint32_t rawSize = readU32(frame, pos);
+            if (rawSize == 0) break;
+            const uint32_t stored = readU32(frame, pos);
+            const uint32_t storedSize = stored & ~RAW_BLOCK;
+            checkBlockSizes(rawSize, storedSize);
+            if (frame.size() - pos < storedSize)
+            {
+                throw std::runtime_error("Truncated compressed block");
+            }
+
+            const size_t start = output.size();
+            output.resize(start + rawSize);
+            if (stored & RAW_BLOCK)
+            {
+                if (storedSize != rawSize) throw std::runtime_error("Invalid stored block");
+                std::memcpy(output.data() + start, frame.data() + pos, rawSize);
+            }
+            else
+            {
+                decompressBlock(frame.data() + pos, storedSize, output.data() + start, rawSize);
+            }
+            pos += storedSize;
+        }
+        return output;
+    }
+
+    // Streams `source` into a compressed frame at `target`, one block in memory at a time.
+    static void compressFile(const std::filesystem::path& source, const std::filesystem::path& target)
+    {
+        std::ifstream in(source, std::ios::binary);
+        std::ofstream out(target, std::ios::binary | std::ios::trunc);
+        if (!in || !out)
+        {
+            throw std::runtime_error("Failed to open files for compression");
+        }
+
+        std::vector<uint8_t> header(MAGIC.begin(), MAGIC.end());
+        out.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+        std::vector<uint8_t> raw(BLOCK_SIZE);
+        std::vector<uint8_t> scratch;
+        std::vector<uint8_t> encoded;
+        while (in)
+        {
+            in.read(reinterpret_cast<char*>(raw.data()), raw.size());
+            const size_t got = static_cast<size_t>(in.gcount());
+            if (got == 0) break;
+
+            encoded.clear();
+            appendBlock(encoded, raw.data(), got, scratch);
+            out.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+        }
+
+        std::vector<uint8_t> end;
+        writeU32(end, 0);
+        out.write(reinterpret_cast<const char*>(end.data()), end.size());
+        out.close();
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write compressed file");
+        }
+    }
+
+    static void decompressFile(const std::filesystem::path& source, const std::filesystem::path& target)
+    {
+        std::ifstream in(source, std::ios::binary);
+        std::ofstream out(target, std::ios::binary | std::ios::trunc);
+        if (!in || !out)
+        {
+            throw std::runtime_error("Failed to open files for decompression");
+        }
+
+        std::array<char, 4> magic{};
+        in.read(magic.data(), magic.size());
+        if (!in || std::memcmp(magic.data(), MAGIC.data(), MAGIC.size()) != 0)
+        {
+            throw std::runtime_error("Not a compressed file");
+        }
+
+        std::vector<uint8_t> stored;
+        std::vector<uint8_t> raw;
+        while (true)
+        {
+            uint8_t sizes[8];
+            in.read(reinterpret_cast<char*>(sizes), 4);
+            if (!in) throw std::runtime_error("Truncated compressed file");
+            const uint32_t rawSize = decodeU32(sizes);
+            if (rawSize == 0) break;
+
+            in.read(reinterpret_cast<char*>(sizes + 4), 4);
+            if (!in) throw std::runtime_error("Truncated compressed file");
+            const uint32_t storedWord = decodeU32(sizes + 4);
+            const uint32_t storedSize = storedWord & ~RAW_BLOCK;
+            checkBlockSizes(rawSize, storedSize);
+
+            stored.resize(storedSize);
+            in.read(reinterpret_cast<char*>(stored.data()), storedSize);
+            if (static_cast<uint32_t>(in.gcount()) != storedSize)
+            {
+                throw std::runtime_error("Truncated compressed block");
+            }
+
+            if (storedWord & RAW_BLOCK)
+            {
+                if (storedSize != rawSize) throw std::runtime_error("Invalid stored block");
+                out.write(reinterpret_cast<const char*>(stored.data()), storedSize);
+            }
+            else
+            {
+                raw.resize(rawSize);
+                decompressBlock(stored.data(), storedSize, raw.data(), rawSize);
+                out.write(reinterpret_cast<const char*>(raw.data()), rawSize);
+            }
+        }
+
+        out.close();
+        if (!out)
+        {
+            throw std::runtime_error("Failed to write decompressed file");
+        }
+    }
+
+    /**
+     * @brief Output stream buffer that compresses everything written to it into a frame.
+     *
+     * Blocks are blockSize bytes; smaller blocks bound memory, but the 64 KiB match window
+     * means blocks much larger than that gain little. Call finish() to end the frame.
+     */
+    class CompressStreamBuf : public std::streambuf
+    {
+    public:
+        explicit CompressStreamBuf(std::ostream& out, size_t blockSize = BLOCK_SIZE)
+            : m_out(out)
+        {
+            if (blockSize == 0 || blockSize > BLOCK_SIZE)
+            {
+                throw std::invalid_argument("Invalid compression block size");
+            }
+
+            m_raw.resize(blockSize);
+            writeOut(MAGIC.data(), MAGIC.size());
+            setp(m_raw.data(), m_raw.data() + m_raw.size());
+        }
+
+        CompressStreamBuf(const CompressStreamBuf&) = delete;
+        CompressStreamBuf& operator=(const CompressStreamBuf&) = delete;
+
+        /**
+         * @brief Compresses the buffered tail and ends the frame.
+         * @return Total bytes written to the output stream.
+         */
+        uint64_t finish()
+        {
+            if (!m_finished)
+            {
+                flushBlock();
+                std::vector<uint8_t> end;
+                writeU32(end, 0);
+                writeOut(end.data(), end.size());
+                m_finished = true;
+                setp(nullptr, nullptr);
+            }
+            return m_written;
+        }
+
+        // Bytes written to this buffer so far, before compression
+        uint64_t rawBytes() const { return m_rawBytes + static_cast<uint64_t>(pptr() - pbase()); }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (m_finished)
+            {
+                return traits_type::eof();
+            }
+            if (traits_type::eq_int_type(ch, traits_type::eof()))
+            {
+                return traits_type::not_eof(ch);
+            }
+
+            if (pptr() == epptr())
+            {
+                flushBlock();
+            }
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+            return ch;
+        }
+
+    private:
+        void flushBlock()
+        {
+            const size_t size = static_cast<size_t>(pptr() - pbase());
+            if (size == 0)
+            {
+                return;
+            }
+
+            m_encoded.clear();
+            appendBlock(m_encoded, reinterpret_cast<const uint8_t*>(pbase()), size, m_scratch);
+            writeOut(m_encoded.data(), m_encoded.size());
+            m_rawBytes += size;
+            setp(m_raw.data(), m_raw.data() + m_raw.size());
+        }
+
+        void writeOut(const uint8_t* data, size_t size)
+        {
+            m_out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            if (!m_out)
+            {
+                throw std::runtime_error("Failed to write compressed stream");
+            }
+            m_written += size;
+        }
+
+        std::ostream&        m_out;
+        std::vector<char>    m_raw;
+        std::vector<uint8_t> m_encoded;
+        std::vector<uint8_t> m_scratch;
+        uint64_t             m_written = 0;
+        uint64_t             m_rawBytes = 0;
+        bool                 m_finished = false;
+    };
+
+    /**
+     * @brief Input stream buffer that decompresses one frame from a stream.
+     *
+     * Reads stop at the end of the frame, leaving the source positioned right after it.
+     */
+    class DecompressStreamBuf : public std::streambuf
+    {
+    public:
+        explicit DecompressStreamBuf(std::istream& in)
+            : m_in(in)
+        {
+            uint8_t magic[4];
+            readIn(magic, sizeof(magic), "Truncated compressed stream");
+            if (std::memcmp(magic, MAGIC.data(), MAGIC.size()) != 0)
+            {
+                throw std::runtime_error("Not a compressed stream");
+            }
+            setg(m_raw.data(), m_raw.data(), m_raw.data());
+        }
+
+        DecompressStreamBuf(const DecompressStreamBuf&) = delete;
+        DecompressStreamBuf& operator=(const DecompressStreamBuf&) = delete;
+
+        // True once the end of the frame has been read
+        bool complete() const { return m_complete; }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() == egptr() && !m_complete)
+            {
+                openBlock();
+            }
+            return gptr() == egptr() ? traits_type::eof() : traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        void openBlock()
+        {
+            uint8_t sizes[4];
+            readIn(sizes, sizeof(sizes), "Truncated compressed stream");
+            const uint32_t rawSize = decodeU32(sizes);
+            if (rawSize == 0)
+            {
+                m_complete = true;
+                setg(m_raw.data(), m_raw.data(), m_raw.data());
+                return;
+            }
+
+            readIn(sizes, sizeof(sizes), "Truncated compressed stream");
+            const uint32_t storedWord = decodeU32(sizes);
+            const uint32_t storedSize = storedWord & ~RAW_BLOCK;
+            checkBlockSizes(rawSize, storedSize);
+
+            m_raw.resize(rawSize);
+            if (storedWord & RAW_BLOCK)
+            {
+                if (storedSize != rawSize) throw std::runtime_error("Invalid stored block");
+                readIn(reinterpret_cast<uint8_t*>(m_raw.data()), rawSize, "Truncated compressed block");
+            }
+            else
+            {
+                m_stored.resize(storedSize);
+                readIn(m_stored.data(), storedSize, "Truncated compressed block");
+                decompressBlock(m_stored.data(), storedSize, reinterpret_cast<uint8_t*>(m_raw.data()), rawSize);
+            }
+            setg(m_raw.data(), m_raw.data(), m_raw.data() + rawSize);
+        }
+
+        void readIn(uint8_t* data, size_t size, const char* error)
+        {
+            m_in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(m_in.gcount()) != size)
+            {
+                throw std::runtime_error(error);
+            }
+        }
+
+        std::istream&        m_in;
+        std::vector<char>    m_raw;
+        std::vector<uint8_t> m_stored;
+        bool                 m_complete = false;
+    };
+
+private:
+    static constexpr std::array<uint8_t, 4> MAGIC = { 'K', 'L', 'Z', '1' };
+    static constexpr uint32_t RAW_BLOCK = 0x80000000u;
+
+    static constexpr size_t MIN_MATCH = 4;
+    // The format requires the last bytes of a block to be literals
+    static constexpr size_t LAST_LITERALS = 5;
+    static constexpr size_t MATCH_LIMIT = 12;
+    static constexpr size_t MAX_OFFSET = 65535;
+    static constexpr int    HASH_LOG = 16;
+
+    static void writeU32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            out.push_back(static_cast<uint8_t>((value >> shift) & 0xFF));
+        }
+    }
+
+    static uint32_t decodeU32(const uint8_t* p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static uint32_t readU32(const std::vector<uint8_t>& in, size_t& pos)
+    {
+        if (in.size() - pos < 4)
+        {
+            throw std::runtime_error("Truncated compressed frame");
+        }
+        const uint32_t value = decodeU32(in.data() + pos);
+        pos += 4;
+        return value;
+    }
+
+    static void checkBlockSizes(uint32_t rawSize, uint32_t storedSize)
+    {
+        if (rawSize > BLOCK_SIZE || storedSize > maxCompressedSize(BLOCK_SIZE))
+        {
+            throw std::runtime_error("Invalid compressed block size");
+        }
+    }
+
+    static size_t maxCompressedSize(size_t rawSize)
+    {
+        return rawSize + rawSize / 255 + 16;
+    }
+
+    // Compresses one block and appends its header and payload, falling back to a raw block.
+    static void appendBlock(std::vector<uint8_t>& out, const uint8_t* data, size_t size, std::vector<uint8_t>& scratch)
+    {
+        scratch.clear();
+        compressBlock(data, size, scratch);
+
+        writeU32(out, static_cast<uint32_t>(size));
+        if (scratch.size() < size)
+        {
+            writeU32(out, static_cast<uint32_t>(scratch.size()));
+            out.insert(out.end(), scratch.begin(), scratch.end());
+        }
+        else
+        {
+            writeU32(out, static_cast<uint32_t>(size) | RAW_BLOCK);
+            out.insert(out.end(), data, data + size);
+        }
+    }
+
+    static uint32_t read32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static uint32_t hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_LOG);
+    }
+
+    static void writeLength(std::vector<uint8_t>& out, size_t length)
+    {
+        while (length >= 255)
+        {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    static void emitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength,
+        size_t offset, size_t matchLength)
+    {
+        const size_t matchCode = matchLength >= MIN_MATCH ? matchLength - MIN_MATCH : 0;
+        uint8_t token = static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15));
+        out.push_back(token);
+        if (literalLength >= 15) writeLength(out, literalLength - 15);
+        out.insert(out.end(), literals, literals + literalLength);
+
+        if (matchLength == 0) return;
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (matchCode >= 15) writeLength(out, matchCode - 15);
+    }
+
+    static void compressBlock(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+    {
+        out.reserve(maxCompressedSize(size));
+
+        size_t anchor = 0;
+        if (size > MATCH_LIMIT)
+        {
+            // Positions are stored +1 so that 0 means "empty"
+            std::vector<uint32_t> table(size_t{ 1 } << HASH_LOG, 0);
+            const size_t limit = size - MATCH_LIMIT;
+            size_t pos = 0;
+            while (pos < limit)
+            {
+                const uint32_t sequence = read32(src + pos);
+                const uint32_t h = hash(sequence);
+                const size_t candidate = table[h];
+                table[h] = static_cast<uint32_t>(pos + 1);
+
+                if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || read32(src + candidate - 1) != sequence)
+                {
+                    // Skip faster through data that doesn't compress
+                    pos += 1 + ((pos - anchor) >> 6);
+                    continue;
+                }
+
+                const size_t match = candidate - 1;
+                size_t length = MIN_MATCH;
+                while (pos + length < size - LAST_LITERALS && src[match + length] == src[pos + length])
+                {
+                    ++length;
+                }
+
+                emitSequence(out, src + anchor, pos - anchor, pos - match, length);
+                pos += length;
+                anchor = pos;
+            }
+        }
+
+        emitSequence(out, src + anchor, size - anchor, 0, 0);
+    }
+
+    static void decompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity)
+    {
+        size_t in = 0;
+        size_t out = 0;
+
+        auto readLength = [&](size_t length) {
+            if (length != 15) return length;
+            uint8_t byte;
+            do
+            {
+                if (in >= size) throw std::runtime_error("Corrupt compressed block");
+                byte = src[in++];
+                length += byte;
+            } while (byte == 255);
+            return length;
+            };
+
+        while (in < size)
+        {
+            const uint8_t token = src[in++];
+
+            const size_t literalLength = readLength(token >> 4);
+            if (literalLength > size - in || literalLength > capacity - out)
+            {
+                throw std::runtime_error("Corrupt compressed block");
+            }
+            std::memcpy(dst + out, src + in, literalLength);
+            in += literalLength;
+            out += literalLength;
+
+            // The last sequence has literals only
+            if (in == size) break;
+
+            if (size - in < 2) throw std::runtime_error("Corrupt compressed block");
+            const size_t offset = src[in] | (src[in + 1] << 8);
+            in += 2;
+            if (offset == 0 || offset > out) throw std::runtime_error("Corrupt compressed block");
+
+            const size_t matchLength = readLength(token & 0x0F) + MIN_MATCH;
+            if (matchLength > capacity - out) throw std::runtime_error("Corrupt compressed block");
+
+            const uint8_t* match = dst + out - offset;
+            if (offset >= matchLength)
+            {
+                std::memcpy(dst + out, match, matchLength);
+            }
+            else
+            {
+                // Byte by byte: the match overlaps the bytes it produces
+                for (size_t i = 0; i < matchLength; ++i)
+                {
+                    dst[out + i] = match[i];
+                }
+            }
+            out += matchLength;
+        }
+
+        if (out != capacity)
+        {
+            throw std::runtime_error("Corrupt compressed block");
+        }
+    }
+};
@@ -18,7 +18,13 @@
 #include <openssl/sha.h>
 #include <vector>
 #include <array>
+#include <memory>
 #include <string>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <stdexcept>
 
 // TODO: use password-based key derivation function (PBKDF2) to generate key from password
 //       to be more secure.
@@ -30,6 +36,13 @@ public:
     static constexpr size_t TAG_SIZE = 16;
     static constexpr size_t KEY_SIZE = 32;
 
+    // Chunked stream format, see EncryptStreamBuf
+    static constexpr char     STREAM_MAGIC[4] = { 'K', 'G', 'C', '1' };
+    static constexpr size_t   STREAM_HEADER_SIZE = 16;
+    static constexpr size_t   STREAM_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t   STREAM_MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+    static constexpr uint32_t STREAM_FINAL_CHUNK = 0x80000000u;
+
     static std::array<uint8_t, KEY_SIZE> generateKey()
     {
         // Get the unique identifier for the device
@@ -236,4 +249,416 @@ public:
         EVP_CIPHER_CTX_free(ctx);
         return decrypted;
     }
+private:
+    using CipherContext = std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>;
+
+public:
+    /**
+     * @brief Output buffer that seals everything written to it as a chunked AES-256-GCM stream.
+     *
+     * Layout: "KGC1" | u32 chunk size | 8-byte random nonce prefix, followed by chunks of
+     * u32 length (high bit marks the final chunk) | ciphertext | tag. Each chunk's IV is
+     * the nonce prefix followed by its big-endian index, and each chunk authenticates the
+     * header, its index and its final flag, so reordered, dropped, spliced or truncated
+     * chunks fail to decrypt. Memory use is one chunk whatever the payload size.
+     *
+     * Call finish() once everything is written; a stream without its final chunk does
+     * not decrypt.
+     */
+    class EncryptStreamBuf : public std::streambuf
+    {
+    public:
+        EncryptStreamBuf(std::ostream& out, const std::array<uint8_t, KEY_SIZE>& key,
+            size_t chunkSize = STREAM_CHUNK_SIZE)
+            : m_out(out), m_ctx(newCipherContext())
+        {
+            if (chunkSize == 0 || chunkSize > STREAM_MAX_CHUNK_SIZE)
+            {
+                throw std::invalid_argument("Invalid stream chunk size");
+            }
+
+            std::memcpy(m_header.data(), STREAM_MAGIC, sizeof(STREAM_MAGIC));
+            writeLE32(m_header.data() + 4, static_cast<uint32_t>(chunkSize));
+            if (RAND_bytes(m_header.data() + 8, STREAM_HEADER_SIZE - 8) != 1)
+            {
+                throw std::runtime_error("Failed to generate stream nonce");
+            }
+            if (EVP_EncryptInit_ex(m_ctx.get(), EVP_aes_256_gcm(), nullptr, key.data(), nullptr) != 1)
+            {
+                throw std::runtime_error("Failed to initialize encryption");
+            }
+
+            m_plain.resize(chunkSize);
+            m_sealed.resize(chunkSize);
+            writeOut(m_header.data(), m_header.size());
+            setp(m_plain.data(), m_plain.data() + m_plain.size());
+        }
+
+        EncryptStreamBuf(const EncryptStreamBuf&) = delete;
+        EncryptStreamBuf& operator=(const EncryptStreamBuf&) = delete;
+
+        /**
+         * @brief Seals the buffered tail as the final chunk.
+         * @return Total bytes written to the output stream.
+         */
+        uint64_t finish()
+        {
+            if (!m_finished)
+            {
+                sealChunk(true);
+                m_finished = true;
+                setp(nullptr, nullptr);
+            }
+            return m_written;
+        }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (m_finished)
+            {
+                return traits_type::eof();
+            }
+            if (traits_type::eq_int_type(ch, traits_type::eof()))
+            {
+                return traits_type::not_eof(ch);
+            }
+
+            // More data follows, so the full chunk can't be the final one
+            if (pptr() == epptr())
+            {
+                sealChunk(false);
+            }
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+            return ch;
+        }
+
+    private:
+        void sealChunk(bool final)
+        {
+            if (!final && m_index == UINT32_MAX)
+            {
+                throw std::runtime_error("Encrypted stream too long");
+            }
+
+            const size_t size = static_cast<size_t>(pptr() - pbase());
+            const auto iv = chunkIv(m_header, m_index);
+            const auto aad = chunkAad(m_header, m_index, final);
+            unsigned char tag[TAG_SIZE];
+            int len = 0, finalLen = 0;
+
+            if (EVP_EncryptInit_ex(m_ctx.get(), nullptr, nullptr, nullptr, iv.data()) != 1 ||
+                EVP_EncryptUpdate(m_ctx.get(), nullptr, &len, aad.data(), static_cast<int>(aad.size())) != 1 ||
+                EVP_EncryptUpdate(m_ctx.get(), m_sealed.data(), &len,
+                    reinterpret_cast<const unsigned char*>(pbase()), static_cast<int>(size)) != 1 ||
+                EVP_EncryptFinal_ex(m_ctx.get(), m_sealed.data() + len, &finalLen) != 1 ||
+                EVP_CIPHER_CTX_ctrl(m_ctx.get(), EVP_CTRL_GCM_GET_TAG, TAG_SIZE, tag) != 1)
+            {
+                throw std::runtime_error("Failed to encrypt stream chunk");
+            }
+
+            unsigned char length[4];
+            writeLE32(length, static_cast<uint32_t>(size) | (final ? STREAM_FINAL_CHUNK : 0));
+            writeOut(length, sizeof(length));
+            writeOut(m_sealed.data(), size);
+            writeOut(tag, sizeof(tag));
+
+            ++m_index;
+            setp(m_plain.data(), m_plain.data() + m_plain.size());
+        }
+
+        void writeOut(const unsigned char* data, size_t size)
+        {
+            if (!m_out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size)))
+            {
+                throw std::runtime_error("Failed to write encrypted stream");
+            }
+            m_written += size;
+        }
+
+        std::ostream&                             m_out;
+        CipherContext                             m_ctx;
+        std::array<uint8_t, STREAM_HEADER_SIZE>   m_header{};
+        std::vector<char>                         m_plain;
+        std::vector<uint8_t>                      m_sealed;
+        uint32_t                                  m_index = 0;
+        uint64_t                                  m_written = 0;
+        bool                                      m_finished = false;
+    };
+
+    /**
+     * @brief Input buffer that yields the plaintext of a stream written by EncryptStreamBuf.
+     *
+     * Each chunk is authenticated before any of its bytes are handed out. Errors throw
+     * from the underlying reads; std::istream turns them into badbit, so callers reading
+     * through one should check complete() before trusting what they read.
+     */
+    class DecryptStreamBuf : public std::streambuf
+    {
+    public:
+        DecryptStreamBuf(std::istream& in, const std::array<uint8_t, KEY_SIZE>& key)
+            : m_in(in), m_ctx(newCipherContext())
+        {
+            readIn(m_header.data(), m_header.size(), "Truncated stream header");
+            if (std::memcmp(m_header.data(), STREAM_MAGIC, sizeof(STREAM_MAGIC)) != 0)
+            {
+                throw std::runtime_error("Not a chunked encrypted stream");
+            }
+
+            const size_t chunkSize = readLE32(m_header.data() + 4);
+            if (chunkSize == 0 || chunkSize > STREAM_MAX_CHUNK_SIZE)
+            {
+                throw std::runtime_error("Invalid stream chunk size");
+            }
+            if (EVP_DecryptInit_ex(m_ctx.get(), EVP_aes_256_gcm(), nullptr, key.data(), nullptr) != 1)
+            {
+                throw std::runtime_error("Failed to initialize decryption");
+            }
+
+            m_plain.resize(chunkSize);
+            m_sealed.resize(chunkSize);
+            setg(m_plain.data(), m_plain.data(), m_plain.data());
+        }
+
+        DecryptStreamBuf(const DecryptStreamBuf&) = delete;
+        DecryptStreamBuf& operator=(const DecryptStreamBuf&) = delete;
+
+        // True once the final chunk has been authenticated with nothing after it
+        bool complete() const { return m_complete; }
+
+    protected:
+        int_type underflow() override
+        {
+            // Loop because the final chunk may be empty
+            while (gptr() == egptr() && !m_complete)
+            {
+                openChunk();
+            }
+            return gptr() == egptr() ? traits_type::eof() : traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        void openChunk()
+        {
+            unsigned char length[4];
+            readIn(length, sizeof(length), "Truncated encrypted stream");
+            const uint32_t word = readLE32(length);
+            const bool final = (word & STREAM_FINAL_CHUNK) != 0;
+            const size_t size = word & ~STREAM_FINAL_CHUNK;
+            if (size > m_plain.size() || (!final && size != m_plain.size()))
+            {
+                throw std::runtime_error("Malformed encrypted stream chunk");
+            }
+            if (!final && m_index == UINT32_MAX)
+            {
+                throw std::runtime_error("Encrypted stream too long");
+            }
+
+            unsigned char tag[TAG_SIZE];
+            readIn(m_sealed.data(), size, "Truncated encrypted stream");
+            readIn(tag, sizeof(tag), "Truncated encrypted stream");
+
+            const auto iv = chunkIv(m_header, m_index);
+            const auto aad = chunkAad(m_header, m_index, final);
+            int len = 0, finalLen = 0;
+            if (EVP_DecryptInit_ex(m_ctx.get(), nullptr, nullptr, nullptr, iv.data()) != 1 ||
+                EVP_DecryptUpdate(m_ctx.get(), nullptr, &len, aad.data(), static_cast<int>(aad.size())) != 1 ||
+                EVP_DecryptUpdate(m_ctx.get(), reinterpret_cast<unsigned char*>(m_plain.data()), &len,
+                    m_sealed.data(), static_cast<int>(size)) != 1 ||
+                EVP_CIPHER_CTX_ctrl(m_ctx.get(), EVP_CTRL_GCM_SET_TAG, TAG_SIZE, tag) != 1 ||
+                EVP_DecryptFinal_ex(m_ctx.get(), reinterpret_cast<unsigned char*>(m_plain.data()) + len, &finalLen) != 1)
+            {
+                throw std::runtime_error("Failed to verify encrypted stream chunk " + std::to_string(m_index));
+            }
+
+            if (final)
+            {
+                if (m_in.peek() != std::char_traits<char>::eof())
+                {
+                    throw std::runtime_error("Unexpected data after encrypted stream");
+                }
+                m_complete = true;
+            }
+            ++m_index;
+            setg(m_plain.data(), m_plain.data(), m_plain.data() + size);
+        }
+
+        void readIn(unsigned char* data, size_t size, const char* error)
+        {
+            m_in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(m_in.gcount()) != size)
+            {
+                throw std::runtime_error(error);
+            }
+        }
+
+        std::istream&                             m_in;
+        CipherContext                             m_ctx;
+        std::array<uint8_t, STREAM_HEADER_SIZE>   m_header{};
+        std::vector<char>                         m_plain;
+        std::vector<uint8_t>                      m_sealed;
+        uint32_t                                  m_index = 0;
+        bool                                      m_complete = false;
+    };
+
+    /**
+     * @brief Incremental SHA-256, for hashing data piece by piece as it arrives.
+     */
+    class Sha256
+    {
+    public:
+        Sha256()
+            : m_ctx(EVP_MD_CTX_new(), &EVP_MD_CTX_free)
+        {
+            if (!m_ctx)
+            {
+                throw std::runtime_error("Failed to create EVP_MD_CTX");
+            }
+            reset();
+        }
+
+        void reset()
+        {
+            if (EVP_DigestInit_ex(m_ctx.get(), EVP_sha256(), nullptr) != 1)
+            {
+                throw std::runtime_error("Failed to initialize SHA-256");
+            }
+        }
+
+        void update(const void* data, size_t size)
+        {
+            if (EVP_DigestUpdate(m_ctx.get(), data, size) != 1)
+            {
+                throw std::runtime_error("Failed to update SHA-256");
+            }
+        }
+
+        // Lowercase hex digest of everything since the last reset; reset before reusing
+        std::string finishHex()
+        {
+            unsigned char hash[SHA256_DIGEST_LENGTH];
+            if (EVP_DigestFinal_ex(m_ctx.get(), hash, nullptr) != 1)
+            {
+                throw std::runtime_error("Failed to finalize SHA-256");
+            }
+
+            static const char* digits = "0123456789abcdef";
+            std::string hex;
+            hex.reserve(2 * SHA256_DIGEST_LENGTH);
+            for (unsigned char byte : hash)
+            {
+                hex.push_back(digits[byte >> 4]);
+                hex.push_back(digits[byte & 0x0F]);
+            }
+            return hex;
+        }
+
+    private:
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> m_ctx;
+    };
+
+    // Checks for the chunked stream magic without consuming anything
+    static bool isStreamFormat(std::istream& in)
+    {
+        const auto start = in.tellg();
+        char magic[sizeof(STREAM_MAGIC)] = {};
+        in.read(magic, sizeof(magic));
+        const bool matches = in.gcount() == sizeof(magic) &&
+            std::memcmp(magic, STREAM_MAGIC, sizeof(magic)) == 0;
+        in.clear();
+        in.seekg(start);
+        return matches;
+    }
+
+    /**
+     * @brief Encrypts everything left in `in` to `out` as a chunked stream.
+     * @return Bytes written to `out`.
+     */
+    static uint64_t encryptStream(std::istream& in, std::ostream& out,
+        const std::array<uint8_t, KEY_SIZE>& key, size_t chunkSize = STREAM_CHUNK_SIZE)
+    {
+        EncryptStreamBuf sealed(out, key, chunkSize);
+        std::vector<char> buffer(chunkSize);
+        while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0)
+        {
+            sealed.sputn(buffer.data(), in.gcount());
+        }
+        if (in.bad())
+        {
+            throw std::runtime_error("Failed to read plaintext stream");
+        }
+        return sealed.finish();
+    }
+
+    /**
+     * @brief Decrypts a chunked stream from `in` to `out`. On failure `out` may already
+     *        hold the plaintext of the chunks before the bad one and must be discarded.
+     * @return Plaintext bytes written to `out`.
+     */
+    static uint64_t decryptStream(std::istream& in, std::ostream& out,
+        const std::array<uint8_t, KEY_SIZE>& key)
+    {
+        DecryptStreamBuf sealed(in, key);
+        std::vector<char> buffer(STREAM_CHUNK_SIZE);
+        uint64_t total = 0;
+        while (const std::streamsize read = sealed.sgetn(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+        {
+            if (!out.write(buffer.data(), read))
+            {
+                throw std::runtime_error("Failed to write plaintext stream");
+            }
+            total += static_cast<uint64_t>(read);
+        }
+        if (!sealed.complete())
+        {
+            throw std::runtime_error("Truncated encrypted stream");
+        }
+        return total;
+    }
+
+private:
+    static CipherContext newCipherContext()
+    {
+        CipherContext ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+        if (!ctx)
+        {
+            throw std::runtime_error("Failed to create cipher context");
+        }
+        return ctx;
+    }
+
+    static void writeLE32(unsigned char* out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static uint32_t readLE32(const unsigned char* in)
+    {
+        return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+    }
+
+    static std::array<uint8_t, IV_SIZE> chunkIv(const std::array<uint8_t, STREAM_HEADER_SIZE>& header, uint32_t index)
+    {
+        std::array<uint8_t, IV_SIZE> iv{};
+        std::memcpy(iv.data(), header.data() + 8, 8);
+        for (int i = 0; i < 4; ++i)
+        {
+            iv[8 + i] = static_cast<uint8_t>((index >> (24 - 8 * i)) & 0xFF);
+        }
+        return iv;
+    }
+
+    static std::array<uint8_t, STREAM_HEADER_SIZE + 5> chunkAad(
+        const std::array<uint8_t, STREAM_HEADER_SIZE>& header, uint32_t index, bool final)
+    {
+        std::array<uint8_t, STREAM_HEADER_SIZE + 5> aad{};
+        std::memcpy(aad.data(), header.data(), header.size());
+        writeLE32(aad.data() + STREAM_HEADER_SIZE, index);
+        aad[STREAM_HEADER_SIZE + 4] = final ? 1 : 0;
+        return aad;
+    }
 };
\ No newline at end of file
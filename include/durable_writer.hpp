@@ -0,0 +1,397 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+/**
+ * @brief Replaces files atomically, with fsyncs grouped across concurrent writers.
+ *
+ * write() produces the new contents in a temp file next to the target and renames it
+ * over the target, so readers and crashes only ever see the old or the new file, never
+ * a truncated one. How much of that survives a power loss depends on the durability:
+ *
+ *  - NONE       no fsync; atomic against crashes of the process only.
+ *  - BATCHED    writers hand their temp files to one sync thread, which waits up to
+ *               groupWindow for more, fsyncs the whole batch, renames it and fsyncs
+ *               each directory once. Each write() returns when its file is durable.
+ *  - IMMEDIATE  the calling thread fsyncs and renames on its own.
+ *
+ * A crash between creating a temp file and renaming it leaves `<target>.tmpN`
+ * behind; persistence layers call removeStaleTemps() when they load to clear those.
+ *
+ * One shared instance, never destroyed, so objects with static lifetime can still
+ * write while the program exits.
+ */
+class DurableWriter
+{
+public:
+    enum class Durability
+    {
+        NONE,
+        BATCHED,
+        IMMEDIATE
+    };
+
+    struct Options
+    {
+        Durability                durability = Durability::BATCHED;
+        // How long the sync thread waits for more writes before syncing a batch
+        std::chrono::milliseconds groupWindow{ 5 };
+        size_t                    maxBatch = 64;
+    };
+
+    struct Stats
+    {
+        uint64_t writes = 0;
+        uint64_t failures = 0;
+        uint64_t syncBatches = 0;
+        uint64_t syncedFiles = 0;
+    };
+
+    static DurableWriter& instance()
+    {
+        static DurableWriter* writer = new DurableWriter();
+        return *writer;
+    }
+
+    DurableWriter(const DurableWriter&) = delete;
+    DurableWriter& operator=(const DurableWriter&) = delete;
+
+    void setOptions(const Options& options)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_options = options;
+        m_cv.notify_all();
+    }
+
+    Options getOptions() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_options;
+    }
+
+    Stats getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    /**
+     * @brief Replaces `target` with whatever `produce` writes to the stream.
+     * @return False if producing, syncing or renaming failed; the target is then
+     *         left as it was. Exceptions thrown by `produce` are caught and logged.
+     */
+    bool write(const std::filesystem::path& target, const std::function<void(std::ostream&)>& produce)
+    {
+        const std::filesystem::path tempPath = makeTempPath(target);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlight.insert(inFlightKey(tempPath));
+        }
+
+        try
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                throw std::runtime_error("cannot create " + tempPath.string());
+            }
+            produce(file);
+            file.close();
+            if (!file)
+            {
+                throw std::runtime_error("write to " + tempPath.string() + " failed");
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[DurableWriter] Failed to write " << target << ": " << e.what() << "\n";
+            discard(tempPath);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlight.erase(inFlightKey(tempPath));
+            return false;
+        }
+
+        Durability durability;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            durability = m_options.durability;
+            ++m_stats.writes;
+        }
+
+        bool committed = false;
+        switch (durability)
+        {
+        case Durability::NONE:
+            committed = replace(tempPath, target, false);
+            break;
+        case Durability::IMMEDIATE:
+            committed = syncFile(tempPath) && replace(tempPath, target, true);
+            if (committed)
+            {
+                syncDirectory(target.parent_path());
+            }
+            recordSync(1);
+            break;
+        case Durability::BATCHED:
+            committed = commitBatched(tempPath, target);
+            break;
+        }
+
+        if (!committed)
+        {
+            std::cerr << "[DurableWriter] Failed to commit " << target << "\n";
+            discard(tempPath);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight.erase(inFlightKey(tempPath));
+        if (!committed)
+        {
+            ++m_stats.failures;
+        }
+        return committed;
+    }
+
+    bool write(const std::filesystem::path& target, const std::string& contents)
+    {
+        return write(target, [&contents](std::ostream& out) {
+            out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            });
+    }
+
+    /**
+     * @brief Deletes temp files left in `directory` by writes that never committed, e.g.
+     *        because the process died. Only `targetName`'s temps if one is given. Temps of
+     *        writes still in progress are kept.
+     * @return The number of files deleted.
+     */
+    size_t removeStaleTemps(const std::filesystem::path& directory, const std::string& targetName = "")
+    {
+        std::vector<std::filesystem::path> stale;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            const std::string fileName = it->path().filename().string();
+            const size_t marker = fileName.rfind(".tmp");
+            if (marker == std::string::npos || marker == 0 || marker + 4 == fileName.size() ||
+                fileName.find_first_not_of("0123456789", marker + 4) != std::string::npos)
+            {
+                continue;
+            }
+            if (!targetName.empty() && fileName.compare(0, marker, targetName) != 0)
+            {
+                continue;
+            }
+            stale.push_back(it->path());
+        }
+
+        size_t removed = 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& path : stale)
+        {
+            if (m_inFlight.count(inFlightKey(path)) == 0 && std::filesystem::remove(path, ec))
+            {
+                ++removed;
+            }
+        }
+        if (removed > 0)
+        {
+            std::cerr << "[DurableWriter] Removed " << removed << " stale temp file(s) from " << directory << "\n";
+        }
+        return removed;
+    }
+
+private:
+    struct Pending
+    {
+        std::filesystem::path tempPath;
+        std::filesystem::path target;
+        std::promise<bool>    committed;
+    };
+
+    DurableWriter()
+    {
+        m_syncThread = std::thread(&DurableWriter::syncLoop, this);
+    }
+
+    bool commitBatched(const std::filesystem::path& tempPath, const std::filesystem::path& target)
+    {
+        std::future<bool> committed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.empty())
+            {
+                m_batchStart = std::chrono::steady_clock::now();
+            }
+            m_pending.push_back({ tempPath, target, std::promise<bool>() });
+            committed = m_pending.back().committed.get_future();
+        }
+        m_cv.notify_all();
+        return committed.get();
+    }
+
+    void syncLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cv.wait(lock, [this]() { return !m_pending.empty(); });
+
+            // Give concurrent writers a moment to join the batch
+            while (m_pending.size() < m_options.maxBatch &&
+                m_cv.wait_until(lock, m_batchStart + m_options.groupWindow) != std::cv_status::timeout)
+            {
+            }
+
+            std::vector<Pending> batch;
+            batch.swap(m_pending);
+            lock.unlock();
+
+            std::vector<bool> synced(batch.size());
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                synced[i] = syncFile(batch[i].tempPath);
+            }
+
+            // Rename in arrival order, so the newest of two writes to one file wins
+            std::set<std::filesystem::path> directories;
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                if (synced[i] && replace(batch[i].tempPath, batch[i].target, true))
+                {
+                    directories.insert(batch[i].target.parent_path());
+                }
+                else
+                {
+                    synced[i] = false;
+                }
+            }
+            for (const auto& directory : directories)
+            {
+                syncDirectory(directory);
+            }
+
+            recordSync(batch.size());
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                batch[i].committed.set_value(synced[i]);
+            }
+
+            lock.lock();
+        }
+    }
+
+    void recordSync(size_t files)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.syncBatches;
+        m_stats.syncedFiles += files;
+    }
+
+    std::filesystem::path makeTempPath(const std::filesystem::path& target)
+    {
+        // Same directory as the target, so the rename never crosses file systems
+        return std::filesystem::path(target).concat(".tmp" + std::to_string(++m_tempCounter));
+    }
+
+    // The same temp file reached through a relative and an absolute path compares equal
+    static std::filesystem::path inFlightKey(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        const std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+        return (ec ? path : absolute).lexically_normal();
+    }
+
+    static void discard(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    static bool replace(const std::filesystem::path& from, const std::filesystem::path& to, bool writeThrough)
+    {
+#ifdef _WIN32
+        DWORD flags = MOVEFILE_REPLACE_EXISTING;
+        if (writeThrough)
+        {
+            flags |= MOVEFILE_WRITE_THROUGH;
+        }
+        return MoveFileExW(from.wstring().c_str(), to.wstring().c_str(), flags) != 0;
+#else
+        (void)writeThrough;
+        std::error_code ec;
+        std::filesystem::rename(from, to, ec);
+        return !ec;
+#endif
+    }
+
+    static bool syncFile(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        HANDLE handle = CreateFileW(path.wstring().c_str(), GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        const bool flushed = FlushFileBuffers(handle) != 0;
+        CloseHandle(handle);
+        return flushed;
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        const bool flushed = ::fsync(fd) == 0;
+        ::close(fd);
+        return flushed;
+#endif
+    }
+
+    // Makes a rename in the directory durable. MoveFileEx's write-through covers this on Windows.
+    static void syncDirectory(const std::filesystem::path& directory)
+    {
+#ifndef _WIN32
+        const int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd >= 0)
+        {
+            ::fsync(fd);
+            ::close(fd);
+        }
+#else
+        (void)directory;
+#endif
+    }
+
+    mutable std::mutex                    m_mutex;
+    std::condition_variable               m_cv;
+    Options                               m_options;
+    Stats                                 m_stats;
+    std::vector<Pending>                  m_pending;
+    // Temp files of writes that haven't returned yet, which removeStaleTemps() must keep
+    std::set<std::filesystem::path>       m_inFlight;
+    std::chrono::steady_clock::time_point m_batchStart;
+    std::atomic<uint64_t>                 m_tempCounter{ 0 };
+    std::thread                           m_syncThread;
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+/**
+ * @brief Multiplexes many long-lived, mostly idle jobs over a small fixed set of threads.
+ *
+ * A job is a step function that runs whenever the job is woken and returns true once the
+ * job is complete. Instead of parking one OS thread per job, producers call wake() when
+ * there is work to do and any free worker runs the next step. A job is never stepped on
+ * two workers at once, and jobs that are not woken for `idleTimeout` are stepped anyway
+ * so a lost wake-up can't stall them forever.
+ */
+class JobPump {
+public:
+    using Handle = uint64_t;
+    using StepFn = std::function<bool()>;
+    using DoneFn = std::function<void()>;
+
+    explicit JobPump(size_t numThreads = 4,
+        std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(1000))
+        : m_idleTimeout(idleTimeout)
+        , m_lastIdleScan(std::chrono::steady_clock::now())
+    {
+        m_workers.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~JobPump() {
+        shutdown();
+    }
+
+    JobPump(const JobPump&) = delete;
+    JobPump& operator=(const JobPump&) = delete;
+
+    // Registers a job without running it; call wake() to schedule its first step.
+    // `onDone` runs exactly once, on a worker, after the final step or a cancel().
+    Handle add(StepFn step, DoneFn onDone = nullptr) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Handle handle = ++m_nextHandle;
+        Job& job = m_jobs[handle];
+        job.step = std::move(step);
+        job.onDone = std::move(onDone);
+        job.lastRun = std::chrono::steady_clock::now();
+        return handle;
+    }
+
+    void wake(Handle handle) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(handle);
+            if (it == m_jobs.end()) return;
+            if (!enqueueLocked(handle, it->second)) return;
+        }
+        m_condition.notify_one();
+    }
+
+    // The job's step is not called again; its onDone still runs.
+    void cancel(Handle handle) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(handle);
+            if (it == m_jobs.end()) return;
+            it->second.cancelled = true;
+            if (!enqueueLocked(handle, it->second)) return;
+        }
+        m_condition.notify_one();
+    }
+
+    // Stops the workers after their current step. Jobs still registered are dropped
+    // without running their onDone.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) return;
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        for (std::thread& worker : m_workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.clear();
+        m_ready.clear();
+    }
+
+    // Jobs that are ready to step but waiting for a free worker.
+    size_t queueDepth() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_ready.size();
+    }
+
+    // Jobs registered with the pump, idle or not.
+    size_t activeJobs() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_jobs.size();
+    }
+
+    size_t busyWorkers() const {
+        return m_busyWorkers.load();
+    }
+
+private:
+    struct Job {
+        StepFn step;
+        DoneFn onDone;
+        bool queued = false;
+        bool running = false;
+        bool rerun = false;
+        bool cancelled = false;
+        std::chrono::steady_clock::time_point lastRun;
+    };
+
+    // Returns true if the job was put on the ready queue.
+    bool enqueueLocked(Handle handle, Job& job) {
+        if (job.running) {
+            job.rerun = true;
+            return false;
+        }
+        if (job.queued) return false;
+
+        job.queued = true;
+        m_ready.push_back(handle);
+        return true;
+    }
+
+    void wakeIdleJobsLocked() {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_lastIdleScan < m_idleTimeout) return;
+        m_lastIdleScan = now;
+
+        for (auto& [handle, job] : m_jobs) {
+            if (!job.running && !job.queued && now - job.lastRun >= m_idleTimeout) {
+                enqueueLocked(handle, job);
+            }
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_condition.wait_for(lock, m_idleTimeout, [this] {
+                return m_stop || !m_ready.empty();
+                });
+            if (m_stop) return;
+
+            wakeIdleJobsLocked();
+            if (m_ready.empty()) continue;
+
+            Handle handle = m_ready.front();
+            m_ready.pop_front();
+
+            auto it = m_jobs.find(handle);
+            if (it == m_jobs.end()) continue;
+
+            Job& job = it->second;
+            job.queued = false;
+            job.running = true;
+            job.rerun = false;
+            bool done = job.cancelled;
+            StepFn step = job.step;
+
+            ++m_busyWorkers;
+            lock.unlock();
+            if (!done) {
+                try {
+                    done = step();
+                }
+                catch (...) {
+                    done = true;
+                }
+            }
+            lock.lock();
+            --m_busyWorkers;
+
+            // References into m_jobs stay valid; only this worker erases the running job
+            job.running = false;
+            job.lastRun = std::chrono::steady_clock::now();
+
+            if (m_stop) return;
+
+            if (done || job.cancelled) {
+                DoneFn onDone = std::move(job.onDone);
+                m_jobs.erase(handle);
+
+                lock.unlock();
+                if (onDone) onDone();
+                lock.lock();
+                continue;
+            }
+
+            if (job.rerun) {
+                job.rerun = false;
+                if (enqueueLocked(handle, job)) {
+                    m_condition.notify_one();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::unordered_map<Handle, Job> m_jobs;
+    std::deque<Handle> m_ready;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<size_t> m_busyWorkers{ 0 };
+    const std::chrono::milliseconds m_idleTimeout;
+    std::chrono::steady_clock::time_point m_lastIdleScan;
+    Handle m_nextHandle = 0;
+    bool m_stop = false;
+};
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <condition_variable>
+
+namespace Model
+{
+    /**
+     * @brief Thrown inside the server handlers when a request is refused by admission control.
+     *
+     * Carries an HTTP-style status: 429 (queue full or queue timeout) or 503 (model
+     * unloaded while the request was waiting). The ServerAPI callbacks catch it, log the
+     * status and answer with an empty response, since they cannot return a status code.
+     */
+    class AdmissionRejectedError : public std::runtime_error
+    {
+    public:
+        AdmissionRejectedError(int statusCode, const std::string& message)
+            : std::runtime_error(message), m_statusCode(statusCode)
+        {
+        }
+
+        int statusCode() const { return m_statusCode; }
+
+    private:
+        int m_statusCode;
+    };
+
+    /**
+     * @brief Per-model admission queue for server requests.
+     *
+     * Each model admits at most `concurrency` requests at a time (normally the
+     * n_parallel it was loaded with). Further requests wait in FIFO order, up to
+     * `maxQueueDepth` of them for at most `queueTimeout`; anything beyond that is
+     * rejected immediately so overload shows up as fast failures instead of latency.
+     */
+    class AdmissionController
+    {
+    public:
+        enum class Status
+        {
+            Admitted,
+            QueueFull,
+            TimedOut,
+            ModelUnavailable
+        };
+
+        /**
+         * @brief Holds one admitted slot; the slot is released when the ticket is destroyed.
+         */
+        class Ticket
+        {
+        public:
+            Ticket() = default;
+            ~Ticket() { release(); }
+
+            Ticket(const Ticket&) = delete;
+            Ticket& operator=(const Ticket&) = delete;
+
+            void release()
+            {
+                if (m_owner)
+                {
+                    m_owner->release(m_modelId, m_generation);
+                    m_owner = nullptr;
+                }
+            }
+
+        private:
+            friend class AdmissionController;
+
+            AdmissionController* m_owner = nullptr;
+            std::string          m_modelId;
+            uint64_t             m_generation = 0;
+        };
+
+        struct Result
+        {
+            Status                  status = Status::ModelUnavailable;
+            std::chrono::milliseconds queueWait{ 0 };
+            std::shared_ptr<Ticket> ticket;
+
+            bool admitted() const { return status == Status::Admitted; }
+        };
+
+        struct ModelStats
+        {
+            int    concurrency = 0;
+            int    running = 0;
+            size_t queued = 0;
+            size_t rejected = 0;
+        };
+
+        explicit AdmissionController(size_t maxQueueDepth = 64,
+            std::chrono::milliseconds queueTimeout = std::chrono::seconds(30))
+            : m_maxQueueDepth(maxQueueDepth), m_queueTimeout(queueTimeout)
+        {
+        }
+
+        AdmissionController(const AdmissionController&) = delete;
+        AdmissionController& operator=(const AdmissionController&) = delete;
+
+        void setLimits(size_t maxQueueDepth, std::chrono::milliseconds queueTimeout)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_maxQueueDepth = maxQueueDepth;
+            m_queueTimeout = queueTimeout;
+        }
+
+        // Registers (or re-registers after a reload) a model with the given concurrency.
+        void setConcurrency(const std::string& modelId, int concurrency)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto [it, inserted] = m_queues.try_emplace(modelId);
+                if (inserted)
+                {
+                    it->second.generation = ++m_generation;
+                }
+                Queue& queue = it->second;
+                queue.concurrency = concurrency > 0 ? concurrency : 1;
+            }
+            m_cv.notify_all();
+        }
+
+        // Forgets a model; requests still waiting for it are rejected.
+        void removeModel(const std::string& modelId)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queues.erase(modelId);
+            }
+            m_cv.notify_all();
+        }
+
+        /**
+         * @brief Blocks until a slot for the model is free, the queue timeout elapses,
+         *        or the model is removed. Fails immediately if the queue is already full.
+         */
+        Result acquire(const std::string& modelId)
+        {
+            Result result;
+            const auto start = std::chrono::steady_clock::now();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto it = m_queues.find(modelId);
+            if (it == m_queues.end())
+            {
+                return result;
+            }
+
+            Queue* queue = &it->second;
+            const uint64_t generation = queue->generation;
+
+            if (queue->running >= queue->concurrency && queue->waiting.size() >= m_maxQueueDepth)
+            {
+                ++queue->rejected;
+                result.status = Status::QueueFull;
+                return result;
+            }
+
+            const uint64_t ticketNo = queue->nextTicket++;
+            queue->waiting.insert(ticketNo);
+
+            const auto deadline = start + m_queueTimeout;
+            bool ready = m_cv.wait_until(lock, deadline, [&]() {
+                auto found = m_queues.find(modelId);
+                if (found == m_queues.end() || found->second.generation != generation)
+                {
+                    return true;
+                }
+                queue = &found->second;
+                return queue->running < queue->concurrency &&
+                    *queue->waiting.begin() == ticketNo;
+                });
+
+            result.queueWait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            auto found = m_queues.find(modelId);
+            if (found == m_queues.end() || found->second.generation != generation)
+            {
+                result.status = Status::ModelUnavailable;
+                return result;
+            }
+
+            queue = &found->second;
+            queue->waiting.erase(ticketNo);
+
+            if (!ready)
+            {
+                ++queue->rejected;
+                result.status = Status::TimedOut;
+                lock.unlock();
+                // Our departure may let the next waiter in line proceed
+                m_cv.notify_all();
+                return result;
+            }
+
+            ++queue->running;
+            result.status = Status::Admitted;
+            result.ticket = std::make_shared<Ticket>();
+            result.ticket->m_owner = this;
+            result.ticket->m_modelId = modelId;
+            result.ticket->m_generation = generation;
+            lock.unlock();
+
+            // The next waiter may be admissible too if concurrency is above one
+            m_cv.notify_all();
+            return result;
+        }
+
+        /**
+         * @brief Takes a slot only if one is free right now and nobody is queued for it.
+         *        Never waits and never counts as a rejection; returns nullptr otherwise.
+         */
+        std::shared_ptr<Ticket> tryAcquire(const std::string& modelId)
+        {
+            std::shared_ptr<Ticket> ticket;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_queues.find(modelId);
+            if (it == m_queues.end())
+            {
+                return ticket;
+            }
+
+            Queue& queue = it->second;
+            if (queue.running >= queue.concurrency || !queue.waiting.empty())
+            {
+                return ticket;
+            }
+
+            ++queue.running;
+            ticket = std::make_shared<Ticket>();
+            ticket->m_owner = this;
+            ticket->m_modelId = modelId;
+            ticket->m_generation = queue.generation;
+            return ticket;
+        }
+
+        /**
+         * @brief Counts and reports a rejection if acquire() would fail right away because
+         *        the model's queue is full. Lets callers turn a request away before doing
+         *        expensive work for it; models not registered yet are never full.
+         */
+        bool rejectIfQueueFull(const std::string& modelId)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_queues.find(modelId);
+            if (it == m_queues.end())
+            {
+                return false;
+            }
+
+            Queue& queue = it->second;
+            if (queue.running >= queue.concurrency && queue.waiting.size() >= m_maxQueueDepth)
+            {
+                ++queue.rejected;
+                return true;
+            }
+            return false;
+        }
+
+        ModelStats getStats(const std::string& modelId) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ModelStats stats;
+            auto it = m_queues.find(modelId);
+            if (it != m_queues.end())
+            {
+                stats.concurrency = it->second.concurrency;
+                stats.running = it->second.running;
+                stats.queued = it->second.waiting.size();
+                stats.rejected = it->second.rejected;
+            }
+            return stats;
+        }
+
+        static const char* statusToString(Status status)
+        {
+            switch (status)
+            {
+            case Status::Admitted:         return "admitted";
+            case Status::QueueFull:        return "queue full";
+            case Status::TimedOut:         return "queue timeout";
+            case Status::ModelUnavailable: return "model unavailable";
+            }
+            return "unknown";
+        }
+
+    private:
+        struct Queue
+        {
+            int      concurrency = 1;
+            int      running = 0;
+            size_t   rejected = 0;
+            uint64_t nextTicket = 0;
+            // Identifies this registration, so tickets from before an unload/reload are ignored
+            uint64_t generation = 0;
+            // Ordered by arrival so slots are handed out first come, first served
+            std::set<uint64_t> waiting;
+        };
+
+        void release(const std::string& modelId, uint64_t generation)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_queues.find(modelId);
+                if (it != m_queues.end() && it->second.generation == generation && it->second.running > 0)
+                {
+                    --it->second.running;
+                }
+            }
+            m_cv.notify_all();
+        }
+
+        mutable std::mutex              m_mutex;
+        std::condition_variable         m_cv;
+        std::map<std::string, Queue>    m_queues;
+        size_t                          m_maxQueueDepth;
+        std::chrono::milliseconds       m_queueTimeout;
+        uint64_t                        m_generation = 0;
+    };
+
+} // namespace Model
@@ -0,0 +1,443 @@
+#pragma once
+
+#include "segmented_downloader.hpp"
+
+#include <json.hpp>
+
+#include <mutex>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+namespace Model
+{
+    struct QueuedDownload
+    {
+        std::string modelName;
+        std::string variantType;
+        int         priority = 0;
+        bool        paused = false;
+    };
+
+    inline void to_json(nlohmann::json& j, const QueuedDownload& d)
+    {
+        j = nlohmann::json{
+            {"model", d.modelName},
+            {"variant", d.variantType},
+            {"priority", d.priority},
+            {"paused", d.paused} };
+    }
+
+    inline void from_json(const nlohmann::json& j, QueuedDownload& d)
+    {
+        j.at("model").get_to(d.modelName);
+        j.at("variant").get_to(d.variantType);
+        d.priority = j.value("priority", 0);
+        d.paused = j.value("paused", false);
+    }
+
+    struct DownloadQueueState;
+
+    /**
+     * @brief Queue of model downloads, run a few at a time under one bandwidth cap.
+     *
+     * Downloads start in order of priority and then of arrival, so with equal priorities
+     * the queue is FIFO. At most maxConcurrent run at once. A paused download keeps its
+     * place but is skipped; pausing a running one frees its slot once the caller has
+     * stopped its transfer, which leaves the .part file to resume from later. Every
+     * download shares limiter(), capping their combined rate at bandwidthLimit.
+     *
+     * Each change to the queue or the options is passed to `changed`, in order and under
+     * the scheduler's lock, so the owner can persist it; the callback must not call back
+     * into the scheduler.
+     */
+    class DownloadScheduler
+    {
+    public:
+        // The model being switched to goes ahead of everything queued at normal priorities
+        static constexpr int PRIORITY_SELECTED = 1000;
+
+        struct Options
+        {
+            size_t   maxConcurrent = 2;
+            // Bytes per second across all downloads; 0 for no cap
+            uint64_t bandwidthLimit = 0;
+        };
+
+        struct Entry
+        {
+            QueuedDownload download;
+            bool           running = false;
+        };
+
+        // Where a download was before pause() or remove()
+        enum class Status
+        {
+            NOT_QUEUED,
+            QUEUED,
+            RUNNING
+        };
+
+        // Downloads the variant until it is done or interrupted; true if it is now on disk
+        using RunFn = std::function<bool(const QueuedDownload&)>;
+        using ChangedFn = std::function<void(const DownloadQueueState&)>;
+
+        DownloadScheduler(RunFn run, ChangedFn changed)
+            : m_run(std::move(run))
+            , m_changed(std::move(changed))
+            , m_limiter(std::make_shared<BandwidthLimiter>())
+        {
+        }
+
+        ~DownloadScheduler()
+        {
+            stop();
+            wait();
+        }
+
+        DownloadScheduler(const DownloadScheduler&) = delete;
+        DownloadScheduler& operator=(const DownloadScheduler&) = delete;
+
+        std::shared_ptr<BandwidthLimiter> limiter() const
+        {
+            return m_limiter;
+        }
+
+        // Queues a download; one that is already queued is resumed and keeps the higher priority
+        void enqueue(const std::string& modelName, const std::string& variantType, int priority = 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findLocked(modelName, variantType);
+            if (it != m_queue.end())
+            {
+                it->download.paused = false;
+                it->download.priority = std::max(it->download.priority, priority);
+            }
+            else
+            {
+                m_queue.push_back({ { modelName, variantType, priority, false }, ++m_sequence });
+            }
+            changedLocked();
+            dispatchLocked();
+        }
+
+        // A running download must then be stopped by the caller; it stays queued, paused
+        Status pause(const std::string& modelName, const std::string& variantType)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findLocked(modelName, variantType);
+            if (it == m_queue.end())
+            {
+                return Status::NOT_QUEUED;
+            }
+
+            it->download.paused = true;
+            if (it->running)
+            {
+                it->interrupted = true;
+            }
+            changedLocked();
+            return it->running ? Status::RUNNING : Status::QUEUED;
+        }
+
+        bool resume(const std::string& modelName, const std::string& variantType)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findLocked(modelName, variantType);
+            if (it == m_queue.end())
+            {
+                return false;
+            }
+
+            it->download.paused = false;
+            changedLocked();
+            dispatchLocked();
+            return true;
+        }
+
+        // A running download must then be stopped by the caller
+        Status remove(const std::string& modelName, const std::string& variantType)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findLocked(modelName, variantType);
+            if (it == m_queue.end())
+            {
+                return Status::NOT_QUEUED;
+            }
+
+            const Status status = it->running ? Status::RUNNING : Status::QUEUED;
+            m_queue.erase(it);
+            changedLocked();
+            return status;
+        }
+
+        // Takes effect the next time a slot frees up; running downloads are not preempted
+        bool setPriority(const std::string& modelName, const std::string& variantType, int priority)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findLocked(modelName, variantType);
+            if (it == m_queue.end())
+            {
+                return false;
+            }
+
+            it->download.priority = priority;
+            changedLocked();
+            return true;
+        }
+
+        /**
+         * @brief True while the download is queued and not paused. A run checks this before
+         *        it starts transferring, so a pause or remove that came first isn't lost.
+         */
+        bool isWanted(const std::string& modelName, const std::string& variantType)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findLocked(modelName, variantType);
+            return it != m_queue.end() && !it->download.paused;
+        }
+
+        void setOptions(const Options& options)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            applyOptionsLocked(options);
+            changedLocked();
+            dispatchLocked();
+        }
+
+        Options getOptions() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_options;
+        }
+
+        // In the order they will start
+        std::vector<Entry> getEntries() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<Entry> entries;
+            for (const Item* item : orderedLocked())
+            {
+                entries.push_back({ item->download, item->running });
+            }
+            return entries;
+        }
+
+        // Replaces the queue and options with a persisted state and starts what it can
+        void restore(const DownloadQueueState& state);
+
+        /**
+         * @brief Stops starting downloads. Downloads interrupted from now on stay queued,
+         *        so the queue is persisted as it was and resumes on the next start.
+         */
+        void stop()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+
+        // Waits for running downloads; call after stop() and after interrupting them
+        void wait()
+        {
+            std::vector<std::future<void>> transfers;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                transfers.swap(m_transfers);
+            }
+            for (auto& transfer : transfers)
+            {
+                transfer.wait();
+            }
+        }
+
+    private:
+        struct Item
+        {
+            QueuedDownload download;
+            uint64_t       sequence = 0;
+            bool           running = false;
+            // Paused or removed while running; the run that ends next doesn't mean failure
+            bool           interrupted = false;
+        };
+
+        std::vector<Item>::iterator findLocked(const std::string& modelName, const std::string& variantType)
+        {
+            return std::find_if(m_queue.begin(), m_queue.end(), [&](const Item& item) {
+                return item.download.modelName == modelName && item.download.variantType == variantType;
+                });
+        }
+
+        bool activeLocked(const QueuedDownload& download) const
+        {
+            return std::any_of(m_active.begin(), m_active.end(), [&](const QueuedDownload& active) {
+                return active.modelName == download.modelName && active.variantType == download.variantType;
+                });
+        }
+
+        std::vector<const Item*> orderedLocked() const
+        {
+            std::vector<const Item*> ordered;
+            for (const auto& item : m_queue)
+            {
+                ordered.push_back(&item);
+            }
+            std::sort(ordered.begin(), ordered.end(), [](const Item* a, const Item* b) {
+                if (a->download.priority != b->download.priority)
+                {
+                    return a->download.priority > b->download.priority;
+                }
+                return a->sequence < b->sequence;
+                });
+            return ordered;
+        }
+
+        void applyOptionsLocked(const Options& options)
+        {
+            m_options = options;
+            m_options.maxConcurrent = std::max<size_t>(m_options.maxConcurrent, 1);
+            m_limiter->setLimit(m_options.bandwidthLimit);
+        }
+
+        void changedLocked();
+
+        // Starts queued downloads while there are free slots
+        void dispatchLocked()
+        {
+            m_transfers.erase(
+                std::remove_if(m_transfers.begin(), m_transfers.end(), [](auto& transfer) {
+                    return transfer.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                    }),
+                m_transfers.end());
+
+            while (!m_stopped && m_active.size() < m_options.maxConcurrent)
+            {
+                Item* next = nullptr;
+                for (const Item* item : orderedLocked())
+                {
+                    // An earlier run of a removed and re-queued download may still be unwinding
+                    if (!item->running && !item->download.paused && !activeLocked(item->download))
+                    {
+                        next = const_cast<Item*>(item);
+                        break;
+                    }
+                }
+                if (!next)
+                {
+                    return;
+                }
+
+                next->running = true;
+                next->interrupted = false;
+                m_active.push_back(next->download);
+                m_transfers.push_back(std::async(std::launch::async, &DownloadScheduler::runOne, this, next->download));
+            }
+        }
+
+        void runOne(QueuedDownload download)
+        {
+            bool onDisk = false;
+            try
+            {
+                onDisk = m_run(download);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[DownloadScheduler] Download of " << download.modelName << ":"
+                    << download.variantType << " failed: " << e.what() << "\n";
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active.erase(std::find_if(m_active.begin(), m_active.end(), [&](const QueuedDownload& active) {
+                return active.modelName == download.modelName && active.variantType == download.variantType;
+                }));
+
+            auto it = findLocked(download.modelName, download.variantType);
+            if (it != m_queue.end() && (it->running || onDisk))
+            {
+                // Paused, or cut short by stop(): stays queued to resume from its .part file.
+                // Anything else that didn't finish failed and is dropped.
+                if (!onDisk && (it->interrupted || m_stopped))
+                {
+                    it->running = false;
+                    it->interrupted = false;
+                }
+                else
+                {
+                    m_queue.erase(it);
+                    changedLocked();
+                }
+            }
+            dispatchLocked();
+        }
+
+        RunFn                             m_run;
+        ChangedFn                         m_changed;
+        std::shared_ptr<BandwidthLimiter> m_limiter;
+
+        mutable std::mutex                m_mutex;
+        Options                           m_options;
+        std::vector<Item>                 m_queue;
+        uint64_t                          m_sequence = 0;
+        // Downloads whose run hasn't returned yet, even if they were removed from the queue
+        std::vector<QueuedDownload>       m_active;
+        std::vector<std::future<void>>    m_transfers;
+        bool                              m_stopped = false;
+    };
+
+    // What survives a restart: the queue in start order and the scheduler's options
+    struct DownloadQueueState
+    {
+        std::vector<QueuedDownload> downloads;
+        DownloadScheduler::Options  options;
+    };
+
+    inline void to_json(nlohmann::json& j, const DownloadQueueState& s)
+    {
+        j = nlohmann::json{
+            {"version", 1},
+            {"maxConcurrent", s.options.maxConcurrent},
+            {"bandwidthLimit", s.options.bandwidthLimit},
+            {"downloads", s.downloads} };
+    }
+
+    inline void from_json(const nlohmann::json& j, DownloadQueueState& s)
+    {
+        s.options.maxConcurrent = j.value("maxConcurrent", DownloadScheduler::Options().maxConcurrent);
+        s.options.bandwidthLimit = j.value("bandwidthLimit", uint64_t{ 0 });
+        j.at("downloads").get_to(s.downloads);
+    }
+
+    inline void DownloadScheduler::restore(const DownloadQueueState& state)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        applyOptionsLocked(state.options);
+        m_queue.clear();
+        for (const auto& download : state.downloads)
+        {
+            m_queue.push_back({ download, ++m_sequence });
+        }
+        changedLocked();
+        dispatchLocked();
+    }
+
+    inline void DownloadScheduler::changedLocked()
+    {
+        if (!m_changed)
+        {
+            return;
+        }
+
+        DownloadQueueState state;
+        state.options = m_options;
+        for (const Item* item : orderedLocked())
+        {
+            state.downloads.push_back(item->download);
+        }
+        m_changed(state);
+    }
+} // namespace Model
@@ -0,0 +1,350 @@
+#pragma once
+
+#include "gguf_reader.hpp"
+#include "durable_writer.hpp"
+
+#include <json.hpp>
+#include <curl/curl.h>
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+/**
+ * @brief Remembers the model parameters read from GGUF files and URLs, across runs.
+ *
+ * Entries are keyed by the absolute path or the URL and stamped with the source's
+ * identity: size and modification time for files, size and ETag (or Last-Modified)
+ * from a HEAD request for URLs. A lookup whose identity still matches returns the
+ * stored parameters without opening the GGUF; one that doesn't re-reads the source
+ * and replaces the entry. URLs that send neither validator are never cached. When a
+ * URL can't be reached, its last known parameters are returned instead.
+ *
+ * A URL whose identity was checked less than URL_RECHECK_AFTER ago is trusted without
+ * another HEAD request, since lookups run on the UI thread. Recency updates from hits
+ * are saved at most every SAVE_INTERVAL, and on destruction.
+ */
+class GGUFMetadataCache
+{
+public:
+    static constexpr size_t MAX_ENTRIES = 256;
+    static constexpr std::chrono::minutes URL_RECHECK_AFTER{ 10 };
+    static constexpr std::chrono::seconds SAVE_INTERVAL{ 30 };
+
+    static GGUFMetadataCache& instance()
+    {
+        static GGUFMetadataCache cache("models/gguf_metadata.cache");
+        return cache;
+    }
+
+    explicit GGUFMetadataCache(std::filesystem::path cacheFile)
+        : m_cacheFile(std::move(cacheFile))
+    {
+    }
+
+    ~GGUFMetadataCache()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_dirty)
+        {
+            saveLocked();
+        }
+    }
+
+    GGUFMetadataCache(const GGUFMetadataCache&) = delete;
+    GGUFMetadataCache& operator=(const GGUFMetadataCache&) = delete;
+
+    std::optional<GGUFModelParams> readModelParams(const std::string& path, bool verbose = false)
+    {
+        const bool url = m_reader.isUrl(path);
+        const std::string key = url ? path : absoluteKey(path);
+
+        if (url)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            loadLocked();
+
+            auto it = m_entries.find(key);
+            if (it != m_entries.end() && nowSeconds() - it->second.checkedAt < recheckSeconds())
+            {
+                touchLocked(it->second);
+                return it->second.params;
+            }
+        }
+
+        const std::optional<std::string> identity = url ? urlIdentity(path) : fileIdentity(path);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            loadLocked();
+
+            auto it = m_entries.find(key);
+            if (it != m_entries.end())
+            {
+                // Unreachable URL: the last parameters read are better than none
+                if (it->second.identity == identity.value_or(it->second.identity))
+                {
+                    if (identity)
+                    {
+                        it->second.checkedAt = nowSeconds();
+                    }
+                    touchLocked(it->second);
+                    return it->second.params;
+                }
+            }
+        }
+
+        auto params = m_reader.readModelParams(path, verbose);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (params && identity && !identity->empty())
+        {
+            m_entries[key] = { *identity, *params, ++m_clock, nowSeconds() };
+            evictLocked();
+            saveLocked();
+        }
+        else if (m_entries.erase(key) > 0)
+        {
+            saveLocked();
+        }
+        return params;
+    }
+
+    void invalidate(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        loadLocked();
+        if (m_entries.erase(m_reader.isUrl(path) ? path : absoluteKey(path)) > 0)
+        {
+            saveLocked();
+        }
+    }
+
+private:
+    struct Entry
+    {
+        std::string     identity;
+        GGUFModelParams params;
+        uint64_t        lastUsed = 0;
+        // When the identity was last confirmed, in seconds since the epoch
+        int64_t         checkedAt = 0;
+    };
+
+    static int64_t nowSeconds()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static int64_t recheckSeconds()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(URL_RECHECK_AFTER).count();
+    }
+
+    // Marks a hit; the new recency is saved with the next write, or here if that is overdue
+    void touchLocked(Entry& entry)
+    {
+        entry.lastUsed = ++m_clock;
+        m_dirty = true;
+        if (std::chrono::steady_clock::now() - m_lastSave >= SAVE_INTERVAL)
+        {
+            saveLocked();
+        }
+    }
+
+    static std::string absoluteKey(const std::string& path)
+    {
+        std::error_code ec;
+        auto absolute = std::filesystem::absolute(path, ec);
+        return ec ? path : absolute.lexically_normal().string();
+    }
+
+    // Missing files have no identity, so they are read (and fail) every time
+    static std::optional<std::string> fileIdentity(const std::string& path)
+    {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        if (ec)
+        {
+            return std::string();
+        }
+        const auto modified = std::filesystem::last_write_time(path, ec);
+        if (ec)
+        {
+            return std::string();
+        }
+        return std::to_string(size) + ":" + std::to_string(modified.time_since_epoch().count());
+    }
+
+    /**
+     * @brief Size and validator from a HEAD request. Empty if the server sends no
+     *        validator; nullopt if it can't be reached.
+     */
+    static std::optional<std::string> urlIdentity(const std::string& url)
+    {
+        CURL* curl = curl_easy_init();
+        if (!curl)
+        {
+            return std::nullopt;
+        }
+
+        std::string etag;
+        std::string lastModified;
+        auto headers = std::make_pair(&etag, &lastModified);
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 20L);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, onHeader);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headers);
+
+        const CURLcode result = curl_easy_perform(curl);
+        long status = 0;
+        curl_off_t size = -1;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &size);
+        curl_easy_cleanup(curl);
+
+        if (result != CURLE_OK || status >= 500)
+        {
+            return std::nullopt;
+        }
+        if (status >= 400 || (etag.empty() && lastModified.empty()))
+        {
+            return std::string();
+        }
+        return std::to_string(size) + ":" + (etag.empty() ? lastModified : etag);
+    }
+
+    static size_t onHeader(char* buffer, size_t size, size_t count, void* userdata)
+    {
+        auto* headers = static_cast<std::pair<std::string*, std::string*>*>(userdata);
+        const std::string line(buffer, size * count);
+        const auto colon = line.find(':');
+        if (colon != std::string::npos)
+        {
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t\r\n") + 1);
+
+            // Redirects each send their own headers; the last response's win
+            if (name == "etag")
+            {
+                *headers->first = value;
+            }
+            else if (name == "last-modified")
+            {
+                *headers->second = value;
+            }
+        }
+        else if (line.rfind("HTTP/", 0) == 0)
+        {
+            headers->first->clear();
+            headers->second->clear();
+        }
+        return size * count;
+    }
+
+    void loadLocked()
+    {
+        if (m_loaded)
+        {
+            return;
+        }
+        m_loaded = true;
+        // What was just read is what is on disk
+        m_lastSave = std::chrono::steady_clock::now();
+
+        const auto directory = m_cacheFile.has_parent_path() ? m_cacheFile.parent_path() : std::filesystem::path(".");
+        DurableWriter::instance().removeStaleTemps(directory, m_cacheFile.filename().string());
+
+        std::ifstream file(m_cacheFile);
+        if (!file.is_open())
+        {
+            return;
+        }
+
+        try
+        {
+            nlohmann::json j;
+            file >> j;
+            for (const auto& entry : j.at("entries"))
+            {
+                GGUFModelParams params;
+                params.hidden_size = entry.at("hidden_size").get<uint64_t>();
+                params.attention_heads = entry.at("attention_heads").get<uint32_t>();
+                params.hidden_layers = entry.at("hidden_layers").get<uint32_t>();
+                params.kv_heads = entry.at("kv_heads").get<uint32_t>();
+
+                const uint64_t lastUsed = entry.value("last_used", uint64_t{ 0 });
+                if (lastUsed > m_clock)
+                {
+                    m_clock = lastUsed;
+                }
+                m_entries[entry.at("source").get<std::string>()] = { entry.at("identity").get<std::string>(), params, lastUsed,
+                    entry.value("checked_at", int64_t{ 0 }) };
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[GGUFMetadataCache] Ignoring unreadable cache " << m_cacheFile << ": " << e.what() << "\n";
+            m_entries.clear();
+        }
+    }
+
+    void saveLocked()
+    {
+        nlohmann::json entries = nlohmann::json::array();
+        for (const auto& [source, entry] : m_entries)
+        {
+            entries.push_back({
+                {"source", source},
+                {"identity", entry.identity},
+                {"hidden_size", entry.params.hidden_size},
+                {"attention_heads", entry.params.attention_heads},
+                {"hidden_layers", entry.params.hidden_layers},
+                {"kv_heads", entry.params.kv_heads},
+                {"last_used", entry.lastUsed},
+                {"checked_at", entry.checkedAt} });
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_cacheFile.parent_path(), ec);
+        DurableWriter::instance().write(m_cacheFile, nlohmann::json{ {"version", 1}, {"entries", entries} }.dump(4));
+        m_dirty = false;
+        m_lastSave = std::chrono::steady_clock::now();
+    }
+
+    void evictLocked()
+    {
+        while (m_entries.size() > MAX_ENTRIES)
+        {
+            auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const auto& a, const auto& b) {
+                return a.second.lastUsed < b.second.lastUsed;
+                });
+            m_entries.erase(oldest);
+        }
+    }
+
+    std::filesystem::path                  m_cacheFile;
+    GGUFMetadataReader                     m_reader;
+
+    std::mutex                             m_mutex;
+    bool                                   m_loaded = false;
+    uint64_t                               m_clock = 0;
+    // Hits since the last save changed recency that isn't on disk yet
+    bool                                   m_dirty = false;
+    std::chrono::steady_clock::time_point  m_lastSave;
+    std::unordered_map<std::string, Entry> m_entries;
+};
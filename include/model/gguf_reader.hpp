@@ -1,6 +1,16 @@
 #ifndef GGUF_READER_H
 #define GGUF_READER_H
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <array>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -14,6 +24,8 @@
 #include <sstream>
 #include <cstring>
 #include <algorithm>
+#include <filesystem>
+#include <string_view>
 
 // Structure to hold the extracted model parameters
 struct GGUFModelParams {
@@ -23,6 +35,24 @@ struct GGUFModelParams {
     uint32_t kv_heads = 0;          // Mapped from attention.head_count_kv or head_count
 };
 
+// GGUF metadata value types
+enum class GGUFType : uint32_t {
+    UINT8 = 0,
+    INT8 = 1,
+    UINT16 = 2,
+    INT16 = 3,
+    UINT32 = 4,
+    INT32 = 5,
+    FLOAT32 = 6,
+    BOOL = 7,
+    STRING = 8,
+    ARRAY = 9,
+    UINT64 = 10,
+    INT64 = 11,
+    FLOAT64 = 12,
+    MAX_TYPE = 13
+};
+
 // Abstract base class for data sources
 class DataSource {
 public:
@@ -205,26 +235,452 @@ private:
     static constexpr size_t CHUNK_SIZE = 256 * 1024;      // 256KB chunk size
 };
 
-class GGUFMetadataReader {
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile(const std::string& filename) {
+#ifdef _WIN32
+        file = CreateFileW(std::filesystem::path(filename).wstring().c_str(), GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Failed to open file: " + filename);
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to get size of file: " + filename);
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+
+        if (length > 0) {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+                view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!view) {
+                if (mapping)
+                    CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::runtime_error("Failed to map file: " + filename);
+            }
+        }
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open file: " + filename);
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to get size of file: " + filename);
+        }
+        length = static_cast<size_t>(st.st_size);
+
+        if (length > 0) {
+            void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map file: " + filename);
+            }
+            view = mapped;
+        }
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (view)
+            UnmapViewOfFile(view);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (view)
+            ::munmap(view, length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return static_cast<const char*>(view);
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    void* view = nullptr;
+    size_t length = 0;
+};
+
+// One metadata value. Strings and arrays point into the mapping of the GGUFFile they came from.
+struct GGUFValue {
+    GGUFType type = GGUFType::UINT8;
+    const char* data = nullptr;             // The scalar, the string's bytes or the first array element
+    uint64_t size = 0;                      // Bytes at data
+    GGUFType elementType = GGUFType::UINT8; // Arrays only
+    uint64_t count = 0;                     // Arrays only: number of elements
+
+    // Any integer type, as long as the value is not negative
+    std::optional<uint64_t> asUInt() const {
+        switch (type) {
+        case GGUFType::UINT8:  return load<uint8_t>(data);
+        case GGUFType::UINT16: return load<uint16_t>(data);
+        case GGUFType::UINT32: return load<uint32_t>(data);
+        case GGUFType::UINT64: return load<uint64_t>(data);
+        case GGUFType::INT8:
+        case GGUFType::INT16:
+        case GGUFType::INT32:
+        case GGUFType::INT64: {
+            auto value = asInt();
+            if (value && *value >= 0)
+                return static_cast<uint64_t>(*value);
+            return std::nullopt;
+        }
+        default:
+            return std::nullopt;
+        }
+    }
+
+    std::optional<int64_t> asInt() const {
+        switch (type) {
+        case GGUFType::INT8:   return load<int8_t>(data);
+        case GGUFType::INT16:  return load<int16_t>(data);
+        case GGUFType::INT32:  return load<int32_t>(data);
+        case GGUFType::INT64:  return load<int64_t>(data);
+        case GGUFType::UINT8:  return load<uint8_t>(data);
+        case GGUFType::UINT16: return load<uint16_t>(data);
+        case GGUFType::UINT32: return load<uint32_t>(data);
+        case GGUFType::UINT64: {
+            uint64_t value = load<uint64_t>(data);
+            if (value <= static_cast<uint64_t>(INT64_MAX))
+                return static_cast<int64_t>(value);
+            return std::nullopt;
+        }
+        default:
+            return std::nullopt;
+        }
+    }
+
+    std::optional<double> asFloat() const {
+        if (type == GGUFType::FLOAT32)
+            return load<float>(data);
+        if (type == GGUFType::FLOAT64)
+            return load<double>(data);
+        return std::nullopt;
+    }
+
+    std::optional<bool> asBool() const {
+        if (type == GGUFType::BOOL)
+            return load<uint8_t>(data) != 0;
+        return std::nullopt;
+    }
+
+    std::optional<std::string_view> asString() const {
+        if (type == GGUFType::STRING)
+            return std::string_view(data, static_cast<size_t>(size));
+        return std::nullopt;
+    }
+
+    // Copies out an array of fixed-size elements; T must have the element's size
+    template <typename T>
+    std::vector<T> asArray() const {
+        if (type != GGUFType::ARRAY || typeSize(elementType) != sizeof(T))
+            throw std::runtime_error("Not an array of " + std::to_string(sizeof(T)) + "-byte elements");
+        std::vector<T> values(static_cast<size_t>(count));
+        if (count > 0)
+            memcpy(values.data(), data, static_cast<size_t>(size));
+        return values;
+    }
+
+    std::vector<std::string_view> asStringArray() const {
+        if (type != GGUFType::ARRAY || elementType != GGUFType::STRING)
+            throw std::runtime_error("Not an array of strings");
+        std::vector<std::string_view> values;
+        values.reserve(static_cast<size_t>(count));
+        const char* pos = data;
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t length = load<uint64_t>(pos);
+            values.emplace_back(pos + sizeof(uint64_t), static_cast<size_t>(length));
+            pos += sizeof(uint64_t) + length;
+        }
+        return values;
+    }
+
+    // Size of one value of a fixed-size type; 0 for strings and arrays
+    static size_t typeSize(GGUFType type) {
+        switch (type) {
+        case GGUFType::UINT8:
+        case GGUFType::INT8:
+        case GGUFType::BOOL:
+            return 1;
+        case GGUFType::UINT16:
+        case GGUFType::INT16:
+            return 2;
+        case GGUFType::UINT32:
+        case GGUFType::INT32:
+        case GGUFType::FLOAT32:
+            return 4;
+        case GGUFType::UINT64:
+        case GGUFType::INT64:
+        case GGUFType::FLOAT64:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    // Values are not aligned in the file
+    template <typename T>
+    static T load(const char* p) {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+};
+
+// One entry of the tensor info table
+struct GGUFTensorInfo {
+    std::string_view name;
+    uint32_t dimensions = 0;
+    std::array<uint64_t, 4> shape{};  // Innermost dimension first, as in ggml
+    uint32_t type = 0;                // ggml_type
+    uint64_t offset = 0;              // From the start of the file
+
+    uint64_t elements() const {
+        uint64_t n = 1;
+        for (uint32_t i = 0; i < dimensions; ++i)
+            n *= shape[i];
+        return n;
+    }
+};
+
+// A GGUF file mapped into memory, with its header, metadata and tensor info table
+// parsed in one pass. Keys, strings and arrays are views into the mapping, so they
+// stay valid as long as the GGUFFile does. Arrays of fixed-size elements are skipped
+// without reading them; string arrays like the tokenizer vocab are walked once.
+// Throws std::runtime_error if the file is missing, truncated or not GGUF.
+class GGUFFile {
 public:
-    // GGUF metadata types
-    enum class GGUFType : uint32_t {
-        UINT8 = 0,
-        INT8 = 1,
-        UINT16 = 2,
-        INT16 = 3,
-        UINT32 = 4,
-        INT32 = 5,
-        FLOAT32 = 6,
-        BOOL = 7,
-        STRING = 8,
-        ARRAY = 9,
-        UINT64 = 10,
-        INT64 = 11,
-        FLOAT64 = 12,
-        MAX_TYPE = 13
+    static constexpr uint32_t MAGIC = 0x46554747; // "GGUF"
+    static constexpr uint64_t DEFAULT_ALIGNMENT = 32;
+    static constexpr uint32_t MAX_DIMENSIONS = 4;
+    // Arrays of arrays are legal but unused in practice; the cap keeps a crafted file
+    // from recursing until the stack runs out
+    static constexpr int MAX_ARRAY_DEPTH = 8;
+
+    GGUFFile(const std::string& filename) : file(filename) {
+        parse();
+    }
+
+    GGUFFile(const GGUFFile&) = delete;
+    GGUFFile& operator=(const GGUFFile&) = delete;
+
+    uint32_t version() const {
+        return fileVersion;
+    }
+
+    uint64_t fileSize() const {
+        return file.size();
+    }
+
+    // Where tensor data starts; tensor offsets already include it
+    uint64_t dataOffset() const {
+        return tensorDataOffset;
+    }
+
+    uint64_t alignment() const {
+        return dataAlignment;
+    }
+
+    // In file order
+    const std::vector<std::pair<std::string_view, GGUFValue>>& metadata() const {
+        return entries;
+    }
+
+    const std::vector<GGUFTensorInfo>& tensors() const {
+        return tensorInfos;
+    }
+
+    const GGUFValue* find(std::string_view key) const {
+        auto it = index.find(key);
+        return it != index.end() ? &entries[it->second].second : nullptr;
+    }
+
+    // "<general.architecture><suffix>", or else the first key ending in the suffix
+    const GGUFValue* findArchitectureKey(std::string_view suffix) const {
+        if (const GGUFValue* arch = find("general.architecture")) {
+            if (auto name = arch->asString()) {
+                std::string key(*name);
+                key.append(suffix.data(), suffix.size());
+                if (const GGUFValue* value = find(key))
+                    return value;
+            }
+        }
+        for (const auto& [key, value] : entries) {
+            if (key.size() >= suffix.size() && key.substr(key.size() - suffix.size()) == suffix)
+                return &value;
+        }
+        return nullptr;
+    }
+
+private:
+    // Bounds-checked reads from the mapping
+    class Cursor {
+    public:
+        Cursor(const char* begin, const char* end) : pos(begin), end(end) {}
+
+        const char* take(uint64_t size) {
+            if (size > static_cast<uint64_t>(end - pos))
+                throw std::runtime_error("Unexpected end of GGUF data");
+            const char* start = pos;
+            pos += size;
+            return start;
+        }
+
+        template <typename T>
+        T read() {
+            return GGUFValue::load<T>(take(sizeof(T)));
+        }
+
+        std::string_view readString() {
+            uint64_t length = read<uint64_t>();
+            return std::string_view(take(length), static_cast<size_t>(length));
+        }
+
+        GGUFType readType() {
+            uint32_t type = read<uint32_t>();
+            if (type >= static_cast<uint32_t>(GGUFType::MAX_TYPE))
+                throw std::runtime_error("Invalid metadata type: " + std::to_string(type));
+            return static_cast<GGUFType>(type);
+        }
+
+        const char* position() const {
+            return pos;
+        }
+
+        uint64_t remaining() const {
+            return static_cast<uint64_t>(end - pos);
+        }
+
+    private:
+        const char* pos;
+        const char* end;
     };
 
+    void parse() {
+        Cursor cursor(file.data(), file.data() + file.size());
+
+        if (cursor.read<uint32_t>() != MAGIC)
+            throw std::runtime_error("Invalid GGUF file format");
+        fileVersion = cursor.read<uint32_t>();
+        // Version 1 used 32-bit counts and lengths and is no longer produced
+        if (fileVersion < 2 || fileVersion > 3)
+            throw std::runtime_error("Unsupported GGUF version: " + std::to_string(fileVersion));
+
+        uint64_t tensorCount = cursor.read<uint64_t>();
+        uint64_t metadataCount = cursor.read<uint64_t>();
+
+        // Every entry takes at least a length, so counts beyond the file size are corrupt
+        if (metadataCount > cursor.remaining() / sizeof(uint64_t))
+            throw std::runtime_error("Metadata count too large: " + std::to_string(metadataCount));
+        entries.reserve(static_cast<size_t>(metadataCount));
+        index.reserve(static_cast<size_t>(metadataCount));
+        for (uint64_t i = 0; i < metadataCount; ++i) {
+            std::string_view key = cursor.readString();
+            GGUFValue value = readValue(cursor, cursor.readType());
+            index.emplace(key, entries.size());
+            entries.emplace_back(key, value);
+        }
+
+        if (const GGUFValue* value = find("general.alignment")) {
+            auto alignment = value->asUInt();
+            if (!alignment || *alignment == 0 || (*alignment & (*alignment - 1)) != 0)
+                throw std::runtime_error("Invalid general.alignment");
+            dataAlignment = *alignment;
+        }
+
+        if (tensorCount > cursor.remaining() / sizeof(uint64_t))
+            throw std::runtime_error("Tensor count too large: " + std::to_string(tensorCount));
+        tensorInfos.reserve(static_cast<size_t>(tensorCount));
+        for (uint64_t i = 0; i < tensorCount; ++i) {
+            GGUFTensorInfo info;
+            info.name = cursor.readString();
+            info.dimensions = cursor.read<uint32_t>();
+            if (info.dimensions > MAX_DIMENSIONS)
+                throw std::runtime_error("Too many dimensions for tensor: " + std::string(info.name));
+            for (uint32_t d = 0; d < info.dimensions; ++d)
+                info.shape[d] = cursor.read<uint64_t>();
+            info.type = cursor.read<uint32_t>();
+            info.offset = cursor.read<uint64_t>();
+            tensorInfos.push_back(info);
+        }
+
+        uint64_t headerEnd = static_cast<uint64_t>(cursor.position() - file.data());
+        tensorDataOffset = (headerEnd + dataAlignment - 1) / dataAlignment * dataAlignment;
+        for (auto& info : tensorInfos)
+            info.offset += tensorDataOffset;
+    }
+
+    GGUFValue readValue(Cursor& cursor, GGUFType type, int depth = 0) {
+        GGUFValue value;
+        value.type = type;
+
+        if (type == GGUFType::STRING) {
+            std::string_view str = cursor.readString();
+            value.data = str.data();
+            value.size = str.size();
+        }
+        else if (type == GGUFType::ARRAY) {
+            if (depth >= MAX_ARRAY_DEPTH)
+                throw std::runtime_error("Arrays nested too deeply");
+            value.elementType = cursor.readType();
+            value.count = cursor.read<uint64_t>();
+            value.data = cursor.position();
+
+            size_t elementSize = GGUFValue::typeSize(value.elementType);
+            if (elementSize > 0) {
+                // Fixed-size elements: skip the whole array at once
+                if (value.count > cursor.remaining() / elementSize)
+                    throw std::runtime_error("Array count too large: " + std::to_string(value.count));
+                cursor.take(value.count * elementSize);
+            }
+            else {
+                for (uint64_t i = 0; i < value.count; ++i)
+                    readValue(cursor, value.elementType, depth + 1);
+            }
+            value.size = static_cast<uint64_t>(cursor.position() - value.data);
+        }
+        else {
+            value.size = GGUFValue::typeSize(type);
+            value.data = cursor.take(value.size);
+        }
+        return value;
+    }
+
+    MappedFile file;
+    uint32_t fileVersion = 0;
+    uint64_t dataAlignment = DEFAULT_ALIGNMENT;
+    uint64_t tensorDataOffset = 0;
+    std::vector<std::pair<std::string_view, GGUFValue>> entries;
+    std::unordered_map<std::string_view, size_t> index;
+    std::vector<GGUFTensorInfo> tensorInfos;
+};
+
+class GGUFMetadataReader {
+public:
+    using GGUFType = ::GGUFType;
+
     GGUFMetadataReader() {
         curl_global_init(CURL_GLOBAL_ALL);
     }
@@ -238,21 +694,31 @@ public:
     }
 
     std::optional<GGUFModelParams> readModelParams(const std::string& path, bool verbose = false) {
-        std::unique_ptr<DataSource> source;
         try {
-            if (isUrl(path)) {
-                if (verbose)
-                    std::cout << "Reading from URL: " << path << std::endl;
-                source = std::make_unique<UrlDataSource>(path);
-            }
-            else {
+            if (!isUrl(path)) {
                 if (verbose)
                     std::cout << "Reading from file: " << path << std::endl;
-                source = std::make_unique<FileDataSource>(path);
+                GGUFFile file(path);
+                return readModelParams(file, verbose);
             }
 
+            if (verbose)
+                std::cout << "Reading from URL: " << path << std::endl;
+            UrlDataSource source(path);
+            return readModelParams(source, verbose);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error reading GGUF file/URL: " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    // Reads field by field and stops once the parameters are known, so a URL source only
+    // downloads the start of the file
+    std::optional<GGUFModelParams> readModelParams(DataSource& source, bool verbose = false) {
+        try {
             uint32_t magic;
-            if (!source->read(reinterpret_cast<char*>(&magic), sizeof(magic)))
+            if (!source.read(reinterpret_cast<char*>(&magic), sizeof(magic)))
                 throw std::runtime_error("Failed to read magic number");
             if (magic != 0x46554747) {
                 std::cerr << "Invalid GGUF file format. Magic number: "
@@ -261,7 +727,7 @@ public:
             }
 
             uint32_t version;
-            if (!source->read(reinterpret_cast<char*>(&version), sizeof(version)))
+            if (!source.read(reinterpret_cast<char*>(&version), sizeof(version)))
                 throw std::runtime_error("Failed to read version");
             if (version > 3) {
                 std::cerr << "Unsupported GGUF version: " << version << std::endl;
@@ -272,14 +738,14 @@ public:
 
             uint64_t tensorCount = 0;
             if (version >= 1) {
-                if (!source->read(reinterpret_cast<char*>(&tensorCount), sizeof(tensorCount)))
+                if (!source.read(reinterpret_cast<char*>(&tensorCount), sizeof(tensorCount)))
                     throw std::runtime_error("Failed to read tensor count");
                 if (verbose)
                     std::cout << "Tensor count: " << tensorCount << std::endl;
             }
 
             uint64_t metadataCount;
-            if (!source->read(reinterpret_cast<char*>(&metadataCount), sizeof(metadataCount)))
+            if (!source.read(reinterpret_cast<char*>(&metadataCount), sizeof(metadataCount)))
                 throw std::runtime_error("Failed to read metadata count");
             if (verbose)
                 std::cout << "Metadata count: " << metadataCount << std::endl;
@@ -295,10 +761,10 @@ public:
             std::unordered_map<std::string, bool> foundParams;
             std::vector<std::string> allKeys;
 
-            for (uint64_t i = 0; i < metadataCount && !source->eof(); ++i) {
+            for (uint64_t i = 0; i < metadataCount && !source.eof(); ++i) {
                 std::string key;
                 try {
-                    key = readString(source.get());
+                    key = readString(&source);
                     allKeys.push_back(key);
                 }
                 catch (const std::exception& e) {
@@ -306,7 +772,7 @@ public:
                 }
 
                 uint32_t typeVal;
-                if (!source->read(reinterpret_cast<char*>(&typeVal), sizeof(typeVal)))
+                if (!source.read(reinterpret_cast<char*>(&typeVal), sizeof(typeVal)))
                     throw std::runtime_error("Failed to read metadata type for key: " + key);
                 if (typeVal >= static_cast<uint32_t>(GGUFType::MAX_TYPE))
                     throw std::runtime_error("Invalid metadata type: " + std::to_string(typeVal) + " for key: " + key);
@@ -328,7 +794,7 @@ public:
                 if (keyMatched) {
                     if (matchedSuffix == ".attention.head_count" && (type == GGUFType::UINT32 || type == GGUFType::INT32)) {
                         uint32_t value;
-                        if (!source->read(reinterpret_cast<char*>(&value), sizeof(value)))
+                        if (!source.read(reinterpret_cast<char*>(&value), sizeof(value)))
                             throw std::runtime_error("Failed to read attention_heads value");
                         params.attention_heads = value;
                         foundParams["attention_heads"] = true;
@@ -337,7 +803,7 @@ public:
                     }
                     else if (matchedSuffix == ".attention.head_count_kv" && (type == GGUFType::UINT32 || type == GGUFType::INT32)) {
                         uint32_t value;
-                        if (!source->read(reinterpret_cast<char*>(&value), sizeof(value)))
+                        if (!source.read(reinterpret_cast<char*>(&value), sizeof(value)))
                             throw std::runtime_error("Failed to read kv_heads value");
                         params.kv_heads = value;
                         foundParams["kv_heads"] = true;
@@ -346,7 +812,7 @@ public:
                     }
                     else if (matchedSuffix == ".block_count" && (type == GGUFType::UINT32 || type == GGUFType::INT32)) {
                         uint32_t value;
-                        if (!source->read(reinterpret_cast<char*>(&value), sizeof(value)))
+                        if (!source.read(reinterpret_cast<char*>(&value), sizeof(value)))
                             throw std::runtime_error("Failed to read hidden_layers value");
                         params.hidden_layers = value;
                         foundParams["hidden_layers"] = true;
@@ -356,7 +822,7 @@ public:
                     else if (matchedSuffix == ".embedding_length") {
                         if (type == GGUFType::UINT64 || type == GGUFType::INT64) {
                             uint64_t value;
-                            if (!source->read(reinterpret_cast<char*>(&value), sizeof(value)))
+                            if (!source.read(reinterpret_cast<char*>(&value), sizeof(value)))
                                 throw std::runtime_error("Failed to read hidden_size value (64-bit)");
                             params.hidden_size = value;
                             foundParams["hidden_size"] = true;
@@ -365,7 +831,7 @@ public:
                         }
                         else if (type == GGUFType::UINT32 || type == GGUFType::INT32) {
                             uint32_t value;
-                            if (!source->read(reinterpret_cast<char*>(&value), sizeof(value)))
+                            if (!source.read(reinterpret_cast<char*>(&value), sizeof(value)))
                                 throw std::runtime_error("Failed to read hidden_size value (32-bit)");
                             params.hidden_size = value;
                             foundParams["hidden_size"] = true;
@@ -373,28 +839,27 @@ public:
                                 std::cout << "  Found hidden_size: " << value << " (from key: " << key << ")" << std::endl;
                         }
                         else {
-                            skipValue(source.get(), type);
+                            skipValue(&source, type);
                         }
                     }
                     else {
-                        skipValue(source.get(), type);
+                        skipValue(&source, type);
                     }
                 }
                 else {
-                    skipValue(source.get(), type);
+                    skipValue(&source, type);
                 }
 
+                // head_count_kv can come after the others. Models without it read on only
+                // until the tokenizer keys, which follow the architecture's own.
                 if (foundParams["attention_heads"] &&
                     foundParams["hidden_layers"] &&
                     foundParams["hidden_size"] &&
-                    (foundParams["kv_heads"] || foundParams["attention_heads"])) {
-                    if (isUrl(path)) {
-                        auto urlSource = dynamic_cast<UrlDataSource*>(source.get());
-                        if (urlSource) {
-                            urlSource->setAbortFlag();
-                            if (verbose)
-                                std::cout << "All required metadata found, aborting download" << std::endl;
-                        }
+                    (foundParams["kv_heads"] || key.rfind("tokenizer.", 0) == 0)) {
+                    if (auto urlSource = dynamic_cast<UrlDataSource*>(&source)) {
+                        urlSource->setAbortFlag();
+                        if (verbose)
+                            std::cout << "All required metadata found, aborting download" << std::endl;
                     }
                     break;
                 }
@@ -432,6 +897,45 @@ public:
         }
     }
 
+    std::optional<GGUFModelParams> readModelParams(const GGUFFile& file, bool verbose = false) {
+        if (verbose)
+            std::cout << "GGUF version: " << file.version() << ", tensor count: " << file.tensors().size()
+                << ", metadata count: " << file.metadata().size() << std::endl;
+
+        auto readCount = [&file](const char* suffix) -> std::optional<uint64_t> {
+            const GGUFValue* value = file.findArchitectureKey(suffix);
+            return value ? value->asUInt() : std::nullopt;
+        };
+
+        auto attentionHeads = readCount(".attention.head_count");
+        auto kvHeads = readCount(".attention.head_count_kv");
+        auto hiddenLayers = readCount(".block_count");
+        auto hiddenSize = readCount(".embedding_length");
+
+        if (!attentionHeads || !hiddenLayers || !hiddenSize) {
+            std::cerr << "Failed to find all required model parameters:" << std::endl;
+            if (!attentionHeads) std::cerr << "  Missing: attention_heads (suffix: .attention.head_count)" << std::endl;
+            if (!hiddenLayers) std::cerr << "  Missing: hidden_layers (suffix: .block_count)" << std::endl;
+            if (!hiddenSize) std::cerr << "  Missing: hidden_size (suffix: .embedding_length)" << std::endl;
+            if (verbose) {
+                std::cerr << "All keys found:" << std::endl;
+                for (const auto& [key, value] : file.metadata())
+                    std::cerr << "  " << key << std::endl;
+            }
+            return std::nullopt;
+        }
+
+        GGUFModelParams params;
+        params.attention_heads = static_cast<uint32_t>(*attentionHeads);
+        params.kv_heads = static_cast<uint32_t>(kvHeads.value_or(*attentionHeads));
+        params.hidden_layers = static_cast<uint32_t>(*hiddenLayers);
+        params.hidden_size = *hiddenSize;
+        if (verbose)
+            std::cout << "  hidden_size: " << params.hidden_size << ", attention_heads: " << params.attention_heads
+                << ", kv_heads: " << params.kv_heads << ", hidden_layers: " << params.hidden_layers << std::endl;
+        return params;
+    }
+
 private:
     bool endsWith(const std::string& str, const std::string& suffix) {
         return str.size() >= suffix.size() &&
@@ -451,17 +955,17 @@ private:
         return str;
     }
 
-    void skipArray(DataSource* source, GGUFType elemType) {
+    void skipArray(DataSource* source, GGUFType elemType, int depth) {
         uint64_t count;
         if (!source->read(reinterpret_cast<char*>(&count), sizeof(count)))
             throw std::runtime_error("Failed to read array count");
         if (count > 1000000)
             throw std::runtime_error("Array count too large: " + std::to_string(count));
         for (uint64_t i = 0; i < count; ++i)
-            skipValue(source, elemType);
+            skipValue(source, elemType, depth);
     }
 
-    void skipValue(DataSource* source, GGUFType type) {
+    void skipValue(DataSource* source, GGUFType type, int depth = 0) {
         switch (type) {
         case GGUFType::UINT8:
             source->seek(source->tell() + sizeof(uint8_t));
@@ -497,13 +1001,15 @@ private:
             break;
         }
         case GGUFType::ARRAY: {
+            if (depth >= GGUFFile::MAX_ARRAY_DEPTH)
+                throw std::runtime_error("Arrays nested too deeply");
             uint32_t elemTypeVal;
             if (!source->read(reinterpret_cast<char*>(&elemTypeVal), sizeof(elemTypeVal)))
                 throw std::runtime_error("Failed to read array element type");
             if (elemTypeVal >= static_cast<uint32_t>(GGUFType::MAX_TYPE))
                 throw std::runtime_error("Invalid array element type: " + std::to_string(elemTypeVal));
             GGUFType elemType = static_cast<GGUFType>(elemTypeVal);
-            skipArray(source, elemType);
+            skipArray(source, elemType, depth + 1);
             break;
         }
         case GGUFType::UINT64:
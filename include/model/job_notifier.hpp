@@ -0,0 +1,236 @@
+#pragma once
+
+#include <inference_interface.h>
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+
+namespace Model
+{
+    /**
+     * @brief Callback signature used by the streaming extension. It is a plain function
+     *        pointer so it can safely cross the inference engine DLL boundary.
+     */
+    typedef void (*JobUpdateCallback)(int jobId, void* userData);
+
+    /**
+     * @brief Optional push-notification extension for an inference engine.
+     *
+     * Newer engine DLLs export `getInferenceEngineStreamingExt`, which returns this
+     * interface for a given engine instance. Older DLLs don't, in which case the
+     * JobNotifier falls back to polling the engine on a short interval.
+     */
+    class IInferenceEngineStreamingExt
+    {
+    public:
+        virtual ~IInferenceEngineStreamingExt() = default;
+
+        /**
+         * @brief Registers a callback fired whenever new tokens are appended to a job, or
+         *        when the job finishes, fails or is stopped.
+         * @note  The callback is invoked without any engine lock held and must be cheap.
+         *        Passing nullptr unregisters; once that call returns no further callbacks
+         *        are delivered for the job.
+         */
+        virtual bool setJobUpdateCallback(int jobId, JobUpdateCallback callback, void* userData) = 0;
+
+        /**
+         * @brief Copies only the tokens and text produced after the given offsets into `delta`,
+         *        so streaming consumers don't re-copy the whole result on every update.
+         * @return False if the job is unknown.
+         */
+        virtual bool getJobResultSince(int jobId, size_t tokenOffset, size_t textOffset, CompletionResult& delta) = 0;
+    };
+
+    typedef IInferenceEngineStreamingExt* (GetInferenceEngineStreamingExtFunc)(IInferenceEngine*);
+
+    /**
+     * @brief Wakes job consumers as soon as an engine produces new output.
+     *
+     * Uses the engine's streaming extension when available; otherwise a single shared
+     * thread ticks every subscribed job at a short interval, so old DLLs still get a
+     * bounded wake-up latency without a sleeping thread per job. The InferenceEngineLib
+     * that ships today has no extension, so it always takes the polling path.
+     *
+     * Listeners may call subscribe() and unsubscribe(), including for their own job.
+     */
+    class JobNotifier
+    {
+    public:
+        using Listener = std::function<void()>;
+
+        explicit JobNotifier(std::chrono::milliseconds pollInterval = std::chrono::milliseconds(20))
+            : m_pollInterval(pollInterval)
+        {
+        }
+
+        ~JobNotifier()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            if (m_pollThread.joinable())
+            {
+                m_pollThread.join();
+            }
+        }
+
+        JobNotifier(const JobNotifier&) = delete;
+        JobNotifier& operator=(const JobNotifier&) = delete;
+
+        void setExtensionResolver(GetInferenceEngineStreamingExtFunc* resolver)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resolver = resolver;
+        }
+
+        IInferenceEngineStreamingExt* extensionFor(IInferenceEngine* engine)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_resolver ? m_resolver(engine) : nullptr;
+        }
+
+        // Subscribers should pull the job state once after subscribing, since output
+        // produced before the subscription took effect is not re-announced.
+        void subscribe(IInferenceEngine* engine, int jobId, Listener listener)
+        {
+            auto subscription = std::make_shared<Subscription>();
+            subscription->listener = std::move(listener);
+
+            IInferenceEngineStreamingExt* ext = extensionFor(engine);
+            Subscription* raw = subscription.get();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                subscription->ext = ext;
+                auto& slot = m_subscriptions[{ engine, jobId }];
+                if (slot)
+                {
+                    slot->active = false;
+                }
+                slot = subscription;
+            }
+
+            if (ext && ext->setJobUpdateCallback(jobId, &JobNotifier::dispatch, raw))
+            {
+                return;
+            }
+
+            // Fall back to polling for engines without the extension
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                raw->ext = nullptr;
+                raw->polled = true;
+                if (!m_pollThread.joinable())
+                {
+                    m_pollThread = std::thread(&JobNotifier::pollLoop, this);
+                }
+            }
+            m_cv.notify_all();
+        }
+
+        // Once this returns the listener is not called again, unless it is running
+        // right now on the calling thread
+        void unsubscribe(IInferenceEngine* engine, int jobId)
+        {
+            std::shared_ptr<Subscription> subscription;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                auto it = m_subscriptions.find({ engine, jobId });
+                if (it == m_subscriptions.end())
+                {
+                    return;
+                }
+                subscription = std::move(it->second);
+                m_subscriptions.erase(it);
+                subscription->active = false;
+
+                // A polled listener may still be running; the poll thread itself
+                // skips inactive subscriptions, so it never has to wait for itself.
+                if (subscription->polled && std::this_thread::get_id() != m_pollThread.get_id())
+                {
+                    m_dispatchDone.wait(lock, [this]() { return !m_dispatching; });
+                }
+            }
+
+            if (subscription->ext)
+            {
+                subscription->ext->setJobUpdateCallback(jobId, nullptr, nullptr);
+            }
+        }
+
+    private:
+        struct Subscription
+        {
+            Listener listener;
+            IInferenceEngineStreamingExt* ext = nullptr;
+            bool polled = false;
+            // Cleared under m_mutex by unsubscribe()
+            bool active = true;
+        };
+
+        static void dispatch(int /*jobId*/, void* userData)
+        {
+            auto* subscription = static_cast<Subscription*>(userData);
+            if (subscription && subscription->listener)
+            {
+                subscription->listener();
+            }
+        }
+
+        void pollLoop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop)
+            {
+                m_cv.wait_for(lock, m_pollInterval);
+                if (m_stop) break;
+
+                std::vector<std::shared_ptr<Subscription>> polled;
+                for (const auto& [key, subscription] : m_subscriptions)
+                {
+                    if (subscription->polled)
+                    {
+                        polled.push_back(subscription);
+                    }
+                }
+
+                // Listeners run without any lock held, so they can (un)subscribe freely
+                m_dispatching = true;
+                for (const auto& subscription : polled)
+                {
+                    if (!subscription->active)
+                    {
+                        continue;
+                    }
+                    lock.unlock();
+                    subscription->listener();
+                    lock.lock();
+                }
+                m_dispatching = false;
+                m_dispatchDone.notify_all();
+            }
+        }
+
+        const std::chrono::milliseconds m_pollInterval;
+
+        std::mutex                          m_mutex;
+        std::condition_variable             m_cv;
+        std::condition_variable             m_dispatchDone;
+        bool                                m_dispatching = false;
+        std::thread                         m_pollThread;
+        bool                                m_stop = false;
+        GetInferenceEngineStreamingExtFunc* m_resolver = nullptr;
+
+        std::map<std::pair<IInferenceEngine*, int>, std::shared_ptr<Subscription>> m_subscriptions;
+    };
+
+} // namespace Model
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+namespace Model
+{
+    /**
+     * @brief Identifies a job: ids are only unique within the engine that issued them, and
+     *        every loaded model has its own engine.
+     */
+    struct JobKey
+    {
+        std::string modelId;
+        int         jobId = -1;
+
+        bool operator==(const JobKey& other) const
+        {
+            return jobId == other.jobId && modelId == other.modelId;
+        }
+    };
+
+    struct JobKeyHash
+    {
+        size_t operator()(const JobKey& key) const
+        {
+            const size_t h = std::hash<std::string>()(key.modelId);
+            return h ^ (std::hash<int>()(key.jobId) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+        }
+    };
+
+    /**
+     * @brief Tracks running jobs and whether they have been cancelled.
+     *
+     * Jobs are spread over independently locked shards, so submitting, finishing and
+     * cancelling jobs never contends with model loading or with jobs in other shards.
+     * Each job gets a shared cancel token; hot loops hold on to it and check it with a
+     * single atomic load instead of looking the job up. Jobs are keyed by model and job
+     * id, since two engines hand out the same ids.
+     */
+    class JobRegistry
+    {
+    public:
+        using CancelToken = std::shared_ptr<std::atomic<bool>>;
+
+        JobRegistry() = default;
+        JobRegistry(const JobRegistry&) = delete;
+        JobRegistry& operator=(const JobRegistry&) = delete;
+
+        /**
+         * @brief Registers a job as active and returns its token (true while the job should run).
+         * @throws std::logic_error if the job is already registered; the engine would have
+         *         reused the id of a job that never finished.
+         */
+        CancelToken add(const std::string& modelId, int jobId)
+        {
+            JobKey key{ modelId, jobId };
+            auto token = std::make_shared<std::atomic<bool>>(true);
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.jobs.emplace(std::move(key), Entry{ token, std::nullopt }).second)
+            {
+                throw std::logic_error("Job " + std::to_string(jobId) + " of model " + modelId + " is already registered");
+            }
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            return token;
+        }
+
+        void remove(const std::string& modelId, int jobId)
+        {
+            const JobKey key{ modelId, jobId };
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.jobs.erase(key) > 0)
+            {
+                m_count.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Associates the job with the streaming pump entry that drives it.
+        void setPumpHandle(const std::string& modelId, int jobId, uint64_t handle)
+        {
+            const JobKey key{ modelId, jobId };
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.jobs.find(key);
+            if (it != shard.jobs.end())
+            {
+                it->second.pumpHandle = handle;
+            }
+        }
+
+        /**
+         * @brief Marks the job as cancelled.
+         * @return The job's pump handle, if it is driven by the streaming pump.
+         */
+        std::optional<uint64_t> cancel(const std::string& modelId, int jobId)
+        {
+            const JobKey key{ modelId, jobId };
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.jobs.find(key);
+            if (it == shard.jobs.end())
+            {
+                return std::nullopt;
+            }
+            it->second.token->store(false, std::memory_order_release);
+            return it->second.pumpHandle;
+        }
+
+        // Cancels every registered job and returns their keys.
+        std::vector<JobKey> cancelAll()
+        {
+            std::vector<JobKey> keys;
+            for (Shard& shard : m_shards)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for (auto& [key, entry] : shard.jobs)
+                {
+                    entry.token->store(false, std::memory_order_release);
+                    keys.push_back(key);
+                }
+            }
+            return keys;
+        }
+
+        bool isActive(const std::string& modelId, int jobId) const
+        {
+            const JobKey key{ modelId, jobId };
+            const Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.jobs.find(key);
+            return it != shard.jobs.end() && it->second.token->load(std::memory_order_acquire);
+        }
+
+        size_t size() const
+        {
+            return m_count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr size_t SHARD_COUNT = 16;
+
+        struct Entry
+        {
+            CancelToken             token;
+            std::optional<uint64_t> pumpHandle;
+        };
+
+        // Keep shards on separate cache lines so uncontended shards don't false-share
+        struct alignas(64) Shard
+        {
+            mutable std::mutex                              mutex;
+            std::unordered_map<JobKey, Entry, JobKeyHash>   jobs;
+        };
+
+        // Consecutive ids of one model land in consecutive shards
+        static size_t shardIndex(const JobKey& key)
+        {
+            return (std::hash<std::string>()(key.modelId) + static_cast<unsigned int>(key.jobId)) % SHARD_COUNT;
+        }
+
+        Shard& shardFor(const JobKey& key)
+        {
+            return m_shards[shardIndex(key)];
+        }
+
+        const Shard& shardFor(const JobKey& key) const
+        {
+            return m_shards[shardIndex(key)];
+        }
+
+        std::array<Shard, SHARD_COUNT> m_shards;
+        std::atomic<size_t>            m_count{ 0 };
+    };
+
+} // namespace Model
@@ -19,6 +19,8 @@ namespace Model
         int lastSelected;
         std::atomic_bool cancelDownload{ false };
         float size;
+        // Hex SHA-256 of the file; empty if the model list doesn't provide one
+        std::string sha256;
 
         // Default constructor is fine.
         ModelVariant() = default;
@@ -33,6 +35,7 @@ namespace Model
             , lastSelected(other.lastSelected)
             , cancelDownload(false)
 			, size(other.size)
+            , sha256(other.sha256)
         {
         }
 
@@ -47,6 +50,7 @@ namespace Model
                 lastSelected = other.lastSelected;
                 cancelDownload = false;
 				size = other.size;
+                sha256 = other.sha256;
             }
             return *this;
         }
@@ -61,7 +65,8 @@ namespace Model
             {"isDownloaded", v.isDownloaded},
             {"downloadProgress", v.downloadProgress},
             {"lastSelected", v.lastSelected},
-            {"size", v.size} };
+            {"size", v.size},
+            {"sha256", v.sha256} };
     }
 
     inline void from_json(const nlohmann::json& j, ModelVariant& v)
@@ -73,6 +78,8 @@ namespace Model
         j.at("downloadProgress").get_to(v.downloadProgress);
         j.at("lastSelected").get_to(v.lastSelected);
 		j.at("size").get_to(v.size);
+        // Optional, older model files don't have it
+        v.sha256 = j.value("sha256", std::string());
     }
 
     // Refactored ModelData to use a map of variants
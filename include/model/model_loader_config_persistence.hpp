@@ -5,6 +5,8 @@
 #include <json.hpp>
 #include <types.h>
 
+#include "durable_writer.hpp"
+
 namespace Model
 {
     class ModelLoaderConfigPersistence {
@@ -19,15 +21,12 @@ namespace Model
             try {
                 nlohmann::json j = configToJson(config);
 
-                std::ofstream file(filePath);
-                if (!file.is_open()) {
-                    std::cerr << "Error: Could not open file for writing: " << filePath << std::endl;
+                // Pretty print with 4 spaces indentation
+                if (!DurableWriter::instance().write(filePath, j.dump(4))) {
+                    std::cerr << "Error: Could not write file: " << filePath << std::endl;
                     return false;
                 }
 
-                file << j.dump(4); // Pretty print with 4 spaces indentation
-                file.close();
-
                 return true;
             }
             catch (const std::exception& e) {
@@ -43,6 +42,10 @@ namespace Model
          * @return true if successful, false otherwise
          */
         bool loadFromFile(const std::string& filePath, LoadingParameters& config) {
+            const std::filesystem::path path(filePath);
+            DurableWriter::instance().removeStaleTemps(
+                path.has_parent_path() ? path.parent_path() : std::filesystem::path("."), path.filename().string());
+
             try {
                 std::ifstream file(filePath);
                 if (!file.is_open()) {
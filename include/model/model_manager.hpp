@@ -3,8 +3,17 @@
 #include "system_monitor.hpp"
 #include "preset_manager.hpp"
 #include "model_persistence.hpp"
+#include "download_scheduler.hpp"
 #include "model_loader_config_manager.hpp"
 #include "threadpool.hpp"
+#include "job_pump.hpp"
+#include "job_notifier.hpp"
+#include "admission_controller.hpp"
+#include "prefix_kv_cache.hpp"
+#include "residency_manager.hpp"
+#include "job_registry.hpp"
+#include "stream_chunk_buffer.hpp"
+#include "stream_reaper.hpp"
 
 #include <kolosal_server.hpp>
 #include <types.h>
@@ -13,9 +22,14 @@
 #include <vector>
 #include <optional>
 #include <shared_mutex>
+#include <deque>
 #include <unordered_map>
 #include <future>
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#include <atomic>
 #include <curl/curl.h>
 
 #ifdef _WIN32
@@ -35,6 +49,25 @@ namespace Model
 {
     static std::atomic<int> seqCounter;
 
+    /**
+     * @brief Memory held by server streaming contexts for chunks not yet sent to clients.
+     */
+    struct StreamingBufferStats
+    {
+        size_t streams = 0;
+        size_t bufferedChunks = 0;
+        size_t bufferedBytes = 0;
+    };
+
+    /**
+     * @brief Read position into a job's output, used to fetch incremental results.
+     */
+    struct JobResultCursor
+    {
+        size_t tokenOffset = 0;
+        size_t textOffset  = 0;
+    };
+
     // TODO: Instead of using singleton, i'm thinking of approaching it using a C style implementation
 	//       to avoid the overhead of singleton pattern, and to make it more readable and maintainable.
     class ModelManager
@@ -55,6 +88,7 @@ namespace Model
         {
             std::unique_lock<std::shared_mutex> lock(m_mutex);
             m_persistence = std::move(persistence);
+            m_persistence->setBandwidthLimiter(m_downloadScheduler.limiter());
             m_currentModelName = std::nullopt;
             m_currentModelIndex = 0;
         }
@@ -543,6 +577,13 @@ namespace Model
 		// Inference Engine
 		//--------------------------------------------------------------------------------------------
 
+        static int nextSeqId()
+        {
+            auto now = std::chrono::system_clock::now();
+            auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+            return static_cast<int>(timestamp * 1000 + seqCounter++);
+        }
+
         ChatCompletionParameters buildChatCompletionParameters(
             const ChatCompletionRequest& request) {
             ChatCompletionParameters params;
@@ -570,9 +611,7 @@ namespace Model
             params.streaming = request.stream;
 
 			// set seqId to be the current timestamp
-            auto now = std::chrono::system_clock::now();
-            auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-            params.seqId = static_cast<int>(timestamp * 1000 + seqCounter++);
+            params.seqId = nextSeqId();
 
             return params;
         }
@@ -616,9 +655,7 @@ namespace Model
             params.streaming = request.stream;
 
             // Set unique sequence ID based on timestamp
-            auto now = std::chrono::system_clock::now();
-            auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-            params.seqId = static_cast<int>(timestamp * 1000 + seqCounter++);
+            params.seqId = nextSeqId();
 
             return params;
         }
@@ -722,17 +759,87 @@ namespace Model
                 std::cerr << "[ModelManager] Model " << modelId << "not loaded" << std::endl;
                 return false;
             }
+            lock.unlock();
 
-            // Mark the job as inactive in our tracking map
-            {
-                auto it = m_activeJobs.find(jobId);
-                if (it != m_activeJobs.end()) {
-                    it->second = false;
-                }
+            cancelJob(modelId, jobId);
+            return true;
+        }
+
+        /**
+         * @brief Cancel hook for a streaming request: stops its job right away instead of
+         *        letting it generate until the chunk wait times out.
+         *
+         * Only stopServer() calls it today. The kolosal-server HTTP layer
+         * does not report client disconnects yet; once it exposes a disconnect or
+         * write-failure callback, that callback should call this.
+         * @return False if no stream with this request id is open.
+         */
+        bool cancelStreamingRequest(const std::string& requestId)
+        {
+            if (auto ctx = StreamReaper::take(m_streamContextsMutex, m_streamingContexts, requestId)) {
+                cancelStream(requestId, *ctx, "client disconnected");
+                return true;
+            }
+            if (auto ctx = StreamReaper::take(m_completionStreamContextsMutex, m_completionStreamingContexts, requestId)) {
+                cancelStream(requestId, *ctx, "client disconnected");
+                return true;
             }
+            return false;
+        }
 
-            m_inferenceEngines.at(modelId)->stopJob(jobId);
-            return true;
+        /**
+         * @brief Sets how long a stream may go without its client pulling a chunk before
+         *        the reaper cancels it. Streams are checked every STREAM_REAPER_INTERVAL.
+         */
+        void setStreamIdleTimeout(std::chrono::milliseconds timeout)
+        {
+            m_streamIdleTimeoutMs = timeout.count();
+        }
+
+        // Streams cancelled because their client went away, and the tokens they had generated
+        uint64_t getCancelledStreamCount() const { return m_cancelledStreams.load(); }
+        uint64_t getCancelledStreamTokens() const { return m_cancelledStreamTokens.load(); }
+
+        StreamingBufferStats getStreamingBufferStats()
+        {
+            StreamingBufferStats stats;
+            collectStreamingBufferStats(m_streamContextsMutex, m_streamingContexts, stats);
+            collectStreamingBufferStats(m_completionStreamContextsMutex, m_completionStreamingContexts, stats);
+            return stats;
+        }
+
+        size_t getStreamingQueueDepth() const
+        {
+            return m_jobPump.queueDepth();
+        }
+
+        size_t getActiveStreamingJobs() const
+        {
+            return m_jobPump.activeJobs();
+        }
+
+        /**
+         * @brief Sets how many server requests may wait for a busy model and for how long
+         *        before being rejected. Concurrency per model follows its n_parallel.
+         */
+        void setServerAdmissionLimits(size_t maxQueueDepth, std::chrono::milliseconds queueTimeout)
+        {
+            m_admission.setLimits(maxQueueDepth, queueTimeout);
+        }
+
+        AdmissionController::ModelStats getServerAdmissionStats(const std::string& modelId) const
+        {
+            return m_admission.getStats(modelId);
+        }
+
+        void setPrefixCacheBudget(uintmax_t diskBudgetBytes)
+        {
+            m_prefixCache.setDiskBudget(diskBudgetBytes);
+        }
+
+        PrefixKvCache::Stats getPrefixCacheStats() const
+        {
+            return m_prefixCache.getStats();
         }
 
         CompletionResult completeSync(const CompletionParameters& params, const std::string modelName, const std::string variant)
@@ -763,12 +870,8 @@ namespace Model
                 return emptyResult;
             }
 
-            // Add job ID with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.push_back(jobId);
-                m_activeJobs[jobId] = true;
-            }
+            // Track the job so it can be cancelled
+            m_jobRegistry.add(modelId, jobId);
 
             // Wait for the job to complete
             m_inferenceEngines.at(modelId)->waitForJob(jobId);
@@ -782,12 +885,8 @@ namespace Model
                     << m_inferenceEngines.at(modelId)->getJobError(jobId) << std::endl;
             }
 
-            // Clean up with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
-                m_activeJobs.erase(jobId);
-            }
+            // Clean up job tracking
+            m_jobRegistry.remove(modelId, jobId);
 
             return result;
         }
@@ -818,12 +917,8 @@ namespace Model
                 return emptyResult;
             }
 
-            // Add job ID with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.push_back(jobId);
-                m_activeJobs[jobId] = true;
-            }
+            // Track the job so it can be cancelled
+            m_jobRegistry.add(modelId, jobId);
 
             // Wait for the job to complete
             m_inferenceEngines.at(modelId)->waitForJob(jobId);
@@ -837,12 +932,8 @@ namespace Model
                     << m_inferenceEngines.at(modelId)->getJobError(jobId) << std::endl;
             }
 
-            // Clean up with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
-                m_activeJobs.erase(jobId);
-            }
+            // Clean up job tracking
+            m_jobRegistry.remove(modelId, jobId);
 
             return result;
         }
@@ -853,6 +944,8 @@ namespace Model
 			emptyResult.text = "";
 			emptyResult.tps = 0.0F;
 
+            auto kvLease = leaseChatKvCache(params.kvCacheFilePath);
+
 			std::string modelId = modelName + ":" + variant;
 
             {
@@ -875,12 +968,8 @@ namespace Model
                 return emptyResult;
             }
 
-            // Add job ID with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.push_back(jobId);
-                m_activeJobs[jobId] = true;
-            }
+            // Track the job so it can be cancelled
+            m_jobRegistry.add(modelId, jobId);
 
             // Wait for the job to complete
             m_inferenceEngines.at(modelId)->waitForJob(jobId);
@@ -894,12 +983,8 @@ namespace Model
                     << m_inferenceEngines.at(modelId)->getJobError(jobId) << std::endl;
             }
 
-            // Clean up with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
-                m_activeJobs.erase(jobId);
-            }
+            // Clean up job tracking
+            m_jobRegistry.remove(modelId, jobId);
 
             // Save the chat history
             if (saveChat)
@@ -927,6 +1012,8 @@ namespace Model
             emptyResult.text = "";
             emptyResult.tps = 0.0F;
 
+            auto kvLease = leaseChatKvCache(params.kvCacheFilePath);
+
             {
                 std::shared_lock<std::shared_mutex> lock(m_mutex);
                 if (!m_inferenceEngines.at(modelId))
@@ -947,12 +1034,8 @@ namespace Model
                 return emptyResult;
             }
 
-            // Add job ID with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.push_back(jobId);
-                m_activeJobs[jobId] = true;
-            }
+            // Track the job so it can be cancelled
+            m_jobRegistry.add(modelId, jobId);
 
             // Wait for the job to complete
             m_inferenceEngines.at(modelId)->waitForJob(jobId);
@@ -966,12 +1049,8 @@ namespace Model
                     << m_inferenceEngines.at(modelId)->getJobError(jobId) << std::endl;
             }
 
-            // Clean up with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
-                m_activeJobs.erase(jobId);
-            }
+            // Clean up job tracking
+            m_jobRegistry.remove(modelId, jobId);
 
             // Save the chat history
             if (saveChat)
@@ -1018,49 +1097,36 @@ namespace Model
                 return -1;
             }
 
-            // Add job ID with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.push_back(jobId);
-                m_activeJobs[jobId] = true;
-            }
-
-            // Use thread pool instead of creating a detached thread
-            std::thread([this, jobId, streamingCallback, saveChat, modelId]() {
-                // Poll while job is running or until the engine says it's done
-                while (true)
-                {
-                    // Check if job was stopped externally
-                    {
-                        std::shared_lock<std::shared_mutex> lock(m_mutex);
-                        auto it = m_activeJobs.find(jobId);
-                        if (it == m_activeJobs.end() || !it->second) break;
-                    }
+            // Track the job so it can be cancelled
+            auto cancelToken = m_jobRegistry.add(modelId, jobId);
 
-                    if (this->m_inferenceEngines.at(modelId)->hasJobError(jobId)) break;
+            // Step the job on the shared streaming pump whenever the engine reports output
+            IInferenceEngine* engine = m_inferenceEngines.at(modelId);
+            auto cursor = std::make_shared<JobResultCursor>();
+            // Keep the model from being evicted while the job runs
+            auto residency = m_residency.pin(modelId);
 
-                    CompletionResult partial = this->m_inferenceEngines.at(modelId)->getJobResult(jobId);
-                    bool isFinished = this->m_inferenceEngines.at(modelId)->isJobFinished(jobId);
+            auto step = [this, engine, jobId, streamingCallback, cursor, cancelToken]() {
+                // Check if job was stopped externally
+                if (!cancelToken->load(std::memory_order_acquire)) return true;
 
-                    if (!partial.text.empty()) {
-                        // Call the user's callback (no need to lock for the callback)
-                        if (streamingCallback) {
-                            streamingCallback(partial.text, partial.tps, jobId, isFinished);
-                        }
-                    }
+                if (engine->hasJobError(jobId)) return true;
 
-                    if (isFinished) break;
+                // Check completion before reading so the last delta is never missed
+                bool isFinished = engine->isJobFinished(jobId);
+                CompletionResult delta = readJobResultSince(engine, jobId, *cursor);
 
-                    // Sleep briefly to avoid busy-waiting
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                // Hand only the newly generated text to the callback, and always report completion
+                if ((!delta.text.empty() || isFinished) && streamingCallback) {
+                    streamingCallback(delta.text, delta.tps, jobId, isFinished);
                 }
 
-                // Remove job ID with proper synchronization
-                {
-                    std::unique_lock<std::shared_mutex> lock(m_mutex);
-                    m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
-                    m_activeJobs.erase(jobId);
-                }
+                return isFinished;
+                };
+
+            auto onDone = [this, modelId, jobId, saveChat, residency]() {
+                // Remove job tracking
+                m_jobRegistry.remove(modelId, jobId);
 
                 // Reset jobid tracking on chat manager
                 if (saveChat)
@@ -1070,7 +1136,9 @@ namespace Model
                         std::cerr << "[ModelManager] Failed to remove job id from chat manager.\n";
                     }
                 }
-                }).detach();
+                };
+
+            startStreamingPump(modelId, engine, jobId, std::move(step), std::move(onDone));
 
             return jobId;
         }
@@ -1078,6 +1146,8 @@ namespace Model
         int startChatCompletionJob(const ChatCompletionParameters& params, std::function<void(const std::string&, 
             const float, const int, const bool)> streamingCallback, const std::string modelName, const std::string variant, const bool saveChat = true)
         {
+            auto kvLease = leaseChatKvCache(params.kvCacheFilePath);
+
 			std::string modelId = modelName + ":" + variant;
 
             {
@@ -1100,48 +1170,36 @@ namespace Model
                 return -1;
             }
 
-            // Add job ID with proper synchronization
-            {
-                std::unique_lock<std::shared_mutex> lock(m_mutex);
-                m_jobIds.push_back(jobId);
-                m_activeJobs[jobId] = true;
-            }
-
-            // Use thread pool instead of creating a detached thread
-            std::thread([this, jobId, streamingCallback, saveChat, modelId]() {
-                while (true)
-                {
-                    // Check if job was stopped externally
-                    {
-                        std::shared_lock<std::shared_mutex> lock(m_mutex);
-                        auto it = m_activeJobs.find(jobId);
-                        if (it == m_activeJobs.end() || !it->second) break;
-                    }
+            // Track the job so it can be cancelled
+            auto cancelToken = m_jobRegistry.add(modelId, jobId);
 
-                    if (this->m_inferenceEngines.at(modelId)->hasJobError(jobId)) break;
+            // Step the job on the shared streaming pump whenever the engine reports output
+            IInferenceEngine* engine = m_inferenceEngines.at(modelId);
+            auto cursor = std::make_shared<JobResultCursor>();
+            // Keep the model from being evicted while the job runs
+            auto residency = m_residency.pin(modelId);
 
-                    CompletionResult partial = this->m_inferenceEngines.at(modelId)->getJobResult(jobId);
-                    bool isFinished = this->m_inferenceEngines.at(modelId)->isJobFinished(jobId);
+            auto step = [this, engine, jobId, streamingCallback, cursor, cancelToken]() {
+                // Check if job was stopped externally
+                if (!cancelToken->load(std::memory_order_acquire)) return true;
 
-                    if (!partial.text.empty()) {
-                        // Call the user's callback (no need to lock for the callback)
-                        if (streamingCallback) {
-                            streamingCallback(partial.text, partial.tps, jobId, isFinished);
-                        }
-                    }
+                if (engine->hasJobError(jobId)) return true;
 
-                    if (isFinished) break;
+                // Check completion before reading so the last delta is never missed
+                bool isFinished = engine->isJobFinished(jobId);
+                CompletionResult delta = readJobResultSince(engine, jobId, *cursor);
 
-                    // Sleep briefly to avoid busy-waiting
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                // Hand only the newly generated text to the callback, and always report completion
+                if ((!delta.text.empty() || isFinished) && streamingCallback) {
+                    streamingCallback(delta.text, delta.tps, jobId, isFinished);
                 }
 
-                // Remove job ID with proper synchronization
-                {
-                    std::unique_lock<std::shared_mutex> lock(m_mutex);
-                    m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
-                    m_activeJobs.erase(jobId);
-                }
+                return isFinished;
+                };
+
+            auto onDone = [this, modelId, jobId, saveChat, residency, kvLease]() {
+                // Remove job tracking
+                m_jobRegistry.remove(modelId, jobId);
 
                 if (saveChat)
                 {
@@ -1164,7 +1222,9 @@ namespace Model
                         }
                     }
                 }
-                }).detach();
+                };
+
+            startStreamingPump(modelId, engine, jobId, std::move(step), std::move(onDone));
 
             return jobId;
         }
@@ -1193,6 +1253,20 @@ namespace Model
             return m_inferenceEngines.at(modelId)->getJobResult(jobId);
         }
 
+        // Returns only the output produced since `cursor` and advances it, so callers that
+        // stream a job pay for each token once instead of re-copying the whole result.
+        CompletionResult getJobResultSince(int jobId, JobResultCursor& cursor, const std::string modelName, const std::string variant)
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            std::string modelId = modelName + ":" + variant;
+            if (!m_inferenceEngines.at(modelId))
+            {
+                std::cerr << "[ModelManager] Model " << modelId << "not loaded" << std::endl;
+                return { {}, "" };
+            }
+            return readJobResultSince(m_inferenceEngines.at(modelId), jobId, cursor);
+        }
+
         bool hasJobError(int jobId, const std::string modelName, const std::string variant) const
         {
             std::shared_lock<std::shared_mutex> lock(m_mutex);
@@ -1233,7 +1307,13 @@ namespace Model
             // Set chat completion callbacks
             kolosal::ServerAPI::instance().setChatCompletionCallback(
                 [this](const ChatCompletionRequest& request) {
-                    return this->handleChatCompletionRequest(request);
+                    try {
+                        return this->handleChatCompletionRequest(request);
+                    }
+                    catch (const AdmissionRejectedError& e) {
+                        logAdmissionRejected("chat completion", "", e);
+                        return ChatCompletionResponse{};
+                    }
                 }
             );
 
@@ -1242,14 +1322,26 @@ namespace Model
                     const std::string& requestId,
                     int chunkIndex,
                     ChatCompletionChunk& outputChunk) {
-                        return this->handleChatCompletionStreamingRequest(request, requestId, chunkIndex, outputChunk);
+                        try {
+                            return this->handleChatCompletionStreamingRequest(request, requestId, chunkIndex, outputChunk);
+                        }
+                        catch (const AdmissionRejectedError& e) {
+                            logAdmissionRejected("streaming chat completion", requestId, e);
+                            return false;
+                        }
                 }
             );
 
             // Set completion callbacks
             kolosal::ServerAPI::instance().setCompletionCallback(
                 [this](const CompletionRequest& request) {
-                    return this->handleCompletionRequest(request);
+                    try {
+                        return this->handleCompletionRequest(request);
+                    }
+                    catch (const AdmissionRejectedError& e) {
+                        logAdmissionRejected("completion", "", e);
+                        return CompletionResponse{};
+                    }
                 }
             );
 
@@ -1258,7 +1350,13 @@ namespace Model
                     const std::string& requestId,
                     int chunkIndex,
                     CompletionChunk& outputChunk) {
-                        return this->handleCompletionStreamingRequest(request, requestId, chunkIndex, outputChunk);
+                        try {
+                            return this->handleCompletionStreamingRequest(request, requestId, chunkIndex, outputChunk);
+                        }
+                        catch (const AdmissionRejectedError& e) {
+                            logAdmissionRejected("streaming completion", requestId, e);
+                            return false;
+                        }
                 }
             );
 
@@ -1269,6 +1367,8 @@ namespace Model
 				}
 			);
 
+            startStreamReaper();
+
             // Initialize and start the server
             if (!kolosal::ServerAPI::instance().init(port)) {
                 Logger::logError("Failed to start model server");
@@ -1282,20 +1382,71 @@ namespace Model
         void stopServer() {
             Logger::logInfo("Stopping model server");
             kolosal::ServerAPI::instance().shutdown();
+            stopStreamReaper();
+
+            // Every streaming client is gone with the server; stop generating for them
+            std::vector<std::string> openStreams;
+            {
+                std::lock_guard<std::mutex> lock(m_streamContextsMutex);
+                for (const auto& [requestId, ctx] : m_streamingContexts) {
+                    openStreams.push_back(requestId);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_completionStreamContextsMutex);
+                for (const auto& [requestId, ctx] : m_completionStreamingContexts) {
+                    openStreams.push_back(requestId);
+                }
+            }
+            for (const auto& requestId : openStreams) {
+                cancelStreamingRequest(requestId);
+            }
         }
 
         std::vector<std::string> handleGetModelsRequest() {
-            std::shared_lock<std::shared_mutex> lock(m_mutex);
             std::vector<std::string> modelIds;
-            modelIds.reserve(m_inferenceEngines.size());
-            for (const auto& pair : m_inferenceEngines) {
-                modelIds.push_back(pair.first);
+            {
+                std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+                // Resident models first, then downloaded ones that will be loaded on demand
+                for (const auto& pair : m_inferenceEngines) {
+                    modelIds.push_back(pair.first);
+                }
+                for (const auto& model : m_models) {
+                    for (const auto& [variantType, variant] : model.variants) {
+                        std::string modelId = model.name + ":" + variantType;
+                        if (variant.isDownloaded && m_inferenceEngines.find(modelId) == m_inferenceEngines.end()) {
+                            modelIds.push_back(modelId);
+                        }
+                    }
+                }
             }
+
+            logResidency();
             return modelIds;
         }
 
+        /**
+         * @brief Caps the estimated memory of all resident engines. Loading a model on
+         *        demand evicts least recently used idle engines to stay within it.
+         *        0 uses the machine's GPU memory (or RAM without a GPU) minus headroom.
+         */
+        void setResidencyBudget(size_t bytes)
+        {
+            m_residency.setBudget(bytes);
+        }
+
+        std::vector<ResidencyManager::ResidentModel> getResidentModels() const
+        {
+            return m_residency.snapshot();
+        }
+
         ChatCompletionResponse handleChatCompletionRequest(const ChatCompletionRequest& request) {
-			if (m_inferenceEngines.find(request.model) == m_inferenceEngines.end()) {
+            // Load the model on demand and keep it resident until the response is built,
+            // unless its queue is full and the request would be turned away anyway
+            rejectIfServerQueueFull(request.model, "chat completion");
+            auto residency = ensureModelResident(request.model);
+			if (!residency) {
                 Logger::logError("[ModelManager] Model %s not loaded",
                     request.model.c_str());
 				return {};
@@ -1308,8 +1459,15 @@ namespace Model
 
 			Logger::logInfo("[ModelManager] Handling chat completion request for model %s", request.model.c_str());
 
+            // Hold a slot for the model until the response is built
+            auto admission = admitServerRequest(request.model, "chat completion");
+
+            // Start from the longest cached KV prefix of this conversation, if any
+            auto prefixLease = acquirePrefixCache(request.model, params);
+
             // Invoke the synchronous chat completion method.
             CompletionResult result = chatCompleteSync(params, request.model, false);
+            if (prefixLease) prefixLease->complete();
 
             // Map the engine’s result to our ChatCompletionResponse.
             ChatCompletionResponse response = convertToChatResponse(request, result);
@@ -1317,7 +1475,11 @@ namespace Model
         }
 
         CompletionResponse handleCompletionRequest(const CompletionRequest& request) {
-			if (m_inferenceEngines.find(request.model) == m_inferenceEngines.end()) {
+            // Load the model on demand and keep it resident until the response is built,
+            // unless its queue is full and the request would be turned away anyway
+            rejectIfServerQueueFull(request.model, "completion");
+            auto residency = ensureModelResident(request.model);
+			if (!residency) {
                 Logger::logError("[ModelManager] Model %s not loaded",
                     request.model.c_str());
 				return {};
@@ -1329,6 +1491,28 @@ namespace Model
 
 			Logger::logInfo("[ModelManager] Handling completion request for model %s", request.model.c_str());
 
+            // Hold a slot for the model until the response is built
+            auto admission = admitServerRequest(request.model, "completion");
+
+            // Every prompt of an array prompt runs as its own sequence
+            const auto* prompts = std::get_if<std::vector<std::string>>(&request.prompt);
+            if (prompts && prompts->size() > 1) {
+                std::vector<CompletionParameters> jobs;
+                jobs.reserve(prompts->size());
+                for (const auto& prompt : *prompts) {
+                    CompletionParameters job = params;
+                    job.prompt = prompt;
+                    job.seqId = nextSeqId();
+                    jobs.push_back(std::move(job));
+                }
+
+                std::vector<CompletionResult> results = runJobsInParallel(request.model, jobs,
+                    [](IInferenceEngine* engine, const CompletionParameters& job) {
+                        return engine->submitCompletionsJob(job);
+                    });
+                return convertToCompletionResponse(request, results);
+            }
+
             // Invoke the synchronous completion method
             CompletionResult result = completeSync(params, request.model);
 
@@ -1344,12 +1528,25 @@ namespace Model
             ChatCompletionChunk& outputChunk) {
 
             // Check if the model name is loaded
-            if (m_inferenceEngines.find(request.model) == m_inferenceEngines.end()) {
+            // The first chunk loads the model on demand; the running job keeps it resident
+            std::shared_ptr<ResidencyManager::Pin> residency;
+            if (chunkIndex == 0) {
+                rejectIfServerQueueFull(request.model, "streaming chat completion", requestId);
+                residency = ensureModelResident(request.model);
+            }
+            if ((chunkIndex == 0 && !residency) ||
+                (chunkIndex > 0 && m_inferenceEngines.find(request.model) == m_inferenceEngines.end())) {
 				Logger::logError("[ModelManager] Model %s not loaded for streaming requestId: %s",
 					request.model.c_str(), requestId.c_str());
                 return false;
             }
 
+            // Wait for a slot before creating any state, so rejected requests leave nothing behind
+            std::shared_ptr<AdmissionController::Ticket> admission;
+            if (chunkIndex == 0) {
+                admission = admitServerRequest(request.model, "streaming chat completion", requestId);
+            }
+
             // Look up (or create) the ChatCompletionStreamingContext for this requestId.
             std::shared_ptr<ChatCompletionStreamingContext> ctx;
             {
@@ -1379,6 +1576,9 @@ namespace Model
                 ChatCompletionParameters params = buildChatCompletionParameters(request);
                 params.streaming = true;
 
+                // Start from the longest cached KV prefix of this conversation, if any
+                auto prefixLease = acquirePrefixCache(request.model, params);
+
                 // Track the job ID and model name for this request
                 int jobId = -1;
 
@@ -1408,107 +1608,96 @@ namespace Model
                     return false;
                 }
 
-                // Add job ID with proper synchronization to the global tracking
-                {
-                    std::unique_lock<std::shared_mutex> lock(m_mutex);
-                    m_jobIds.push_back(jobId);
-                    m_activeJobs[jobId] = true;
-                }
+                // Track the job so it can be cancelled
+                auto cancelToken = m_jobRegistry.add(request.model, jobId);
 
-                // Use thread pool instead of detached thread
-                std::thread([this, jobId, request, requestId, ctx]() {
-                    std::string lastText;
-                    auto startTime = std::chrono::steady_clock::now();
+                // Step the job on the shared streaming pump whenever the engine reports output
+                IInferenceEngine* engine = m_inferenceEngines.at(request.model);
+                auto cursor = std::make_shared<JobResultCursor>();
+                auto startTime = std::chrono::steady_clock::now();
 
+                auto step = [this, engine, jobId, ctx, cursor, startTime, cancelToken]() {
                     try {
-                        while (true) {
-                            // Check if job was stopped externally
+                        // Check if job was stopped externally
+                        if (!cancelToken->load(std::memory_order_acquire)) return true;
+
+                        // Check if the job has an error
+                        if (engine->hasJobError(jobId)) {
+                            std::string errorMsg = engine->getJobError(jobId);
+                            Logger::logError("[ModelManager] Streaming job error for jobId: %d - %s",
+                                jobId, errorMsg.c_str());
                             {
-                                std::shared_lock<std::shared_mutex> lock(m_mutex);
-                                auto it = m_activeJobs.find(jobId);
-                                if (it == m_activeJobs.end() || !it->second) {
-                                    std::lock_guard<std::mutex> ctxLock(ctx->mtx);
-                                    ctx->finished = true;
-                                    break;
-                                }
-                            }
-
-                            // Check if the job has an error
-                            if (this->m_inferenceEngines.at(request.model)->hasJobError(jobId)) {
-                                std::string errorMsg = this->m_inferenceEngines.at(request.model)->getJobError(jobId);
-                                Logger::logError("[ModelManager] Streaming job error for jobId: %d - %s",
-                                    jobId, errorMsg.c_str());
-                                {
-                                    std::lock_guard<std::mutex> lock(ctx->mtx);
-                                    ctx->error = true;
-                                    ctx->errorMessage = errorMsg;
-                                    ctx->finished = true;
-                                }
-                                ctx->cv.notify_all();
-                                break;
+                                std::lock_guard<std::mutex> lock(ctx->mtx);
+                                ctx->error = true;
+                                ctx->errorMessage = errorMsg;
                             }
+                            return true;
+                        }
 
-                            // Get the current result and check if finished
-                            CompletionResult partial = this->m_inferenceEngines.at(request.model)->getJobResult(jobId);
-                            bool isFinished = this->m_inferenceEngines.at(request.model)->isJobFinished(jobId);
+                        // Leave new output in the engine until the client catches up; taking a
+                        // chunk wakes this job again
+                        {
+                            std::lock_guard<std::mutex> lock(ctx->mtx);
+                            if (ctx->chunks.full()) return false;
+                        }
 
-                            // Compute delta text (only new text since last poll).
-                            std::string newText;
-                            if (partial.text.size() > lastText.size()) {
-                                newText = partial.text.substr(lastText.size());
-                                lastText = partial.text;
-                            }
+                        // Check if finished, then fetch only the text produced since the last read
+                        bool isFinished = engine->isJobFinished(jobId);
+                        CompletionResult delta = readJobResultSince(engine, jobId, *cursor);
 
-                            // If we have new text, add it to the chunks
-                            if (!newText.empty()) {
-                                {
-                                    std::lock_guard<std::mutex> lock(ctx->mtx);
-                                    ctx->chunks.push_back(newText);
-                                }
-                                ctx->cv.notify_all();
+                        // If we have new text, add it to the chunks
+                        if (!delta.text.empty()) {
+                            {
+                                std::lock_guard<std::mutex> lock(ctx->mtx);
+                                ctx->chunks.push(std::move(delta.text));
+                                ctx->generatedTokens = cursor->tokenOffset;
                             }
+                            ctx->cv.notify_all();
+                        }
 
-                            // If the job is finished, set the finished flag and break
-                            if (isFinished) {
-                                auto endTime = std::chrono::steady_clock::now();
-                                auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                    endTime - startTime).count();
-
-                                Logger::logInfo("[ModelManager] Streaming job %d completed in %lld ms",
-                                    jobId, durationMs);
-
-                                {
-                                    std::lock_guard<std::mutex> lock(ctx->mtx);
-                                    ctx->finished = true;
-                                }
-                                ctx->cv.notify_all();
-                                break;
-                            }
+                        if (isFinished) {
+                            auto endTime = std::chrono::steady_clock::now();
+                            auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                endTime - startTime).count();
 
-                            // Sleep briefly to avoid busy-waiting
-                            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                            Logger::logInfo("[ModelManager] Streaming job %d completed in %lld ms",
+                                jobId, durationMs);
                         }
+
+                        return isFinished;
                     }
                     catch (const std::exception& e) {
-                        Logger::logError("[ModelManager] Exception in streaming thread: %s", e.what());
+                        Logger::logError("[ModelManager] Exception in streaming job: %s", e.what());
                         {
                             std::lock_guard<std::mutex> lock(ctx->mtx);
                             ctx->error = true;
                             ctx->errorMessage = e.what();
-                            ctx->finished = true;
                         }
-                        ctx->cv.notify_all();
+                        return true;
                     }
+                    };
 
-                    // Clean up job ID tracking
+                auto onDone = [this, model = request.model, jobId, ctx, admission, prefixLease, residency]() {
+                    // Finished, failed or cancelled: release whoever is waiting for the next chunk
                     {
-                        std::unique_lock<std::shared_mutex> lock(this->m_mutex);
-                        this->m_jobIds.erase(
-                            std::remove(this->m_jobIds.begin(), this->m_jobIds.end(), jobId),
-                            this->m_jobIds.end());
-                        m_activeJobs.erase(jobId);
+                        std::lock_guard<std::mutex> lock(ctx->mtx);
+                        ctx->finished = true;
+                        if (prefixLease && !ctx->error) prefixLease->complete();
                     }
-                    }).detach();
+                    ctx->cv.notify_all();
+
+                    // Let the next queued request for this model in
+                    admission->release();
+
+                    // Clean up job tracking
+                    m_jobRegistry.remove(model, jobId);
+                    };
+
+                JobPump::Handle handle = startStreamingPump(request.model, engine, jobId, std::move(step), std::move(onDone));
+                {
+                    std::lock_guard<std::mutex> lock(ctx->mtx);
+                    ctx->pumpHandle = handle;
+                }
             }
 
             if (chunkIndex == 0) {
@@ -1531,19 +1720,26 @@ namespace Model
             else {
                 // For chunkIndex > 0, wait for the (chunkIndex-1)-th text chunk or completion
                 std::unique_lock<std::mutex> lock(ctx->mtx);
+                ctx->lastPull = std::chrono::steady_clock::now();
 
                 // Wait with a timeout for better responsiveness
-                bool result = ctx->cv.wait_for(lock, std::chrono::seconds(30), [ctx, chunkIndex]() {
-                    return (ctx->chunks.size() >= static_cast<size_t>(chunkIndex)) ||
+                // A client blocked here is still reading, so the reaper leaves the stream alone
+                ++ctx->pullsWaiting;
+                bool result = ctx->cv.wait_for(lock, STREAM_CHUNK_TIMEOUT, [ctx, chunkIndex]() {
+                    return (ctx->chunks.pushedCount() >= static_cast<size_t>(chunkIndex)) ||
                         ctx->finished || ctx->error;
                     });
+                --ctx->pullsWaiting;
+                ctx->lastPull = std::chrono::steady_clock::now();
 
                 if (!result) {
                     // If we timed out
                     Logger::logError("[ModelManager] Timeout waiting for chunk %d for requestId %s",
                         chunkIndex, requestId.c_str());
 
-                    // Clean up and return error
+                    // Clean up, stop generating for nobody and return error
+                    lock.unlock();
+                    cancelJob(ctx->model, ctx->jobId);
                     std::unique_lock<std::mutex> glock(m_streamContextsMutex);
                     m_streamingContexts.erase(requestId);
                     return false;
@@ -1560,7 +1756,7 @@ namespace Model
                 }
 
                 // If job is finished but we don't have this chunk, send a final chunk
-                if (ctx->chunks.size() < static_cast<size_t>(chunkIndex) && ctx->finished) {
+                if (ctx->chunks.pushedCount() < static_cast<size_t>(chunkIndex) && ctx->finished) {
                     outputChunk.id = requestId;
                     outputChunk.model = ctx->model;
 
@@ -1581,8 +1777,9 @@ namespace Model
                     return false; // No more chunks to send
                 }
 
-                // Get the content for this chunk
-                std::string chunkContent = ctx->chunks[chunkIndex - 1];
+                // Take the content for this chunk; everything before it has been sent already
+                std::string chunkContent = ctx->chunks.take(chunkIndex - 1).value_or("");
+                if (ctx->pumpHandle) m_jobPump.wake(*ctx->pumpHandle);
                 outputChunk.id = requestId;
                 outputChunk.model = ctx->model;
 
@@ -1595,7 +1792,7 @@ namespace Model
                 outputChunk.choices.push_back(choice);
 
                 // Check if this is the last chunk
-                bool isLastChunk = ctx->finished && (ctx->chunks.size() == static_cast<size_t>(chunkIndex));
+                bool isLastChunk = ctx->finished && (ctx->chunks.pushedCount() == static_cast<size_t>(chunkIndex));
 
                 if (isLastChunk) {
                     // Set finish reason for the last content chunk
@@ -1622,12 +1819,25 @@ namespace Model
             int chunkIndex,
             CompletionChunk& outputChunk) {
 
-			if (m_inferenceEngines.find(request.model) == m_inferenceEngines.end()) {
+            // The first chunk loads the model on demand; the running job keeps it resident
+            std::shared_ptr<ResidencyManager::Pin> residency;
+            if (chunkIndex == 0) {
+                rejectIfServerQueueFull(request.model, "streaming completion", requestId);
+                residency = ensureModelResident(request.model);
+            }
+			if ((chunkIndex == 0 && !residency) ||
+                (chunkIndex > 0 && m_inferenceEngines.find(request.model) == m_inferenceEngines.end())) {
                 Logger::logError("[ModelManager] Model %s not loaded for streaming requestId: %s",
                     request.model.c_str(), requestId.c_str());
 				return false;
 			}
 
+            // Wait for a slot before creating any state, so rejected requests leave nothing behind
+            std::shared_ptr<AdmissionController::Ticket> admission;
+            if (chunkIndex == 0) {
+                admission = admitServerRequest(request.model, "streaming completion", requestId);
+            }
+
             // Get or create streaming context
             std::shared_ptr<CompletionStreamingContext> ctx;
             {
@@ -1687,108 +1897,95 @@ namespace Model
                     return false;
                 }
 
-                // Add job ID to global tracking
-                {
-                    std::unique_lock<std::shared_mutex> lock(m_mutex);
-                    m_jobIds.push_back(jobId);
-                    m_activeJobs[jobId] = true;
-                }
+                // Track the job so it can be cancelled
+                auto cancelToken = m_jobRegistry.add(request.model, jobId);
 
-                // Use thread pool instead of detached thread
-                std::thread([this, jobId, request, requestId, ctx]() {
-                    std::string lastText;
-                    auto startTime = std::chrono::steady_clock::now();
+                // Step the job on the shared streaming pump whenever the engine reports output
+                IInferenceEngine* engine = m_inferenceEngines.at(request.model);
+                auto cursor = std::make_shared<JobResultCursor>();
+                auto startTime = std::chrono::steady_clock::now();
 
+                auto step = [this, engine, jobId, ctx, cursor, startTime, cancelToken]() {
                     try {
-                        while (true) {
-                            // Check if job was stopped externally
+                        // Check if job was stopped externally
+                        if (!cancelToken->load(std::memory_order_acquire)) return true;
+
+                        // Check if the job has an error
+                        if (engine->hasJobError(jobId)) {
+                            std::string errorMsg = engine->getJobError(jobId);
+                            Logger::logError("[ModelManager] Streaming completion job error for jobId: %d - %s",
+                                jobId, errorMsg.c_str());
                             {
-                                std::shared_lock<std::shared_mutex> lock(m_mutex);
-                                auto it = m_activeJobs.find(jobId);
-                                if (it == m_activeJobs.end() || !it->second) {
-                                    std::lock_guard<std::mutex> ctxLock(ctx->mtx);
-                                    ctx->finished = true;
-                                    break;
-                                }
-                            }
-
-                            // Check if the job has an error
-                            if (this->m_inferenceEngines.at(request.model)->hasJobError(jobId)) {
-                                std::string errorMsg = this->m_inferenceEngines.at(request.model)->getJobError(jobId);
-                                Logger::logError("[ModelManager] Streaming completion job error for jobId: %d - %s",
-                                    jobId, errorMsg.c_str());
-                                {
-                                    std::lock_guard<std::mutex> lock(ctx->mtx);
-                                    ctx->error = true;
-                                    ctx->errorMessage = errorMsg;
-                                    ctx->finished = true;
-                                }
-                                ctx->cv.notify_all();
-                                break;
+                                std::lock_guard<std::mutex> lock(ctx->mtx);
+                                ctx->error = true;
+                                ctx->errorMessage = errorMsg;
                             }
+                            return true;
+                        }
 
-                            // Get the current result and check if finished
-                            CompletionResult partial = this->m_inferenceEngines.at(request.model)->getJobResult(jobId);
-                            bool isFinished = this->m_inferenceEngines.at(request.model)->isJobFinished(jobId);
+                        // Leave new output in the engine until the client catches up; taking a
+                        // chunk wakes this job again
+                        {
+                            std::lock_guard<std::mutex> lock(ctx->mtx);
+                            if (ctx->chunks.full()) return false;
+                        }
 
-                            // Compute delta text (only new text since last poll)
-                            std::string newText;
-                            if (partial.text.size() > lastText.size()) {
-                                newText = partial.text.substr(lastText.size());
-                                lastText = partial.text;
-                            }
+                        // Check if finished, then fetch only the text produced since the last read
+                        bool isFinished = engine->isJobFinished(jobId);
+                        CompletionResult delta = readJobResultSince(engine, jobId, *cursor);
 
-                            // If we have new text, add it to the chunks
-                            if (!newText.empty()) {
-                                {
-                                    std::lock_guard<std::mutex> lock(ctx->mtx);
-                                    ctx->fullText = lastText;
-                                    ctx->chunks.push_back(newText);
-                                }
-                                ctx->cv.notify_all();
+                        // If we have new text, add it to the chunks
+                        if (!delta.text.empty()) {
+                            {
+                                std::lock_guard<std::mutex> lock(ctx->mtx);
+                                ctx->chunks.push(std::move(delta.text));
+                                ctx->generatedTokens = cursor->tokenOffset;
                             }
+                            ctx->cv.notify_all();
+                        }
 
-                            // If the job is finished, set the finished flag and break
-                            if (isFinished) {
-                                auto endTime = std::chrono::steady_clock::now();
-                                auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                    endTime - startTime).count();
-
-                                Logger::logInfo("[ModelManager] Streaming completion job %d completed in %lld ms",
-                                    jobId, durationMs);
-
-                                {
-                                    std::lock_guard<std::mutex> lock(ctx->mtx);
-                                    ctx->finished = true;
-                                }
-                                ctx->cv.notify_all();
-                                break;
-                            }
+                        if (isFinished) {
+                            auto endTime = std::chrono::steady_clock::now();
+                            auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                endTime - startTime).count();
 
-                            // Sleep briefly to avoid busy-waiting
-                            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                            Logger::logInfo("[ModelManager] Streaming completion job %d completed in %lld ms",
+                                jobId, durationMs);
                         }
+
+                        return isFinished;
                     }
                     catch (const std::exception& e) {
-                        Logger::logError("[ModelManager] Exception in completion streaming thread: %s", e.what());
+                        Logger::logError("[ModelManager] Exception in completion streaming job: %s", e.what());
                         {
                             std::lock_guard<std::mutex> lock(ctx->mtx);
                             ctx->error = true;
                             ctx->errorMessage = e.what();
-                            ctx->finished = true;
                         }
-                        ctx->cv.notify_all();
+                        return true;
                     }
+                    };
 
-                    // Clean up job ID tracking
+                auto onDone = [this, model = request.model, jobId, ctx, admission, residency]() {
+                    // Finished, failed or cancelled: release whoever is waiting for the next chunk
                     {
-                        std::unique_lock<std::shared_mutex> lock(this->m_mutex);
-                        this->m_jobIds.erase(
-                            std::remove(this->m_jobIds.begin(), this->m_jobIds.end(), jobId),
-                            this->m_jobIds.end());
-                        m_activeJobs.erase(jobId);
+                        std::lock_guard<std::mutex> lock(ctx->mtx);
+                        ctx->finished = true;
                     }
-                    }).detach();
+                    ctx->cv.notify_all();
+
+                    // Let the next queued request for this model in
+                    admission->release();
+
+                    // Clean up job tracking
+                    m_jobRegistry.remove(model, jobId);
+                    };
+
+                JobPump::Handle handle = startStreamingPump(request.model, engine, jobId, std::move(step), std::move(onDone));
+                {
+                    std::lock_guard<std::mutex> lock(ctx->mtx);
+                    ctx->pumpHandle = handle;
+                }
             }
 
             // Prepare the chunk response
@@ -1809,19 +2006,26 @@ namespace Model
             // For subsequent chunks, wait for content
             else {
                 std::unique_lock<std::mutex> lock(ctx->mtx);
+                ctx->lastPull = std::chrono::steady_clock::now();
 
                 // Wait with timeout for the chunk to be available
-                bool result = ctx->cv.wait_for(lock, std::chrono::seconds(30), [ctx, chunkIndex]() {
-                    return (ctx->chunks.size() >= static_cast<size_t>(chunkIndex)) ||
+                // A client blocked here is still reading, so the reaper leaves the stream alone
+                ++ctx->pullsWaiting;
+                bool result = ctx->cv.wait_for(lock, STREAM_CHUNK_TIMEOUT, [ctx, chunkIndex]() {
+                    return (ctx->chunks.pushedCount() >= static_cast<size_t>(chunkIndex)) ||
                         ctx->finished || ctx->error;
                     });
+                --ctx->pullsWaiting;
+                ctx->lastPull = std::chrono::steady_clock::now();
 
                 if (!result) {
                     // Timeout occurred
                     Logger::logError("[ModelManager] Timeout waiting for completion chunk %d for requestId %s",
                         chunkIndex, requestId.c_str());
 
-                    // Keep the lock when we check if this is the last message
+                    // Stop generating for nobody, then drop the context
+                    lock.unlock();
+                    cancelJob(ctx->model, ctx->jobId);
                     std::unique_lock<std::mutex> glock(m_completionStreamContextsMutex);
                     m_completionStreamingContexts.erase(requestId);
                     return false;
@@ -1842,16 +2046,17 @@ namespace Model
                 choice.index = 0;
 
                 // Check for completion state while still holding the lock
-                bool hasChunk = ctx->chunks.size() >= static_cast<size_t>(chunkIndex);
+                bool hasChunk = ctx->chunks.pushedCount() >= static_cast<size_t>(chunkIndex);
                 bool isFinished = ctx->finished;
                 bool isLastChunk = false;
 
                 if (hasChunk) {
-                    // Get the content for this chunk while holding the lock
-                    choice.text = ctx->chunks[chunkIndex - 1];
+                    // Take the content for this chunk while holding the lock
+                    choice.text = ctx->chunks.take(chunkIndex - 1).value_or("");
+                    if (ctx->pumpHandle) m_jobPump.wake(*ctx->pumpHandle);
 
                     // Determine if this is the last chunk while safely protected by the lock
-                    isLastChunk = isFinished && (ctx->chunks.size() == static_cast<size_t>(chunkIndex));
+                    isLastChunk = isFinished && (ctx->chunks.pushedCount() == static_cast<size_t>(chunkIndex));
                     choice.finish_reason = isLastChunk ? "stop" : ""; // Use empty string instead of nullptr
                 }
                 else if (isFinished) {
@@ -1967,47 +2172,120 @@ namespace Model
             if (!variant)
                 return false;
             variant->cancelDownload = true;
+            if (m_downloadScheduler.remove(m_models[modelIndex].name, variantType) == DownloadScheduler::Status::QUEUED)
+            {
+                // Never started, so nothing will reset its progress
+                variant->downloadProgress = 0.0;
+            }
             return true;
         }
 
-        bool deleteDownloadedModel(size_t modelIndex, const std::string& variantType)
+        /**
+         * @brief Stops a download but keeps its place in the queue; resumeDownload continues
+         *        from the bytes already on disk.
+         */
+        bool pauseDownload(size_t modelIndex, const std::string& variantType)
         {
             std::unique_lock<std::shared_mutex> lock(m_mutex);
             if (modelIndex >= m_models.size())
                 return false;
-
             ModelVariant* variant = getVariantLocked(modelIndex, variantType);
             if (!variant)
                 return false;
 
-            lock.unlock();
-
-            if (modelIndex == m_currentModelIndex && variantType == m_currentVariantType)
+            switch (m_downloadScheduler.pause(m_models[modelIndex].name, variantType))
             {
-                unloadModel(m_models[modelIndex].name, variantType);
+            case DownloadScheduler::Status::RUNNING:
+                variant->cancelDownload = true;
+                return true;
+            case DownloadScheduler::Status::QUEUED:
+                variant->downloadProgress = 0.0;
+                return true;
+            default:
+                return false;
             }
+        }
 
-            // Call the persistence layer to delete the file - passing the variant type instead of the variant
-            m_persistence->deleteModelVariant(m_models[modelIndex], variantType);
+        bool resumeDownload(size_t modelIndex, const std::string& variantType)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            if (modelIndex >= m_models.size())
+                return false;
+            ModelVariant* variant = getVariantLocked(modelIndex, variantType);
+            if (!variant || variant->isDownloaded)
+                return false;
+
+            if (!m_downloadScheduler.resume(m_models[modelIndex].name, variantType))
+                return false;
+            variant->downloadProgress = std::max(variant->downloadProgress, 0.01);
             return true;
         }
 
-        void resetModelState() {
-            m_currentModelName = std::nullopt;
-            m_currentVariantType = "";
-            m_currentModelIndex = 0;
-            m_modelLoaded = false;
+        // Higher starts first; takes effect when a download slot frees up
+        bool setDownloadPriority(size_t modelIndex, const std::string& variantType, int priority)
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            if (modelIndex >= m_models.size())
+                return false;
+            return m_downloadScheduler.setPriority(m_models[modelIndex].name, variantType, priority);
         }
 
-        void cleanupFailedEngine(const std::string& modelId) {
-            auto it = m_inferenceEngines.find(modelId);
-            if (it != m_inferenceEngines.end()) {
-                // Release resources if the engine implementation requires it
-                if (it->second) {
-                    it->second->unloadModel();
+        void setDownloadOptions(const DownloadScheduler::Options& options)
+        {
+            m_downloadScheduler.setOptions(options);
+        }
+
+        DownloadScheduler::Options getDownloadOptions() const
+        {
+            return m_downloadScheduler.getOptions();
+        }
+
+        // Queued and running downloads, in the order they start
+        std::vector<DownloadScheduler::Entry> getDownloadQueue() const
+        {
+            return m_downloadScheduler.getEntries();
+        }
+
+        bool deleteDownloadedModel(size_t modelIndex, const std::string& variantType)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            if (modelIndex >= m_models.size())
+                return false;
+
+            ModelVariant* variant = getVariantLocked(modelIndex, variantType);
+            if (!variant)
+                return false;
+
+            lock.unlock();
+
+            if (modelIndex == m_currentModelIndex && variantType == m_currentVariantType)
+            {
+                unloadModel(m_models[modelIndex].name, variantType);
+            }
+
+            // Call the persistence layer to delete the file - passing the variant type instead of the variant
+            m_persistence->deleteModelVariant(m_models[modelIndex], variantType);
+            return true;
+        }
+
+        void resetModelState() {
+            m_currentModelName = std::nullopt;
+            m_currentVariantType = "";
+            m_currentModelIndex = 0;
+            m_modelLoaded = false;
+        }
+
+        void cleanupFailedEngine(const std::string& modelId) {
+            auto it = m_inferenceEngines.find(modelId);
+            if (it != m_inferenceEngines.end()) {
+                // Release resources if the engine implementation requires it
+                if (it->second) {
+                    it->second->unloadModel();
                 }
                 m_inferenceEngines.erase(it);
             }
+            m_admission.removeModel(modelId);
+            m_residency.onUnloaded(modelId);
         }
 
         bool retryModelLoad(const std::string& modelName, const std::string& variantType) {
@@ -2202,6 +2480,8 @@ namespace Model
 			, m_modelLoaded(false)
             , m_modelGenerationInProgress(false)
         {
+            m_persistence->setBandwidthLimiter(m_downloadScheduler.limiter());
+
             if (async)
             {
                 startAsyncInitialization();
@@ -2227,12 +2507,30 @@ namespace Model
 
         ~ModelManager()
         {
+            stopStreamReaper();
             stopAllJobs();
+            m_jobPump.shutdown();
+            // Before cancelling, so the interrupted downloads stay queued for the next start
+            m_downloadScheduler.stop();
             cancelAllDownloads();
+            m_downloadScheduler.wait();
+            {
+                // Lets the last queue save finish; the scheduler queues no more after wait()
+                std::unique_lock<std::mutex> lock(m_queueSaveMutex);
+                std::future<void> save = std::move(m_queueSaveFuture);
+                lock.unlock();
+                if (save.valid()) {
+                    save.wait();
+                }
+            }
 
             if (m_initializationFuture.valid()) {
                 m_initializationFuture.wait();
             }
+            m_stopHashChecks = true;
+            if (m_hashCheckFuture.valid()) {
+                m_hashCheckFuture.wait();
+            }
 
 			// Clean up all inference engines
             m_modelInServer.clear();
@@ -2361,12 +2659,17 @@ namespace Model
                 models.push_back(pair.second);
             }
 
-            // Check and fix each variant's download status.
+            // Check and fix each variant's download status. Files that have a checksum
+            // are only counted as downloaded once it has been verified.
+            std::vector<PendingHashCheck> hashChecks;
             for (auto& model : models)
             {
                 for (auto& [type, variant] : model.variants)
                 {
-                    checkAndFixDownloadStatus(variant);
+                    if (checkAndFixDownloadStatus(variant))
+                    {
+                        hashChecks.push_back({ model.name, type, variant.path, variant.sha256 });
+                    }
                 }
             }
 
@@ -2446,9 +2749,86 @@ namespace Model
                     m_currentModelIndex = 0;
                 }
             }
+
+            restoreDownloadQueue();
+
+            if (!hashChecks.empty())
+            {
+                m_hashCheckFuture = std::async(std::launch::async, [this, checks = std::move(hashChecks)]() {
+                    verifyFoundFiles(checks);
+                });
+            }
+        }
+
+        // Saves the download queue on a background thread. Saves run one at a time and
+        // only the newest state waiting is written, so the file never goes back in time.
+        void saveDownloadQueueLater(const DownloadQueueState& state)
+        {
+            std::lock_guard<std::mutex> lock(m_queueSaveMutex);
+            m_pendingQueueSave = state;
+            if (m_queueSaveRunning)
+                return;
+
+            m_queueSaveRunning = true;
+            m_queueSaveFuture = std::async(std::launch::async, [this]() {
+                while (true)
+                {
+                    DownloadQueueState next;
+                    {
+                        std::lock_guard<std::mutex> lock(m_queueSaveMutex);
+                        if (!m_pendingQueueSave.has_value())
+                        {
+                            m_queueSaveRunning = false;
+                            return;
+                        }
+                        next = std::move(*m_pendingQueueSave);
+                        m_pendingQueueSave.reset();
+                    }
+                    m_persistence->saveDownloadQueue(next).get();
+                }
+            });
+        }
+
+        // Requeues the downloads that were pending when the app last exited
+        void restoreDownloadQueue()
+        {
+            auto saved = m_persistence->loadDownloadQueue().get();
+            if (!saved.has_value())
+                return;
+
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            DownloadQueueState state;
+            state.options = saved->options;
+            for (const auto& download : saved->downloads)
+            {
+                auto it = m_modelNameToIndex.find(download.modelName);
+                if (it == m_modelNameToIndex.end())
+                    continue;
+                ModelVariant* variant = getVariantLocked(it->second, download.variantType);
+                if (!variant || variant->isDownloaded)
+                    continue;
+
+                if (!download.paused)
+                {
+                    variant->downloadProgress = 0.01;  // 0% looks like no progress
+                }
+                state.downloads.push_back(download);
+            }
+            m_downloadScheduler.restore(state);
         }
 
-        void checkAndFixDownloadStatus(ModelVariant& variant) 
+        // A file that turned up at a variant's path without being marked downloaded
+        struct PendingHashCheck
+        {
+            std::string modelName;
+            std::string variantType;
+            std::string path;
+            std::string sha256;
+        };
+
+        // Returns true if the variant's file exists but has to match variant.sha256 before
+        // the variant counts as downloaded; the variant is left not downloaded meanwhile.
+        bool checkAndFixDownloadStatus(ModelVariant& variant) 
         {
             if (variant.isDownloaded) 
             {
@@ -2460,15 +2840,77 @@ namespace Model
                     variant.downloadProgress = 0.0;
                 }
 
-                return;
+                return false;
             }
             
             // if variant is not downloaded, but file exists, set isDownloaded to true
             if (std::filesystem::exists(variant.path)) 
             {
+                if (!variant.sha256.empty())
+                {
+                    return true;
+                }
                 variant.isDownloaded = true;
                 variant.downloadProgress = 100.0;
             }
+            return false;
+        }
+
+        // Hashes each found file off the caller's thread and marks the variants whose
+        // checksum matches as downloaded. Mismatches stay not downloaded.
+        void verifyFoundFiles(const std::vector<PendingHashCheck>& checks)
+        {
+            for (const auto& check : checks)
+            {
+                const std::optional<std::string> actual = sha256OfFile(check.path);
+                if (m_stopHashChecks)
+                {
+                    return;
+                }
+                if (!actual || *actual != check.sha256)
+                {
+                    std::cerr << "[ModelManager] Ignoring " << check.path << ": "
+                        << (actual ? "SHA-256 does not match" : "could not be read") << "\n";
+                    continue;
+                }
+
+                std::unique_lock<std::shared_mutex> lock(m_mutex);
+                auto it = m_modelNameToIndex.find(check.modelName);
+                if (it == m_modelNameToIndex.end())
+                    continue;
+                ModelVariant* variant = getVariantLocked(it->second, check.variantType);
+                if (variant && !variant->isDownloaded && variant->path == check.path)
+                {
+                    variant->isDownloaded = true;
+                    variant->downloadProgress = 100.0;
+                }
+            }
+        }
+
+        // Lowercase hex SHA-256 of a file, or nullopt if it can't be read or hashing is stopped
+        std::optional<std::string> sha256OfFile(const std::string& path) const
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                return std::nullopt;
+            }
+
+            Crypto::Sha256 hasher;
+            std::vector<char> buffer(1 << 20);
+            while (!m_stopHashChecks)
+            {
+                file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                if (file.gcount() > 0)
+                {
+                    hasher.update(buffer.data(), static_cast<size_t>(file.gcount()));
+                }
+                if (!file)
+                {
+                    return file.eof() ? std::optional<std::string>(hasher.finishHex()) : std::nullopt;
+                }
+            }
+            return std::nullopt;
         }
 
         void startDownloadAsyncLocked(size_t modelIndex, const std::string& variantType)
@@ -2480,48 +2922,88 @@ namespace Model
             if (!variant)
                 return;
 
-			const std::string modelName = m_models[modelIndex].name;
-
             variant->downloadProgress = 0.01f;  // 0% looks like no progress
 
-            // Begin the asynchronous download - passing the variant type rather than the variant itself
-            auto downloadFuture = m_persistence->downloadModelVariant(m_models[modelIndex], variantType);
+            // The model being switched to jumps the queue; others wait their turn
+            const bool selected = m_currentModelIndex == modelIndex && m_currentVariantType == variantType;
+            m_downloadScheduler.enqueue(m_models[modelIndex].name, variantType,
+                selected ? DownloadScheduler::PRIORITY_SELECTED : 0);
+        }
 
-            // Chain a continuation that waits for the download to complete.
-            m_downloadFutures.emplace_back(std::async(std::launch::async,
-                [this, modelIndex, modelName, variantType, fut = std::move(downloadFuture)]() mutable {
-                    // Wait for the download to finish.
-                    fut.wait();
+        /**
+         * @brief Runs one queued download on a scheduler thread, then loads the model if it
+         *        is still the current selection.
+         * @return True if the variant is on disk.
+         */
+        bool runQueuedDownload(const QueuedDownload& download)
+        {
+            const std::string& modelName = download.modelName;
+            const std::string& variantType = download.variantType;
 
-                    // After download, check if this model variant is still the current selection.
-                    {
-                        std::unique_lock<std::shared_mutex> lock(m_mutex);
-                        if (m_currentModelIndex == modelIndex && m_currentVariantType == variantType)
-                        {
-                            // Unlock before loading the model.
-                            lock.unlock();
+            size_t modelIndex = 0;
+            std::future<void> downloadFuture;
+            {
+                std::unique_lock<std::shared_mutex> lock(m_mutex);
+                auto it = m_modelNameToIndex.find(modelName);
+                if (it == m_modelNameToIndex.end())
+                    return false;
+                modelIndex = it->second;
 
-                            auto loadFuture = loadModelIntoEngineAsync(modelName + ":" + variantType);
-                            if (!loadFuture.get())
-                            {
-                                std::unique_lock<std::shared_mutex> restoreLock(m_mutex);
-                                resetModelState();
+                ModelVariant* variant = getVariantLocked(modelIndex, variantType);
+                if (!variant)
+                    return false;
+                if (variant->isDownloaded)
+                    return true;
+                // Paused or cancelled between being dispatched and getting here
+                if (!m_downloadScheduler.isWanted(modelName, variantType))
+                    return false;
 
-                                std::cerr << "[ModelManager] Failed to load model after download completion.\n";
-                            }
-                        }
-                    }
+                downloadFuture = m_persistence->downloadModelVariant(m_models[modelIndex], variantType);
+            }
+
+            // Wait for the download to finish.
+            downloadFuture.wait();
+
+            // After download, check if this model variant is still the current selection.
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            // A cancelled, paused, failed or corrupt download leaves nothing to load
+            ModelVariant* downloaded = getVariantLocked(modelIndex, variantType);
+            if (!downloaded || !downloaded->isDownloaded)
+            {
+                std::cerr << "[ModelManager] Download of " << modelName << ":" << variantType << " did not complete\n";
+                if (m_currentModelIndex == modelIndex && m_currentVariantType == variantType)
+                {
+                    resetModelState();
                 }
-            ));
+                return false;
+            }
 
-            // Add cleanup after adding new future
-            m_downloadFutures.erase(
-                std::remove_if(m_downloadFutures.begin(), m_downloadFutures.end(),
-                    [](auto& future) {
-                        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
-                    }),
-                m_downloadFutures.end()
-            );
+            if (m_currentModelIndex == modelIndex && m_currentVariantType == variantType)
+            {
+                // Load on its own thread, so the download slot frees up right away
+                m_downloadFutures.emplace_back(std::async(std::launch::async,
+                    [this, modelId = modelName + ":" + variantType]() {
+                        auto loadFuture = loadModelIntoEngineAsync(modelId);
+                        if (!loadFuture.get())
+                        {
+                            std::unique_lock<std::shared_mutex> restoreLock(m_mutex);
+                            resetModelState();
+
+                            std::cerr << "[ModelManager] Failed to load model after download completion.\n";
+                        }
+                    }
+                ));
+
+                // Add cleanup after adding new future
+                m_downloadFutures.erase(
+                    std::remove_if(m_downloadFutures.begin(), m_downloadFutures.end(),
+                        [](auto& future) {
+                            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                        }),
+                    m_downloadFutures.end()
+                );
+            }
+            return true;
         }
 
         bool useVulkanBackend() const
@@ -2754,6 +3236,11 @@ namespace Model
                 return false;
             }
 
+            // Optional: push notifications for new tokens. Older DLLs don't export this
+            // and are polled by the job notifier instead.
+            m_jobNotifier.setExtensionResolver((GetInferenceEngineStreamingExtFunc*)
+                GetProcAddress(m_inferenceLibHandle, "getInferenceEngineStreamingExt"));
+
 #ifdef DEBUG
 			std::cout << "[ModelManager] Successfully loaded inference engine from: "
 				<< backendName << std::endl;
@@ -2798,10 +3285,11 @@ namespace Model
 
             std::optional<std::string> modelDir;
             Model::ModelVariant* variant;
+            size_t estimatedBytes = 0;
             {
                 std::shared_lock lock(m_mutex);
                 int index = m_modelNameToIndex[modelName];
-                variant = getVariantLocked(index, getCurrentVariantForModel(modelName));
+                variant = getVariantLocked(index, modelVariant);
                 if (!variant || !variant->isDownloaded) {
 					std::cout << "[ModelManager] Model not downloaded or variant not found\n";
                     std::promise<bool> promise;
@@ -2811,9 +3299,10 @@ namespace Model
 
                 modelDir = std::filesystem::absolute(
                     variant->path.substr(0, variant->path.find_last_of("/\\"))).string();
+                estimatedBytes = estimateModelMemoryLocked(index, modelVariant);
             }
 
-            return std::async(std::launch::async, [this, modelName = modelName, variantName = variant->type, modelDir]() {
+            return std::async(std::launch::async, [this, modelName = modelName, variantName = variant->type, modelDir, estimatedBytes]() {
 				std::cout << "[ModelManager] size of inference engines: " << sizeof(m_inferenceEngines) << std::endl;
 
                 auto engine = m_createInferenceEnginePtr();
@@ -2829,6 +3318,9 @@ namespace Model
                     if (success) {
                         std::unique_lock lock(m_mutex);
                         m_inferenceEngines[modelName + ":" + variantName] = engine;
+                        m_admission.setConcurrency(modelName + ":" + variantName,
+                            ModelLoaderConfigManager::getInstance().getParallelCount());
+                        m_residency.onLoaded(modelName + ":" + variantName, estimatedBytes);
                         std::cout << "[ModelManager] size of inference engines: " << sizeof(m_inferenceEngines) << std::endl;
                         m_modelLoaded = true;
                     }
@@ -2867,6 +3359,8 @@ namespace Model
 					// delete the engine instance
 					m_destroyInferenceEnginePtr(m_inferenceEngines.at(modelId));
 					m_inferenceEngines.erase(modelId);
+                    m_admission.removeModel(modelId);
+                    m_residency.onUnloaded(modelId);
 
                     {
                         std::unique_lock<std::shared_mutex> lock(m_mutex);
@@ -2912,6 +3406,8 @@ namespace Model
                     // delete the engine instance
                     m_destroyInferenceEnginePtr(m_inferenceEngines.at(modelId));
                     m_inferenceEngines.erase(modelId);
+                    m_admission.removeModel(modelId);
+                    m_residency.onUnloaded(modelId);
 
                     {
                         std::unique_lock<std::shared_mutex> lock(m_mutex);
@@ -2935,21 +3431,501 @@ namespace Model
                 });
         }
 
-        void stopAllJobs()
+        size_t estimateModelMemoryLocked(size_t modelIndex, const std::string& variantType) const
+        {
+            const ModelVariant* variant = getVariantLocked(modelIndex, variantType);
+            if (!variant) {
+                return 0;
+            }
+
+            // Same estimate as hasEnoughMemoryForModel: weights plus a full-context KV cache
+            const auto& model = m_models[modelIndex];
+            const size_t modelSizeBytes = static_cast<size_t>(variant->size * 1024 * 1024 * 1024);
+            const size_t kvCacheSizeBytes = static_cast<size_t>(4 *
+                model.hidden_size *
+                model.hidden_layers *
+                ModelLoaderConfigManager::getInstance().getConfig().n_ctx);
+
+            return modelSizeBytes + kvCacheSizeBytes;
+        }
+
+        size_t effectiveResidencyBudget()
+        {
+            size_t budget = m_residency.getBudget();
+            if (budget > 0) {
+                return budget;
+            }
+
+            // Keep the same headroom SystemMonitor::hasEnoughMemoryForModel assumes
+            auto& sysMonitor = SystemMonitor::getInstance();
+            if (sysMonitor.hasGpuSupport()) {
+                size_t total = sysMonitor.getTotalGpuMemory();
+                return total > GB ? total - GB : total;
+            }
+            size_t total = sysMonitor.getTotalSystemMemory();
+            return total > 2 * GB ? total - 2 * GB : total;
+        }
+
+        // Returns a chat's KV cache file to the chat store once the last copy is dropped.
+        std::shared_ptr<void> leaseChatKvCache(const std::string& kvCacheFilePath)
         {
-            std::vector<int> jobs;
+            if (kvCacheFilePath.empty())
             {
-                std::shared_lock lock(m_mutex);
-                jobs = m_jobIds;
+                return nullptr;
+            }
+            return std::shared_ptr<void>(nullptr, [kvCacheFilePath](void*) {
+                Chat::ChatManager::getInstance().releaseKvChatPath(kvCacheFilePath);
+                });
+        }
 
-                for (int id : jobs) {
-                    m_activeJobs[id] = false; // Mark jobs as inactive
+        void logResidency()
+        {
+            auto models = m_residency.snapshot();
+            Logger::logInfo("[ModelManager] Residency: %zu models, %zu of %zu MB, %llu evictions",
+                models.size(), m_residency.residentBytes() / (1024 * 1024), effectiveResidencyBudget() / (1024 * 1024),
+                static_cast<unsigned long long>(m_residency.evictionCount()));
+            for (const auto& model : models) {
+                Logger::logInfo("[ModelManager]   %s: %zu MB, %d in flight%s",
+                    model.modelId.c_str(), model.estimatedBytes / (1024 * 1024), model.inFlight,
+                    model.evicting ? ", evicting" : "");
+            }
+        }
+
+        // Unloads one server-side model for ensureModelResident. Unlike unloadModelAsync, the
+        // engine leaves m_inferenceEngines under m_mutex, and m_modelLoaded is left alone
+        // since it describes the desktop chat's model, which is never a victim. Returns
+        // whether the engine was removed.
+        bool evictModel(const std::string& modelId)
+        {
+            IInferenceEngine* engine = nullptr;
+            {
+                std::unique_lock<std::shared_mutex> lock(m_mutex);
+                auto it = m_inferenceEngines.find(modelId);
+                if (it == m_inferenceEngines.end()) {
+                    return false;
                 }
+                engine = it->second;
+                m_inferenceEngines.erase(it);
             }
+            m_admission.removeModel(modelId);
 
-            for (int id : jobs) {
-                for (auto& [name, engine] : m_inferenceEngines)
-                    engine->stopJob(id);
+            // The heavy part runs without the lock; nothing can reach the engine any more
+            try {
+                if (!engine->unloadModel()) {
+                    Logger::logError("[ModelManager] Unload operation failed while evicting model %s", modelId.c_str());
+                }
+            }
+            catch (const std::exception& e) {
+                Logger::logError("[ModelManager] Error evicting model %s: %s", modelId.c_str(), e.what());
+            }
+            m_destroyInferenceEnginePtr(engine);
+            return true;
+        }
+
+        // Returns a pin that keeps the model loaded, loading it first if needed. Idle
+        // models are evicted least recently used first to fit within the residency budget.
+        std::shared_ptr<ResidencyManager::Pin> ensureModelResident(const std::string& modelId)
+        {
+            if (auto pin = m_residency.pin(modelId)) {
+                return pin;
+            }
+
+            // One on-demand load at a time, so concurrent requests load a model only once
+            std::lock_guard<std::mutex> residencyLock(m_residencyMutex);
+            if (auto pin = m_residency.pin(modelId)) {
+                return pin;
+            }
+
+            std::string::size_type pos = modelId.find(':');
+            if (pos == std::string::npos) {
+                return nullptr;
+            }
+
+            size_t requiredBytes = 0;
+            std::vector<std::string> protectedIds;
+            {
+                std::shared_lock<std::shared_mutex> lock(m_mutex);
+                auto it = m_modelNameToIndex.find(modelId.substr(0, pos));
+                if (it == m_modelNameToIndex.end()) {
+                    return nullptr;
+                }
+                const ModelVariant* variant = getVariantLocked(it->second, modelId.substr(pos + 1));
+                if (!variant || !variant->isDownloaded) {
+                    return nullptr;
+                }
+                if (m_loadInProgress == modelId) {
+                    Logger::logError("[ModelManager] Model %s is already being loaded", modelId.c_str());
+                    return nullptr;
+                }
+
+                requiredBytes = estimateModelMemoryLocked(it->second, modelId.substr(pos + 1));
+
+                // Never pull the model out from under the desktop chat
+                if (m_currentModelName.has_value()) {
+                    protectedIds.push_back(m_currentModelName.value());
+                }
+            }
+
+            std::vector<std::string> victims;
+            if (!m_residency.reserveVictims(requiredBytes, effectiveResidencyBudget(), protectedIds, victims)) {
+                Logger::logError("[ModelManager] Cannot make room for model %s (%zu MB): remaining models are busy",
+                    modelId.c_str(), requiredBytes / (1024 * 1024));
+                return nullptr;
+            }
+
+            for (const auto& victim : victims) {
+                Logger::logInfo("[ModelManager] Evicting idle model %s to make room for %s",
+                    victim.c_str(), modelId.c_str());
+                {
+                    std::unique_lock<std::shared_mutex> lock(m_mutex);
+                    m_modelInServer.erase(victim);
+                }
+
+                m_residency.finishEviction(victim, evictModel(victim));
+            }
+
+            Logger::logInfo("[ModelManager] Loading model %s on demand", modelId.c_str());
+            bool loaded = false;
+            try {
+                loaded = loadModelIntoEngineAsync(modelId).get();
+            }
+            catch (const std::exception& e) {
+                Logger::logError("[ModelManager] Error loading model %s: %s", modelId.c_str(), e.what());
+            }
+
+            logResidency();
+            return loaded ? m_residency.pin(modelId) : nullptr;
+        }
+
+        // Points the request at a prefix cache file seeded from the longest matching
+        // conversation prefix. The lease must stay alive until the job has finished.
+        std::shared_ptr<PrefixKvCache::Lease> acquirePrefixCache(const std::string& modelId, ChatCompletionParameters& params)
+        {
+            auto lease = m_prefixCache.acquire(modelId, params.messages);
+            if (!lease) {
+                return nullptr;
+            }
+
+            params.kvCacheFilePath = lease->path();
+
+            PrefixKvCache::Stats stats = m_prefixCache.getStats();
+            Logger::logInfo("[ModelManager] Prefix cache %s for model %s: reused %zu of %zu messages (hits %llu, misses %llu, %zu entries)",
+                lease->matchedMessages() > 0 ? "hit" : "miss", modelId.c_str(), lease->matchedMessages(), params.messages.size(),
+                static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses), stats.entries);
+
+            return lease;
+        }
+
+        // The ServerAPI callbacks have no way to return a status code, so a rejected request
+        // gets the same empty response (or false, when streaming) as an unloaded model.
+        // The status is logged so overload can still be told apart from other failures.
+        static void logAdmissionRejected(const char* kind, const std::string& requestId, const AdmissionRejectedError& error)
+        {
+            Logger::logError("[ModelManager] %s request %s turned away with status %d: %s",
+                kind, requestId.c_str(), error.statusCode(), error.what());
+        }
+
+        // Throws a 429 before the caller loads the model or evicts another for a request
+        // whose queue is already full; admitServerRequest makes the final decision.
+        void rejectIfServerQueueFull(const std::string& modelId, const char* kind, const std::string& requestId = "")
+        {
+            if (!m_admission.rejectIfQueueFull(modelId)) {
+                return;
+            }
+
+            AdmissionController::ModelStats stats = m_admission.getStats(modelId);
+            Logger::logError("[ModelManager] Rejected %s request %s for model %s: queue full (running %d/%d, queued %zu)",
+                kind, requestId.c_str(), modelId.c_str(), stats.running, stats.concurrency, stats.queued);
+            throw AdmissionRejectedError(429, std::string("Model ") + modelId + " is overloaded, retry later");
+        }
+
+        // Waits for a server slot on the model; throws AdmissionRejectedError (429 or 503)
+        // when the request has to be turned away.
+        std::shared_ptr<AdmissionController::Ticket> admitServerRequest(const std::string& modelId,
+            const char* kind, const std::string& requestId = "")
+        {
+            AdmissionController::Result admission = m_admission.acquire(modelId);
+            AdmissionController::ModelStats stats = m_admission.getStats(modelId);
+
+            if (!admission.admitted()) {
+                Logger::logError("[ModelManager] Rejected %s request %s for model %s: %s after %lld ms in queue (running %d/%d, queued %zu)",
+                    kind, requestId.c_str(), modelId.c_str(), AdmissionController::statusToString(admission.status),
+                    static_cast<long long>(admission.queueWait.count()), stats.running, stats.concurrency, stats.queued);
+
+                const int statusCode = admission.status == AdmissionController::Status::ModelUnavailable ? 503 : 429;
+                throw AdmissionRejectedError(statusCode, std::string("Model ") + modelId + " is " +
+                    (statusCode == 429 ? "overloaded, retry later" : "no longer available"));
+            }
+
+            Logger::logInfo("[ModelManager] Admitted %s request %s for model %s after %lld ms in queue (running %d/%d, queued %zu)",
+                kind, requestId.c_str(), modelId.c_str(), static_cast<long long>(admission.queueWait.count()),
+                stats.running, stats.concurrency, stats.queued);
+
+            return admission.ticket;
+        }
+
+        /**
+         * @brief Submits jobs as separate sequences on one engine so continuous batching
+         *        can decode them together, and returns their results in submission order.
+         *
+         * The caller's admission ticket covers one sequence. Each further sequence in
+         * flight takes a slot of its own, but only if one is free right away, so a fan-out
+         * never pushes the model past n_parallel nor waits on slots other requests hold.
+         * Throws if any sequence fails; the ones still running are stopped first.
+         */
+        template <typename Params, typename SubmitFn>
+        std::vector<CompletionResult> runJobsInParallel(const std::string& modelId,
+            const std::vector<Params>& jobs, SubmitFn submit)
+        {
+            IInferenceEngine* engine = nullptr;
+            {
+                std::shared_lock<std::shared_mutex> lock(m_mutex);
+                auto it = m_inferenceEngines.find(modelId);
+                if (it != m_inferenceEngines.end()) {
+                    engine = it->second;
+                }
+            }
+            if (!engine) {
+                throw std::runtime_error("Model " + modelId + " is not loaded");
+            }
+
+            std::vector<CompletionResult> results(jobs.size());
+            std::string error;
+
+            auto collect = [this, &modelId, engine, &results, &error](size_t index, int jobId) {
+                engine->waitForJob(jobId);
+                if (engine->hasJobError(jobId)) {
+                    const std::string jobError = engine->getJobError(jobId);
+                    Logger::logError("[ModelManager] Error in parallel job %d: %s", jobId, jobError.c_str());
+                    if (error.empty()) {
+                        error = jobError;
+                    }
+                }
+                else {
+                    results[index] = engine->getJobResult(jobId);
+                }
+                m_jobRegistry.remove(modelId, jobId);
+                };
+
+            auto startTime = std::chrono::steady_clock::now();
+            std::vector<std::shared_ptr<AdmissionController::Ticket>> extraSlots;
+            size_t peakInFlight = 0;
+            std::deque<std::pair<size_t, int>> inFlight;
+            for (size_t i = 0; i < jobs.size() && error.empty(); ++i) {
+                if (inFlight.size() >= 1 + extraSlots.size()) {
+                    if (auto slot = m_admission.tryAcquire(modelId)) {
+                        extraSlots.push_back(std::move(slot));
+                    }
+                    else {
+                        collect(inFlight.front().first, inFlight.front().second);
+                        inFlight.pop_front();
+                        if (!error.empty()) {
+                            break;
+                        }
+                    }
+                }
+
+                int jobId = submit(engine, jobs[i]);
+                if (jobId < 0) {
+                    Logger::logError("[ModelManager] Failed to submit parallel job %zu of %zu", i + 1, jobs.size());
+                    error = "failed to submit sequence " + std::to_string(i + 1) + " of " + std::to_string(jobs.size());
+                    break;
+                }
+                m_jobRegistry.add(modelId, jobId);
+                inFlight.emplace_back(i, jobId);
+                peakInFlight = std::max(peakInFlight, inFlight.size());
+            }
+
+            // After a failure the remaining sequences are useless; stop them before waiting
+            if (!error.empty()) {
+                for (const auto& [index, jobId] : inFlight) {
+                    engine->stopJob(jobId);
+                }
+            }
+            while (!inFlight.empty()) {
+                collect(inFlight.front().first, inFlight.front().second);
+                inFlight.pop_front();
+                // Hand back slots as soon as the tail no longer needs them
+                if (extraSlots.size() > inFlight.size()) {
+                    extraSlots.pop_back();
+                }
+            }
+
+            if (!error.empty()) {
+                throw std::runtime_error("Model " + modelId + " failed to generate all choices: " + error);
+            }
+
+            auto durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - startTime).count();
+            Logger::logInfo("[ModelManager] Ran %zu parallel sequences (up to %zu at once) on model %s in %lld ms",
+                jobs.size(), peakInFlight, modelId.c_str(), static_cast<long long>(durationMs));
+
+            return results;
+        }
+
+        // Marks the job cancelled, stops it in the engine and runs its pump cleanup now
+        // rather than on its next engine update.
+        void cancelJob(const std::string& modelId, int jobId)
+        {
+            if (jobId < 0) {
+                return;
+            }
+
+            std::optional<JobPump::Handle> pumpHandle = m_jobRegistry.cancel(modelId, jobId);
+            {
+                std::shared_lock<std::shared_mutex> lock(m_mutex);
+                auto it = m_inferenceEngines.find(modelId);
+                if (it != m_inferenceEngines.end() && it->second) {
+                    it->second->stopJob(jobId);
+                }
+            }
+
+            if (pumpHandle) {
+                m_jobPump.cancel(*pumpHandle);
+            }
+        }
+
+        template <typename Context>
+        void collectStreamingBufferStats(std::mutex& contextsMutex,
+            const std::unordered_map<std::string, std::shared_ptr<Context>>& contexts, StreamingBufferStats& stats)
+        {
+            std::vector<std::shared_ptr<Context>> snapshot;
+            {
+                std::lock_guard<std::mutex> lock(contextsMutex);
+                for (const auto& [requestId, ctx] : contexts) {
+                    snapshot.push_back(ctx);
+                }
+            }
+
+            for (const auto& ctx : snapshot) {
+                std::lock_guard<std::mutex> lock(ctx->mtx);
+                ++stats.streams;
+                stats.bufferedChunks += ctx->chunks.bufferedChunks();
+                stats.bufferedBytes += ctx->chunks.bufferedBytes();
+            }
+        }
+
+        void startStreamReaper()
+        {
+            std::lock_guard<std::mutex> lock(m_reaperMutex);
+            if (m_reaperThread.joinable()) {
+                return;
+            }
+            m_reaperStop = false;
+            m_reaperThread = std::thread(&ModelManager::streamReaperLoop, this);
+        }
+
+        void stopStreamReaper()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_reaperMutex);
+                m_reaperStop = true;
+            }
+            m_reaperCv.notify_all();
+            if (m_reaperThread.joinable()) {
+                m_reaperThread.join();
+            }
+        }
+
+        void streamReaperLoop()
+        {
+            std::unique_lock<std::mutex> lock(m_reaperMutex);
+            while (!m_reaperCv.wait_for(lock, STREAM_REAPER_INTERVAL, [this]() { return m_reaperStop; })) {
+                lock.unlock();
+                reapAbandonedStreams(m_streamContextsMutex, m_streamingContexts);
+                reapAbandonedStreams(m_completionStreamContextsMutex, m_completionStreamingContexts);
+                lock.lock();
+            }
+        }
+
+        // Drops contexts whose client stopped pulling chunks and cancels their jobs
+        template <typename Context>
+        void reapAbandonedStreams(std::mutex& contextsMutex,
+            std::unordered_map<std::string, std::shared_ptr<Context>>& contexts)
+        {
+            const std::chrono::milliseconds idleTimeout(m_streamIdleTimeoutMs.load());
+            for (const auto& [requestId, ctx] : StreamReaper::takeIdle(contextsMutex, contexts, idleTimeout)) {
+                cancelStream(requestId, *ctx, "client stopped reading");
+            }
+        }
+
+        // Stops a stream nobody is reading anymore: fails any pending chunk wait, cancels
+        // the engine job and counts the tokens that were generated for nothing.
+        template <typename Context>
+        void cancelStream(const std::string& requestId, Context& ctx, const char* reason)
+        {
+            std::optional<CancelledStream> cancelled = StreamReaper::cancel(ctx, reason);
+            if (!cancelled) {
+                return;
+            }
+
+            cancelJob(cancelled->model, cancelled->jobId);
+            m_cancelledStreams.fetch_add(1, std::memory_order_relaxed);
+            m_cancelledStreamTokens.fetch_add(cancelled->generatedTokens, std::memory_order_relaxed);
+
+            Logger::logInfo("[ModelManager] Cancelled stream %s (job %d) after %zu tokens: %s",
+                requestId.c_str(), cancelled->jobId, cancelled->generatedTokens, reason);
+        }
+
+        JobPump::Handle startStreamingPump(const std::string& modelId, IInferenceEngine* engine, int jobId, JobPump::StepFn step, JobPump::DoneFn onDone)
+        {
+            JobPump::Handle handle = m_jobPump.add(std::move(step),
+                [this, engine, jobId, onDone = std::move(onDone)]() {
+                    m_jobNotifier.unsubscribe(engine, jobId);
+                    if (onDone) onDone();
+                });
+
+            m_jobRegistry.setPumpHandle(modelId, jobId, handle);
+
+            m_jobNotifier.subscribe(engine, jobId, [this, handle]() { m_jobPump.wake(handle); });
+            m_jobPump.wake(handle);
+            return handle;
+        }
+
+        CompletionResult readJobResultSince(IInferenceEngine* engine, int jobId, JobResultCursor& cursor)
+        {
+            CompletionResult delta;
+            delta.tps = 0.0F;
+
+            if (auto* ext = m_jobNotifier.extensionFor(engine))
+            {
+                if (!ext->getJobResultSince(jobId, cursor.tokenOffset, cursor.textOffset, delta))
+                {
+                    return delta;
+                }
+            }
+            else
+            {
+                // Engines without the extension, including the InferenceEngineLib that ships
+                // today, only expose the full result. Each step still copies the whole output
+                // out of the engine, so streaming a job stays quadratic in its length until
+                // the engine implements getJobResultSince; only the slicing below is ours.
+                CompletionResult full = engine->getJobResult(jobId);
+                if (full.tokens.size() > cursor.tokenOffset)
+                {
+                    delta.tokens.assign(full.tokens.begin() + cursor.tokenOffset, full.tokens.end());
+                }
+                if (full.text.size() > cursor.textOffset)
+                {
+                    delta.text = full.text.substr(cursor.textOffset);
+                }
+                delta.tps = full.tps;
+            }
+
+            cursor.tokenOffset += delta.tokens.size();
+            cursor.textOffset  += delta.text.size();
+            return delta;
+        }
+
+        void stopAllJobs()
+        {
+            // Mark jobs as inactive
+            std::vector<JobKey> jobs = m_jobRegistry.cancelAll();
+
+            for (const auto& job : jobs) {
+                auto it = m_inferenceEngines.find(job.modelId);
+                if (it != m_inferenceEngines.end() && it->second)
+                    it->second->stopJob(job.jobId);
             }
         }
 
@@ -2967,22 +3943,33 @@ namespace Model
 
         static ChatCompletionResponse convertToChatResponse(
             const ChatCompletionRequest& request, const CompletionResult& result)
+        {
+            return convertToChatResponse(request, std::vector<CompletionResult>{ result });
+        }
+
+        static ChatCompletionResponse convertToChatResponse(
+            const ChatCompletionRequest& request, const std::vector<CompletionResult>& results)
         {
             ChatCompletionResponse response;
             response.model = request.model;
 
-            ChatCompletionChoice choice;
-            choice.index = 0;
-            choice.message.role = "assistant";
-            choice.message.content = result.text;
-            // For simplicity we assume the response is complete.
-            choice.finish_reason = "stop";
+            size_t completionChars = 0;
+            for (size_t i = 0; i < results.size(); ++i) {
+                ChatCompletionChoice choice;
+                choice.index = static_cast<int>(i);
+                choice.message.role = "assistant";
+                choice.message.content = results[i].text;
+                // For simplicity we assume the response is complete.
+                choice.finish_reason = "stop";
+
+                response.choices.push_back(choice);
+                completionChars += results[i].text.size();
+            }
 
-            response.choices.push_back(choice);
             // For usage we make a simple estimate (adjust as needed)
             response.usage.prompt_tokens = 0;
             response.usage.completion_tokens =
-                static_cast<int>(result.text.size() / 5);
+                static_cast<int>(completionChars / 5);
             response.usage.total_tokens =
                 response.usage.prompt_tokens + response.usage.completion_tokens;
 
@@ -2990,16 +3977,26 @@ namespace Model
         }
 
         static CompletionResponse convertToCompletionResponse(const CompletionRequest& request, const CompletionResult& result) {
+            return convertToCompletionResponse(request, std::vector<CompletionResult>{ result });
+        }
+
+        // One choice per prompt, in prompt order
+        static CompletionResponse convertToCompletionResponse(const CompletionRequest& request,
+            const std::vector<CompletionResult>& results) {
             CompletionResponse response;
             response.model = request.model;
 
             // Create a choice with the generated text
-            CompletionChoice choice;
-            choice.index = 0;
-            choice.text = result.text;
-            choice.finish_reason = "stop"; // Assuming completion finished normally
-
-            response.choices.push_back(choice);
+            int completionLength = 0;
+            for (size_t i = 0; i < results.size(); ++i) {
+                CompletionChoice choice;
+                choice.index = static_cast<int>(i);
+                choice.text = results[i].text;
+                choice.finish_reason = "stop"; // Assuming completion finished normally
+
+                response.choices.push_back(choice);
+                completionLength += results[i].text.size() / 4; // Rough token estimation
+            }
 
             // Set usage statistics - this is an estimation
             int promptLength = 0;
@@ -3012,8 +4009,6 @@ namespace Model
                 }
             }
 
-            int completionLength = result.text.size() / 4; // Rough token estimation
-
             response.usage.prompt_tokens = promptLength;
             response.usage.completion_tokens = completionLength;
             response.usage.total_tokens = promptLength + completionLength;
@@ -3021,7 +4016,13 @@ namespace Model
             return response;
         }
 
-        std::unordered_map<int, std::atomic<bool>> m_activeJobs;
+        static constexpr size_t STREAMING_PUMP_THREADS = 4;
+        static constexpr uintmax_t PREFIX_CACHE_DISK_BUDGET = 4ULL * 1024 * 1024 * 1024;
+        static constexpr std::chrono::seconds STREAM_CHUNK_TIMEOUT{ 30 };
+        // Well under STREAM_CHUNK_TIMEOUT, so an abandoned stream is stopped before a chunk wait
+        // would have given up on it anyway; setStreamIdleTimeout changes it
+        static constexpr std::chrono::seconds STREAM_IDLE_TIMEOUT{ 10 };
+        static constexpr std::chrono::seconds STREAM_REAPER_INTERVAL{ 1 };
 
         mutable std::shared_mutex                       m_mutex;
         std::unique_ptr<IModelPersistence>              m_persistence;
@@ -3031,9 +4032,20 @@ namespace Model
         std::string                                     m_currentVariantType;
         size_t                                          m_currentModelIndex;
         std::vector<std::future<void>>                  m_downloadFutures;
+        // Queue changes arrive under the scheduler lock, often while the UI thread holds
+        // m_mutex, so they are handed to saveDownloadQueueLater instead of written in place
+        DownloadScheduler                               m_downloadScheduler{
+            [this](const QueuedDownload& download) { return runQueuedDownload(download); },
+            [this](const DownloadQueueState& state) { saveDownloadQueueLater(state); } };
+        std::mutex                                      m_queueSaveMutex;
+        std::optional<DownloadQueueState>               m_pendingQueueSave;
+        bool                                            m_queueSaveRunning = false;
+        std::future<void>                               m_queueSaveFuture;
         std::future<bool>                               m_engineLoadFuture;
         std::future<void>                               m_initializationFuture;
 		std::future<void>                               m_persistenceFuture;
+        std::future<void>                               m_hashCheckFuture;
+        std::atomic<bool>                               m_stopHashChecks{ false };
         std::vector<std::future<void>>                  m_loadFutures;
         std::vector<std::future<void>>                  m_unloadFutures;
 		std::string                                     m_unloadInProgress;
@@ -3041,7 +4053,6 @@ namespace Model
         std::unordered_map<std::string, std::string>    m_modelVariantMap;
         std::atomic<bool>                               m_modelLoaded{ false };
 		std::atomic<bool>                               m_modelGenerationInProgress{ false };
-        std::vector<int>                                m_jobIds;
 		bool                                            m_isVulkanBackend{ false };
 
 #ifdef _WIN32
@@ -3051,6 +4062,24 @@ namespace Model
         CreateInferenceEngineFunc*  m_createInferenceEnginePtr  = nullptr;
         DestroyInferenceEngineFunc* m_destroyInferenceEnginePtr = nullptr;
 
+        // Server request admission per model; outlives the pump, whose jobs hold tickets
+        AdmissionController                      m_admission;
+
+        // Estimated memory of loaded engines, and which of them are in use
+        ResidencyManager                         m_residency;
+        std::mutex                               m_residencyMutex;
+
+        // KV session files shared by API requests with a common message prefix
+        PrefixKvCache                            m_prefixCache{ "kv_prefix_cache", PREFIX_CACHE_DISK_BUDGET };
+
+        // Running jobs and their cancel tokens, kept off m_mutex
+        JobRegistry                              m_jobRegistry;
+
+        // Streaming jobs are stepped on a few shared threads instead of one thread per job.
+        // Declared before the notifier so the notifier's poll thread stops first.
+        JobPump                                  m_jobPump{ STREAMING_PUMP_THREADS };
+        JobNotifier                              m_jobNotifier;
+
 		std::map<const std::string, IInferenceEngine*>  m_inferenceEngines;
         std::map<const std::string, IInferenceEngine*>  m_modelInServer;
 
@@ -3058,12 +4087,16 @@ namespace Model
         struct ChatCompletionStreamingContext {
             std::mutex mtx;
             std::condition_variable cv;
-            std::vector<std::string> chunks;
+            StreamChunkBuffer chunks;  // Chunks not yet sent to the client
             std::string model;        // Store model name
             int jobId = -1;           // Store job ID
             std::string errorMessage; // Store error details
             bool finished = false;
             bool error = false;
+            std::optional<JobPump::Handle> pumpHandle; // Woken when the client drains chunks
+            std::chrono::steady_clock::time_point lastPull = std::chrono::steady_clock::now();
+            int pullsWaiting = 0;     // Handler calls blocked waiting for a chunk
+            size_t generatedTokens = 0;
         };
         std::mutex m_streamContextsMutex;
         std::unordered_map<std::string, std::shared_ptr<ChatCompletionStreamingContext>>
@@ -3074,15 +4107,29 @@ namespace Model
             std::condition_variable cv;
             std::string model;
             int jobId = -1;
-            std::vector<std::string> chunks;
+            StreamChunkBuffer chunks;  // Chunks not yet sent to the client
             bool finished = false;
             bool error = false;
             std::string errorMessage;
-            std::string fullText; // Accumulated full text
+            std::optional<JobPump::Handle> pumpHandle; // Woken when the client drains chunks
+            std::chrono::steady_clock::time_point lastPull = std::chrono::steady_clock::now();
+            int pullsWaiting = 0;     // Handler calls blocked waiting for a chunk
+            size_t generatedTokens = 0;
         };
         std::mutex m_completionStreamContextsMutex;
         std::unordered_map<std::string, std::shared_ptr<CompletionStreamingContext>> 
             m_completionStreamingContexts;
+
+        // Reaps streaming contexts whose clients stopped pulling chunks
+        std::thread             m_reaperThread;
+        std::mutex              m_reaperMutex;
+        std::condition_variable m_reaperCv;
+        bool                    m_reaperStop = false;
+        std::atomic<std::chrono::milliseconds::rep> m_streamIdleTimeoutMs{
+            std::chrono::duration_cast<std::chrono::milliseconds>(STREAM_IDLE_TIMEOUT).count() };
+
+        std::atomic<uint64_t>   m_cancelledStreams{ 0 };
+        std::atomic<uint64_t>   m_cancelledStreamTokens{ 0 };
     };
 
     inline void initializeModelManager(const bool async = true)
@@ -1,14 +1,18 @@
 #pragma once
 
 #include "model.hpp"
+#include "segmented_downloader.hpp"
+#include "download_scheduler.hpp"
+#include "durable_writer.hpp"
 
 #include <string>
 #include <fstream>
 #include <filesystem>
 #include <vector>
 #include <future>
+#include <memory>
+#include <optional>
 #include <algorithm>
-#include <curl/curl.h>
 #include <iostream>
 
 namespace Model
@@ -21,6 +25,10 @@ namespace Model
         virtual std::future<void> downloadModelVariant(ModelData& modelData, const std::string& variantType) = 0;
         virtual std::future<void> saveModelData(const ModelData& modelData) = 0;
         virtual std::future<void> deleteModelVariant(ModelData& modelData, const std::string& variantType) = 0;
+        virtual std::future<void> saveDownloadQueue(const DownloadQueueState& state) = 0;
+        virtual std::future<std::optional<DownloadQueueState>> loadDownloadQueue() = 0;
+        // Shared by every download started from now on; null for no cap
+        virtual void setBandwidthLimiter(std::shared_ptr<BandwidthLimiter> limiter) = 0;
     };
 
     class FileModelPersistence : public IModelPersistence
@@ -38,6 +46,8 @@ namespace Model
         std::future<std::vector<ModelData>> loadAllModels() override
         {
             return std::async(std::launch::async, [this]() -> std::vector<ModelData> {
+                DurableWriter::instance().removeStaleTemps(m_basePath);
+
                 std::vector<ModelData> models;
                 try
                 {
@@ -64,6 +74,13 @@ namespace Model
 
         std::future<void> downloadModelVariant(ModelData& modelData, const std::string& variantType) override
         {
+            // Reset the cancellation flag here rather than on the download thread, so a
+            // cancel issued right after this call is never overwritten.
+            auto pendingIter = modelData.variants.find(variantType);
+            if (pendingIter != modelData.variants.end()) {
+                pendingIter->second.cancelDownload = false;
+            }
+
             return std::async(std::launch::async, [this, &modelData, variantType]() {
                 // Check if variant exists
                 auto variantIter = modelData.variants.find(variantType);
@@ -74,52 +91,30 @@ namespace Model
 
                 ModelVariant& variant = variantIter->second;
 
-                // Reset cancellation flag at the start.
-                variant.cancelDownload = false;
-
-                CURL* curl = curl_easy_init();
-                if (curl)
-                {
-                    // Ensure the target directory exists.
-                    std::filesystem::create_directories(std::filesystem::path(variant.path).parent_path());
-                    std::ofstream file(variant.path, std::ios::binary);
-                    if (!file.is_open())
-                    {
-                        curl_easy_cleanup(curl);
-                        return;
+                // Picks up the .part file a cancelled or failed earlier attempt left behind
+                SegmentedDownloader::Options options;
+                options.limiter = m_limiter;
+                SegmentedDownloader downloader(variant.downloadLink, variant.path, options);
+                downloader.setExpectedSha256(variant.sha256);
+                const auto result = downloader.run(variant.cancelDownload, [&variant](uint64_t done, uint64_t total) {
+                    if (total > 0) {
+                        // 0% looks like no download at all
+                        variant.downloadProgress = std::max(0.01, static_cast<double>(done) / static_cast<double>(total) * 100.0);
                     }
+                    });
 
-                    curl_easy_setopt(curl, CURLOPT_URL, variant.downloadLink.c_str());
-                    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_data);
-                    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &file);
-                    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
-                    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &variant);
-                    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
-                    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-                    CURLcode res = curl_easy_perform(curl);
-                    if (res != CURLE_OK)
-                    {
-                        if (res == CURLE_ABORTED_BY_CALLBACK) {
-                            // Download was canceled:
-                            file.close();
-                            std::filesystem::remove(variant.path);  // Remove incomplete file
-                            variant.downloadProgress = 0.0;
-                            variant.isDownloaded = false;
-                        }
-                        else {
-                            // Handle other error cases as needed.
-                        }
-                    }
-                    else
-                    {
-                        variant.isDownloaded = true;
-                        variant.downloadProgress = 100.0;
-                        // Save the updated model data.
-                        saveModelData(modelData).get();
-                    }
-                    curl_easy_cleanup(curl);
-                    file.close();
+                if (result == SegmentedDownloader::Result::COMPLETED)
+                {
+                    variant.isDownloaded = true;
+                    variant.downloadProgress = 100.0;
+                    // Save the updated model data.
+                    saveModelData(modelData).get();
+                }
+                else
+                {
+                    // Lets the user start it again, which resumes where this one stopped
+                    variant.downloadProgress = 0.0;
+                    variant.isDownloaded = false;
                 }
                 });
         }
@@ -130,13 +125,8 @@ namespace Model
                 std::string modelDataFilename = modelData.name;
                 std::replace(modelDataFilename.begin(), modelDataFilename.end(), ' ', '-');
                 std::transform(modelDataFilename.begin(), modelDataFilename.end(), modelDataFilename.begin(), ::tolower);
-                std::ofstream file(m_basePath + "/" + modelDataFilename + ".json");
-                if (file.is_open())
-                {
-                    nlohmann::json j = modelData;
-                    file << j.dump(4);
-                    file.close();
-                }
+                nlohmann::json j = modelData;
+                DurableWriter::instance().write(m_basePath + "/" + modelDataFilename + ".json", j.dump(4));
                 });
         }
 
@@ -152,6 +142,8 @@ namespace Model
 
                 ModelVariant& variant = variantIter->second;
 
+                SegmentedDownloader::discardPartial(variant.path);
+
                 // Check if the file exists and attempt to remove it.
                 if (std::filesystem::exists(variant.path))
                 {
@@ -173,31 +165,50 @@ namespace Model
                 });
         }
 
-    private:
-        static size_t write_data(void* ptr, size_t size, size_t nmemb, void* userdata)
+        std::future<void> saveDownloadQueue(const DownloadQueueState& state) override
         {
-            std::ofstream* stream = static_cast<std::ofstream*>(userdata);
-            size_t written = 0;
-            if (stream->is_open())
-            {
-                stream->write(static_cast<const char*>(ptr), size * nmemb);
-                written = size * nmemb;
-            }
-            return written;
+            return std::async(std::launch::async, [this, state]() {
+                nlohmann::json j = state;
+                DurableWriter::instance().write(queuePath(), j.dump(4));
+                });
         }
 
-        static int progress_callback(void* ptr, curl_off_t total, curl_off_t now, curl_off_t, curl_off_t)
+        std::future<std::optional<DownloadQueueState>> loadDownloadQueue() override
         {
-            ModelVariant* variant = static_cast<ModelVariant*>(ptr);
-            if (total > 0) {
-                variant->downloadProgress = static_cast<double>(now) / static_cast<double>(total) * 100.0;
-            }
-            // If cancel flag is set, abort the transfer.
-            if (variant->cancelDownload)
-                return 1; // non-zero return value signals curl to abort
-            return 0;
+            return std::async(std::launch::async, [this]() -> std::optional<DownloadQueueState> {
+                std::ifstream file(queuePath());
+                if (!file.is_open())
+                {
+                    return std::nullopt;
+                }
+
+                try
+                {
+                    nlohmann::json j;
+                    file >> j;
+                    return j.get<DownloadQueueState>();
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[FileModelPersistence] Ignoring unreadable download queue: " << e.what() << "\n";
+                    return std::nullopt;
+                }
+                });
+        }
+
+        void setBandwidthLimiter(std::shared_ptr<BandwidthLimiter> limiter) override
+        {
+            m_limiter = std::move(limiter);
+        }
+
+    private:
+        // Not .json, which loadAllModels would take for a model
+        std::string queuePath() const
+        {
+            return m_basePath + "/downloads.queue";
         }
 
         std::string m_basePath;
+        std::shared_ptr<BandwidthLimiter> m_limiter;
     };
 } // namespace Model
\ No newline at end of file
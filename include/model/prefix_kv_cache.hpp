@@ -0,0 +1,409 @@
+#pragma once
+
+#include <types.h>
+
+#include <list>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+
+namespace Model
+{
+    /**
+     * @brief Reuses KV session files across API requests that share a message prefix.
+     *
+     * Each message list is hashed as a chain (hash of messages [0..k] for every k), and
+     * every finished request leaves a KV session file keyed by the hash of its full
+     * message list. A new request looks up the longest chain hash that has a file,
+     * copies it to its own key and hands that path to the engine, which then only has
+     * to evaluate the tokens past the cached prefix. Files are evicted least recently
+     * used first once the disk budget is exceeded; files in use are never evicted.
+     *
+     * The cache survives restarts: entries are rebuilt from the files on disk.
+     */
+    class PrefixKvCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            size_t   entries = 0;
+            uintmax_t diskBytes = 0;
+        };
+
+        /**
+         * @brief One request's claim on a cache file. Destroying it releases the file;
+         *        call complete() first if the engine finished writing it successfully.
+         */
+        class Lease
+        {
+        public:
+            ~Lease()
+            {
+                if (m_owner)
+                {
+                    m_owner->release(m_key, m_completed);
+                }
+            }
+
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+
+            const std::string& path() const { return m_path; }
+            // Number of leading messages whose KV state was found in the cache
+            size_t matchedMessages() const { return m_matchedMessages; }
+            void complete() { m_completed = true; }
+
+        private:
+            friend class PrefixKvCache;
+            Lease() = default;
+
+            PrefixKvCache* m_owner = nullptr;
+            std::string    m_key;
+            std::string    m_path;
+            size_t         m_matchedMessages = 0;
+            bool           m_completed = false;
+        };
+
+        PrefixKvCache(std::filesystem::path basePath, uintmax_t diskBudgetBytes)
+            : m_basePath(std::move(basePath)), m_diskBudget(diskBudgetBytes)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(m_basePath, ec);
+            scanExistingFiles();
+        }
+
+        PrefixKvCache(const PrefixKvCache&) = delete;
+        PrefixKvCache& operator=(const PrefixKvCache&) = delete;
+
+        void setDiskBudget(uintmax_t bytes)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_diskBudget = bytes;
+            evictLocked();
+        }
+
+        /**
+         * @brief Picks the KV file for a request and seeds it from the longest cached prefix.
+         * @return nullptr if the request can't use the cache (e.g. an identical request is
+         *         already writing the same file); the caller then runs without a KV file.
+         */
+        std::shared_ptr<Lease> acquire(const std::string& modelId, const std::vector<Message>& messages)
+        {
+            if (messages.empty())
+            {
+                return nullptr;
+            }
+
+            const std::vector<uint64_t> chain = hashChain(messages);
+            const std::string targetKey = makeKey(modelId, chain.back());
+
+            std::string sourceKey;
+            std::filesystem::path sourcePath;
+            std::filesystem::path targetPath;
+            size_t matched = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                auto target = m_entries.find(targetKey);
+                if (target != m_entries.end() && target->second.leases > 0)
+                {
+                    return nullptr;
+                }
+
+                for (size_t i = chain.size(); i > 0; --i)
+                {
+                    auto it = m_entries.find(makeKey(modelId, chain[i - 1]));
+                    if (it != m_entries.end() && it->second.ready)
+                    {
+                        sourceKey = it->first;
+                        matched = i;
+                        break;
+                    }
+                }
+
+                if (matched > 0)
+                {
+                    ++m_hits;
+                    // Pin the source so it can't be evicted while we copy it
+                    Entry& source = m_entries.at(sourceKey);
+                    ++source.leases;
+                    sourcePath = source.path;
+                    touchLocked(sourceKey);
+                }
+                else
+                {
+                    ++m_misses;
+                }
+
+                Entry& entry = m_entries[targetKey];
+                if (entry.path.empty())
+                {
+                    entry.path = pathFor(modelId, chain.back());
+                    m_lru.push_front(targetKey);
+                    entry.lruPos = m_lru.begin();
+                }
+                ++entry.leases;
+                targetPath = entry.path;
+                touchLocked(targetKey);
+            }
+
+            auto lease = std::shared_ptr<Lease>(new Lease());
+            lease->m_owner = this;
+            lease->m_key = targetKey;
+            lease->m_path = targetPath.string();
+            lease->m_matchedMessages = matched;
+
+            std::error_code ec;
+            std::filesystem::create_directories(targetPath.parent_path(), ec);
+
+            if (matched > 0 && sourceKey != targetKey)
+            {
+                std::filesystem::copy_file(sourcePath, targetPath,
+                    std::filesystem::copy_options::overwrite_existing, ec);
+                if (ec)
+                {
+                    std::cerr << "[PrefixKvCache] Failed to seed " << lease->m_path << ": " << ec.message() << "\n";
+                    lease->m_matchedMessages = 0;
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_entries.at(sourceKey).leases;
+            }
+            else if (matched > 0)
+            {
+                // Exact resend: the source is the target, drop the extra pin
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_entries.at(sourceKey).leases;
+            }
+
+            return lease;
+        }
+
+        Stats getStats() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Stats stats;
+            stats.hits = m_hits;
+            stats.misses = m_misses;
+            stats.evictions = m_evictions;
+            stats.entries = m_entries.size();
+            stats.diskBytes = m_diskBytes;
+            return stats;
+        }
+
+        // Drops all cached files for a model, e.g. when it is deleted or its weights change.
+        void removeModel(const std::string& modelId)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const std::string prefix = sanitize(modelId) + "/";
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                if (it->first.compare(0, prefix.size(), prefix) == 0 && it->second.leases == 0)
+                {
+                    eraseFileLocked(it->second);
+                    m_lru.erase(it->second.lruPos);
+                    it = m_entries.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            std::filesystem::path           path;
+            uintmax_t                       size = 0;
+            int                             leases = 0;
+            bool                            ready = false;
+            std::list<std::string>::iterator lruPos;
+        };
+
+        // FNV-1a, stable across runs so cache files stay valid after a restart
+        static uint64_t hashBytes(uint64_t hash, const std::string& bytes)
+        {
+            for (unsigned char c : bytes)
+            {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            // Field separator, so ("ab","c") and ("a","bc") differ
+            hash ^= 0xFF;
+            hash *= 1099511628211ULL;
+            return hash;
+        }
+
+        static std::vector<uint64_t> hashChain(const std::vector<Message>& messages)
+        {
+            std::vector<uint64_t> chain;
+            chain.reserve(messages.size());
+            uint64_t hash = 14695981039346656037ULL;
+            for (const auto& message : messages)
+            {
+                hash = hashBytes(hash, message.role);
+                hash = hashBytes(hash, message.content);
+                chain.push_back(hash);
+            }
+            return chain;
+        }
+
+        static std::string sanitize(const std::string& modelId)
+        {
+            std::string result = modelId;
+            for (char& c : result)
+            {
+                if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.')
+                {
+                    c = '_';
+                }
+            }
+            return result;
+        }
+
+        static std::string toHex(uint64_t hash)
+        {
+            char buffer[17];
+            std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+            return buffer;
+        }
+
+        static std::string makeKey(const std::string& modelId, uint64_t hash)
+        {
+            return sanitize(modelId) + "/" + toHex(hash);
+        }
+
+        std::filesystem::path pathFor(const std::string& modelId, uint64_t hash) const
+        {
+            return std::filesystem::absolute(m_basePath / sanitize(modelId) / (toHex(hash) + ".bin"));
+        }
+
+        void scanExistingFiles()
+        {
+            struct Found
+            {
+                std::string key;
+                std::filesystem::path path;
+                uintmax_t size;
+                std::filesystem::file_time_type time;
+            };
+            std::vector<Found> found;
+
+            std::error_code ec;
+            for (const auto& modelDir : std::filesystem::directory_iterator(m_basePath, ec))
+            {
+                if (!modelDir.is_directory()) continue;
+                for (const auto& file : std::filesystem::directory_iterator(modelDir.path(), ec))
+                {
+                    if (!file.is_regular_file() || file.path().extension() != ".bin") continue;
+                    found.push_back({ modelDir.path().filename().string() + "/" + file.path().stem().string(),
+                        std::filesystem::absolute(file.path()), file.file_size(ec), file.last_write_time(ec) });
+                }
+            }
+
+            // Oldest first, so the most recently written file ends up at the LRU front
+            std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time < b.time; });
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& file : found)
+            {
+                Entry& entry = m_entries[file.key];
+                entry.path = std::move(file.path);
+                entry.size = file.size;
+                entry.ready = true;
+                m_lru.push_front(file.key);
+                entry.lruPos = m_lru.begin();
+                m_diskBytes += file.size;
+            }
+            evictLocked();
+        }
+
+        void touchLocked(const std::string& key)
+        {
+            Entry& entry = m_entries.at(key);
+            m_lru.splice(m_lru.begin(), m_lru, entry.lruPos);
+        }
+
+        void eraseFileLocked(Entry& entry)
+        {
+            std::error_code ec;
+            std::filesystem::remove(entry.path, ec);
+            m_diskBytes -= entry.size;
+            entry.size = 0;
+        }
+
+        void release(const std::string& key, bool completed)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(key);
+            if (it == m_entries.end()) return;
+
+            Entry& entry = it->second;
+            --entry.leases;
+
+            std::error_code ec;
+            const uintmax_t size = std::filesystem::file_size(entry.path, ec);
+            if (completed && !ec)
+            {
+                m_diskBytes = m_diskBytes - entry.size + size;
+                entry.size = size;
+                entry.ready = true;
+            }
+            else if (!entry.ready && entry.leases == 0)
+            {
+                // Failed before the engine ever produced a usable file; it was never counted
+                eraseFileLocked(entry);
+                m_lru.erase(entry.lruPos);
+                m_entries.erase(it);
+                return;
+            }
+
+            evictLocked();
+        }
+
+        void evictLocked()
+        {
+            auto it = m_lru.end();
+            while (m_diskBytes > m_diskBudget && it != m_lru.begin())
+            {
+                --it;
+                auto entryIt = m_entries.find(*it);
+                if (entryIt == m_entries.end() || entryIt->second.leases > 0)
+                {
+                    continue;
+                }
+
+                eraseFileLocked(entryIt->second);
+                m_entries.erase(entryIt);
+                it = m_lru.erase(it);
+                ++m_evictions;
+            }
+        }
+
+        const std::filesystem::path m_basePath;
+
+        mutable std::mutex                      m_mutex;
+        std::unordered_map<std::string, Entry>  m_entries;
+        // Most recently used at the front
+        std::list<std::string>                  m_lru;
+        uintmax_t                               m_diskBudget;
+        uintmax_t                               m_diskBytes = 0;
+        uint64_t                                m_hits = 0;
+        uint64_t                                m_misses = 0;
+        uint64_t                                m_evictions = 0;
+    };
+
+} // namespace Model
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "preset.hpp"
+#include "durable_writer.hpp"
 
 #include <vector>
 #include <future>
@@ -68,14 +69,6 @@ namespace Model
             {
                 std::filesystem::path filePath = getPresetPath(preset.name);
 
-                // Open file before JSON serialization to fail early if file can't be opened
-                std::ofstream file(filePath);
-                if (!file.is_open())
-                {
-					std::cerr << "[PRESET PERSISTENCE] [ERROR] Failed to open file for writing: " << filePath.string() << std::endl;
-                    return false;
-                }
-
                 // Serialize to JSON with better exception handling
                 nlohmann::json j;
                 try {
@@ -86,12 +79,10 @@ namespace Model
                     return false;
                 }
 
-                // Write to file with exception handling
-                try {
-                    file << j.dump(4);
-                }
-                catch (const std::exception& e) {
-					std::cerr << "[PRESET PERSISTENCE] [ERROR] Failed to write JSON to file: " << e.what() << std::endl;
+                // Replace the file atomically, so a crash can't leave a truncated preset
+                if (!DurableWriter::instance().write(filePath, j.dump(4)))
+                {
+					std::cerr << "[PRESET PERSISTENCE] [ERROR] Failed to write JSON to file: " << filePath.string() << std::endl;
                     return false;
                 }
                 return true;
@@ -109,13 +100,7 @@ namespace Model
             try
             {
                 nlohmann::json j = preset;
-                std::ofstream file(filePath);
-                if (!file.is_open())
-                {
-                    return false;
-                }
-                file << j.dump(4);
-                return true;
+                return DurableWriter::instance().write(filePath, j.dump(4));
             }
             catch (const std::exception&)
             {
@@ -146,6 +131,8 @@ namespace Model
         std::vector<ModelPreset> loadAllPresetsInternal()
         {
             std::shared_lock<std::shared_mutex> lock(m_ioMutex);
+            DurableWriter::instance().removeStaleTemps(m_basePath);
+
             std::vector<ModelPreset> presets;
             try
             {
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace Model
+{
+    /**
+     * @brief Book-keeping for which engines are resident and how much memory they take.
+     *
+     * The manager doesn't load or unload anything itself; ModelManager asks it which
+     * idle models to evict to make room for a new one, and pins models while requests
+     * are using them so they can never be picked as a victim.
+     */
+    class ResidencyManager
+    {
+    public:
+        struct ResidentModel
+        {
+            std::string modelId;
+            size_t      estimatedBytes = 0;
+            int         inFlight = 0;
+            bool        evicting = false;
+            std::chrono::steady_clock::time_point lastUsed;
+        };
+
+        /**
+         * @brief Keeps a model from being evicted while alive.
+         */
+        class Pin
+        {
+        public:
+            ~Pin()
+            {
+                if (m_owner)
+                {
+                    m_owner->unpin(m_modelId);
+                }
+            }
+
+            Pin(const Pin&) = delete;
+            Pin& operator=(const Pin&) = delete;
+
+            const std::string& modelId() const { return m_modelId; }
+
+        private:
+            friend class ResidencyManager;
+            Pin(ResidencyManager* owner, std::string modelId)
+                : m_owner(owner), m_modelId(std::move(modelId))
+            {
+            }
+
+            ResidencyManager* m_owner;
+            std::string       m_modelId;
+        };
+
+        // A budget of 0 means "not set"; callers fall back to what the machine has.
+        void setBudget(size_t bytes)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_budget = bytes;
+        }
+
+        size_t getBudget() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_budget;
+        }
+
+        void onLoaded(const std::string& modelId, size_t estimatedBytes)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ResidentModel& model = m_models[modelId];
+            model.modelId = modelId;
+            model.estimatedBytes = estimatedBytes;
+            model.evicting = false;
+            model.lastUsed = std::chrono::steady_clock::now();
+        }
+
+        void onUnloaded(const std::string& modelId)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_models.erase(modelId);
+        }
+
+        // Returns nullptr if the model isn't resident or is on its way out.
+        std::shared_ptr<Pin> pin(const std::string& modelId)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_models.find(modelId);
+            if (it == m_models.end() || it->second.evicting)
+            {
+                return nullptr;
+            }
+
+            ++it->second.inFlight;
+            it->second.lastUsed = std::chrono::steady_clock::now();
+            return std::shared_ptr<Pin>(new Pin(this, modelId));
+        }
+
+        /**
+         * @brief Picks least recently used idle models whose eviction brings the resident
+         *        total plus `requiredBytes` within `budget`, and marks them as evicting.
+         * @return False (and marks nothing) if that isn't possible without touching busy
+         *         or protected models.
+         */
+        bool reserveVictims(size_t requiredBytes, size_t budget, const std::vector<std::string>& protectedIds,
+            std::vector<std::string>& victims)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            victims.clear();
+
+            size_t resident = 0;
+            std::vector<const ResidentModel*> candidates;
+            for (const auto& [id, model] : m_models)
+            {
+                resident += model.estimatedBytes;
+                bool isProtected = std::find(protectedIds.begin(), protectedIds.end(), id) != protectedIds.end();
+                if (model.inFlight == 0 && !model.evicting && !isProtected)
+                {
+                    candidates.push_back(&model);
+                }
+            }
+
+            std::sort(candidates.begin(), candidates.end(),
+                [](const ResidentModel* a, const ResidentModel* b) { return a->lastUsed < b->lastUsed; });
+
+            for (const ResidentModel* candidate : candidates)
+            {
+                if (resident + requiredBytes <= budget) break;
+                resident -= candidate->estimatedBytes;
+                victims.push_back(candidate->modelId);
+            }
+
+            if (resident + requiredBytes > budget)
+            {
+                victims.clear();
+                return false;
+            }
+
+            for (const auto& id : victims)
+            {
+                m_models[id].evicting = true;
+            }
+            return true;
+        }
+
+        // Called once an eviction finished (or failed and the model stays resident).
+        void finishEviction(const std::string& modelId, bool unloaded)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_models.find(modelId);
+            if (unloaded)
+            {
+                ++m_evictions;
+                if (it != m_models.end()) m_models.erase(it);
+            }
+            else if (it != m_models.end())
+            {
+                it->second.evicting = false;
+            }
+        }
+
+        std::vector<ResidentModel> snapshot() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<ResidentModel> models;
+            models.reserve(m_models.size());
+            for (const auto& [id, model] : m_models)
+            {
+                models.push_back(model);
+            }
+            return models;
+        }
+
+        size_t residentBytes() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t total = 0;
+            for (const auto& [id, model] : m_models)
+            {
+                total += model.estimatedBytes;
+            }
+            return total;
+        }
+
+        uint64_t evictionCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_evictions;
+        }
+
+    private:
+        void unpin(const std::string& modelId)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_models.find(modelId);
+            if (it != m_models.end() && it->second.inFlight > 0)
+            {
+                --it->second.inFlight;
+                it->second.lastUsed = std::chrono::steady_clock::now();
+            }
+        }
+
+        mutable std::mutex                   m_mutex;
+        std::map<std::string, ResidentModel> m_models;
+        size_t                               m_budget = 0;
+        uint64_t                             m_evictions = 0;
+    };
+
+} // namespace Model
@@ -0,0 +1,926 @@
+#pragma once
+
+#include "crypto/crypto.hpp"
+
+#include <curl/curl.h>
+#include <json.hpp>
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+namespace Model
+{
+    /**
+     * @brief Token bucket that caps the combined rate of every transfer sharing it.
+     *
+     * Each transfer reports the bytes it received and sleeps off whatever goes over the
+     * limit, which backs the connection off through TCP flow control. At most a quarter
+     * second of unused budget is saved up, so an idle period doesn't turn into a burst.
+     */
+    class BandwidthLimiter
+    {
+    public:
+        // 0 lifts the limit
+        void setLimit(uint64_t bytesPerSecond)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_limit = bytesPerSecond;
+            m_available = 0.0;
+            m_refilledAt = std::chrono::steady_clock::now();
+        }
+
+        uint64_t getLimit() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_limit;
+        }
+
+        // Blocks until `bytes` fit under the limit
+        void consume(size_t bytes)
+        {
+            std::chrono::duration<double> wait{ 0.0 };
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_limit == 0)
+                {
+                    return;
+                }
+
+                const auto now = std::chrono::steady_clock::now();
+                const double rate = static_cast<double>(m_limit);
+                const double burst = std::max(rate / 4.0, 64.0 * 1024.0);
+                m_available = std::min(burst,
+                    m_available + std::chrono::duration<double>(now - m_refilledAt).count() * rate);
+                m_refilledAt = now;
+
+                // Goes into debt, so concurrent transfers queue up behind each other
+                m_available -= static_cast<double>(bytes);
+                if (m_available < 0.0)
+                {
+                    wait = std::chrono::duration<double>(-m_available / rate);
+                }
+            }
+            if (wait.count() > 0.0)
+            {
+                std::this_thread::sleep_for(wait);
+            }
+        }
+
+    private:
+        mutable std::mutex                    m_mutex;
+        uint64_t                              m_limit = 0;
+        double                                m_available = 0.0;
+        std::chrono::steady_clock::time_point m_refilledAt = std::chrono::steady_clock::now();
+    };
+
+    /**
+     * @brief Downloads one file over several parallel HTTP range requests, resumably.
+     *
+     * The file is split into segmentSize segments that are written into a preallocated
+     * "<target>.part" file. Each of the `connections` workers takes the lowest unfinished
+     * segment and fetches it with a Range request on its own reused connection, retrying
+     * from the last byte received when a transfer breaks. Finished segments are appended
+     * to "<target>.part.journal", whose first line records the URL, size and validator
+     * (ETag or Last-Modified) they belong to, so a later run skips them unless the remote
+     * file changed. The .part file is renamed over the target once every segment is in;
+     * a cancelled or failed run leaves it and the journal for the next one.
+     *
+     * Servers that don't answer a range with 206, or don't report a size, get a single
+     * plain transfer that starts over each time.
+     *
+     * With an expected SHA-256 set, a hashing thread follows the workers through the
+     * file, hashing each segment as soon as it and every segment before it are on disk,
+     * so verification mostly overlaps the download. A file that doesn't match is deleted
+     * and never reaches the target path.
+     */
+    class SegmentedDownloader
+    {
+    public:
+        struct Options
+        {
+            size_t                    connections = 4;
+            uint64_t                  segmentSize = 16ULL * 1024 * 1024;
+            // Consecutive attempts at one segment that receive nothing before giving up
+            int                       maxRetries = 5;
+            std::chrono::milliseconds retryDelay{ 1000 };
+            long                      connectTimeoutSeconds = 30;
+            // A connection below 1 KiB/s for this long is dropped and retried
+            long                      stallTimeoutSeconds = 60;
+            // Shared with other downloads to cap their combined rate; null for no cap
+            std::shared_ptr<BandwidthLimiter> limiter;
+        };
+
+        enum class Result
+        {
+            COMPLETED,
+            CANCELLED,
+            FAILED
+        };
+
+        // Called on the thread running run(), with the bytes on disk and the total (0 if unknown)
+        using ProgressCallback = std::function<void(uint64_t done, uint64_t total)>;
+
+        SegmentedDownloader(std::string url, std::filesystem::path target)
+            : SegmentedDownloader(std::move(url), std::move(target), Options())
+        {
+        }
+
+        SegmentedDownloader(std::string url, std::filesystem::path target, Options options)
+            : m_url(std::move(url))
+            , m_target(std::move(target))
+            , m_options(options)
+        {
+            m_options.connections = std::max<size_t>(m_options.connections, 1);
+            m_options.segmentSize = std::max<uint64_t>(m_options.segmentSize, 64 * 1024);
+        }
+
+        SegmentedDownloader(const SegmentedDownloader&) = delete;
+        SegmentedDownloader& operator=(const SegmentedDownloader&) = delete;
+
+        // Hex digest the finished file must have; empty skips verification
+        void setExpectedSha256(std::string hex)
+        {
+            std::transform(hex.begin(), hex.end(), hex.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            m_expectedSha256 = std::move(hex);
+        }
+
+        // Digest of the downloaded file, once run() has verified it
+        const std::string& sha256() const
+        {
+            return m_sha256;
+        }
+
+        /**
+         * @brief Downloads the file to the target path, resuming an earlier partial run.
+         * @param cancel Stops the transfer when set; what was downloaded so far is kept.
+         */
+        Result run(const std::atomic_bool& cancel, const ProgressCallback& onProgress = {})
+        {
+            m_cancel = &cancel;
+
+            std::error_code ec;
+            if (m_target.has_parent_path())
+            {
+                std::filesystem::create_directories(m_target.parent_path(), ec);
+            }
+
+            std::optional<RemoteInfo> remote;
+            for (int attempt = 1; ; ++attempt)
+            {
+                bool transient = false;
+                remote = probe(transient);
+                if (remote || !transient || attempt > m_options.maxRetries)
+                {
+                    break;
+                }
+                std::cerr << "[SegmentedDownloader] " << m_url << ": " << m_error
+                    << ", retrying (" << attempt << "/" << m_options.maxRetries << ")\n";
+                if (!waitBeforeRetry(m_options.retryDelay * attempt))
+                {
+                    break;
+                }
+            }
+            if (cancel)
+            {
+                return Result::CANCELLED;
+            }
+            if (!remote)
+            {
+                std::cerr << "[SegmentedDownloader] Failed to reach " << m_url << ": " << m_error << "\n";
+                return Result::FAILED;
+            }
+
+            m_segmented = remote->ranges && remote->size > 0;
+            if (!(m_segmented ? prepareSegments(*remote) : prepareSingle(*remote)))
+            {
+                std::cerr << "[SegmentedDownloader] Failed to prepare " << partPathFor(m_target) << "\n";
+                return Result::FAILED;
+            }
+
+            const size_t workers = m_segmented ? std::min(m_options.connections, m_pending.size()) : 1;
+            std::vector<std::thread> threads;
+            m_activeWorkers = workers;
+            for (size_t i = 0; i < workers; ++i)
+            {
+                threads.emplace_back(&SegmentedDownloader::worker, this);
+            }
+            // Plain transfers are hashed in onWrite instead
+            m_hashing = verifying() && m_segmented;
+            if (m_hashing)
+            {
+                threads.emplace_back(&SegmentedDownloader::hashSegments, this);
+            }
+
+            auto downloadedAt = std::chrono::steady_clock::now();
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (m_activeWorkers > 0 || m_hashing)
+                {
+                    m_cv.wait_for(lock, std::chrono::milliseconds(100));
+                    if (m_activeWorkers > 0)
+                    {
+                        downloadedAt = std::chrono::steady_clock::now();
+                    }
+                    if (onProgress)
+                    {
+                        lock.unlock();
+                        onProgress(m_doneBytes, m_total);
+                        lock.lock();
+                    }
+                }
+            }
+            const auto hashLag = std::chrono::steady_clock::now() - downloadedAt;
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            m_journal.close();
+
+            if (m_failed)
+            {
+                std::cerr << "[SegmentedDownloader] Download of " << m_url << " failed: " << m_error << "\n";
+                return Result::FAILED;
+            }
+            if (cancel)
+            {
+                return Result::CANCELLED;
+            }
+
+            const std::filesystem::path partPath = partPathFor(m_target);
+            if (!m_segmented)
+            {
+                // A plain transfer of unknown size may be shorter than an earlier attempt
+                std::filesystem::resize_file(partPath, m_doneBytes, ec);
+            }
+            if (verifying() && !verifySha256(hashLag))
+            {
+                // Which segment is bad can't be told, so none of them can be kept
+                discardPartial(m_target);
+                return Result::FAILED;
+            }
+            std::filesystem::rename(partPath, m_target, ec);
+            if (ec)
+            {
+                std::cerr << "[SegmentedDownloader] Failed to move " << partPath << " to " << m_target
+                    << ": " << ec.message() << "\n";
+                return Result::FAILED;
+            }
+            std::filesystem::remove(journalPathFor(m_target), ec);
+
+            if (onProgress)
+            {
+                onProgress(m_doneBytes, m_total);
+            }
+            return Result::COMPLETED;
+        }
+
+        static std::filesystem::path partPathFor(const std::filesystem::path& target)
+        {
+            return std::filesystem::path(target).concat(".part");
+        }
+
+        static std::filesystem::path journalPathFor(const std::filesystem::path& target)
+        {
+            return std::filesystem::path(target).concat(".part.journal");
+        }
+
+        // Removes what an unfinished download left next to the target
+        static void discardPartial(const std::filesystem::path& target)
+        {
+            std::error_code ec;
+            std::filesystem::remove(partPathFor(target), ec);
+            std::filesystem::remove(journalPathFor(target), ec);
+        }
+
+    private:
+        using CurlHandle = std::unique_ptr<CURL, decltype(&curl_easy_cleanup)>;
+
+        static constexpr size_t HASH_BUFFER_SIZE = 1024 * 1024;
+
+        struct RemoteInfo
+        {
+            uint64_t    size = 0;
+            bool        ranges = false;
+            std::string validator;
+        };
+
+        // Headers of the last response, reset on every status line since redirects add more
+        struct ProbeHeaders
+        {
+            std::optional<uint64_t> rangeTotal;
+            std::optional<uint64_t> contentLength;
+            std::string             etag;
+            std::string             lastModified;
+            uint64_t                bodyBytes = 0;
+        };
+
+        // State of one transfer, handed to the curl callbacks
+        struct Transfer
+        {
+            SegmentedDownloader* owner;
+            CURL*                curl;
+            std::fstream*        file;
+            uint64_t             position;
+            uint64_t             end;
+            long                 expectedStatus;
+        };
+
+        enum class FetchStatus
+        {
+            DONE,
+            RETRY,
+            FATAL,
+            STOPPED
+        };
+
+        // Asks for the first byte: a 206 reveals the size and that ranges work
+        std::optional<RemoteInfo> probe(bool& transient)
+        {
+            CurlHandle curl(curl_easy_init(), &curl_easy_cleanup);
+            if (!curl)
+            {
+                m_error = "curl_easy_init failed";
+                return std::nullopt;
+            }
+
+            ProbeHeaders headers;
+            setCommonOptions(curl.get());
+            curl_easy_setopt(curl.get(), CURLOPT_RANGE, "0-0");
+            curl_easy_setopt(curl.get(), CURLOPT_HEADERFUNCTION, onProbeHeader);
+            curl_easy_setopt(curl.get(), CURLOPT_HEADERDATA, &headers);
+            curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, onProbeBody);
+            curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &headers);
+
+            const CURLcode res = curl_easy_perform(curl.get());
+            long status = 0;
+            curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &status);
+            // A write error only means onProbeBody cut off a body longer than the one byte asked for
+            if (res != CURLE_OK && res != CURLE_WRITE_ERROR)
+            {
+                m_error = curl_easy_strerror(res);
+                transient = true;
+                return std::nullopt;
+            }
+
+            RemoteInfo remote;
+            remote.validator = !headers.etag.empty() ? headers.etag : headers.lastModified;
+            if (status == 206 && headers.rangeTotal)
+            {
+                remote.ranges = true;
+                remote.size = *headers.rangeTotal;
+            }
+            else if (status == 200)
+            {
+                remote.size = headers.contentLength.value_or(0);
+            }
+            else if (status != 416) // An empty file has no first byte
+            {
+                m_error = "HTTP " + std::to_string(status);
+                transient = isTransient(status);
+                return std::nullopt;
+            }
+            return remote;
+        }
+
+        bool prepareSegments(const RemoteInfo& remote)
+        {
+            m_total = remote.size;
+            const size_t count = static_cast<size_t>((m_total + m_options.segmentSize - 1) / m_options.segmentSize);
+            std::vector<bool>& done = m_segmentDone;
+            done.assign(count, false);
+
+            const std::filesystem::path partPath = partPathFor(m_target);
+            const std::filesystem::path journalPath = journalPathFor(m_target);
+            if (!readJournal(remote, done))
+            {
+                discardPartial(m_target);
+                std::error_code ec;
+                {
+                    std::ofstream part(partPath, std::ios::binary | std::ios::trunc);
+                    if (!part)
+                    {
+                        return false;
+                    }
+                }
+                std::filesystem::resize_file(partPath, m_total, ec);
+                if (ec)
+                {
+                    return false;
+                }
+
+                std::ofstream journal(journalPath, std::ios::trunc);
+                journal << nlohmann::json{
+                    {"url", m_url},
+                    {"size", m_total},
+                    {"segmentSize", m_options.segmentSize},
+                    {"validator", remote.validator} }.dump() << '\n';
+                if (!journal)
+                {
+                    return false;
+                }
+            }
+
+            m_journal.open(journalPath, std::ios::app);
+            if (!m_journal)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (done[i])
+                {
+                    m_doneBytes += segmentEnd(i) - segmentBegin(i);
+                }
+                else
+                {
+                    m_pending.push_back(i);
+                }
+            }
+            return true;
+        }
+
+        bool prepareSingle(const RemoteInfo& remote)
+        {
+            m_total = remote.size;
+            discardPartial(m_target);
+            std::ofstream part(partPathFor(m_target), std::ios::binary | std::ios::trunc);
+            return static_cast<bool>(part);
+        }
+
+        // Marks the segments the journal lists, if it belongs to this download and the .part file is intact
+        bool readJournal(const RemoteInfo& remote, std::vector<bool>& done) const
+        {
+            std::error_code ec;
+            if (std::filesystem::file_size(partPathFor(m_target), ec) != m_total || ec)
+            {
+                return false;
+            }
+
+            std::ifstream journal(journalPathFor(m_target));
+            std::string line;
+            if (!std::getline(journal, line))
+            {
+                return false;
+            }
+
+            try
+            {
+                const auto header = nlohmann::json::parse(line);
+                if (header.at("url").get<std::string>() != m_url ||
+                    header.at("size").get<uint64_t>() != m_total ||
+                    header.at("segmentSize").get<uint64_t>() != m_options.segmentSize ||
+                    header.at("validator").get<std::string>() != remote.validator)
+                {
+                    std::cerr << "[SegmentedDownloader] " << m_url << " changed, restarting download\n";
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+
+            // A line cut short by a crash has no newline and is ignored
+            while (std::getline(journal, line) && !journal.eof())
+            {
+                try
+                {
+                    const size_t index = std::stoul(line);
+                    if (index < done.size())
+                    {
+                        done[index] = true;
+                    }
+                }
+                catch (const std::exception&)
+                {
+                }
+            }
+            return true;
+        }
+
+        void worker()
+        {
+            CurlHandle curl(curl_easy_init(), &curl_easy_cleanup);
+            std::fstream file(partPathFor(m_target), std::ios::in | std::ios::out | std::ios::binary);
+            if (!curl || !file)
+            {
+                fail("cannot start a transfer");
+            }
+            else if (m_segmented)
+            {
+                while (const std::optional<size_t> index = nextSegment())
+                {
+                    Transfer transfer{ this, curl.get(), &file, segmentBegin(*index), segmentEnd(*index), 206 };
+                    if (!fetchWithRetries(transfer, "segment " + std::to_string(*index)))
+                    {
+                        break;
+                    }
+                    markDone(*index);
+                }
+            }
+            else
+            {
+                Transfer transfer{ this, curl.get(), &file, 0, m_total > 0 ? m_total : UINT64_MAX, 200 };
+                fetchWithRetries(transfer, "download");
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeWorkers;
+            m_cv.notify_all();
+        }
+
+        bool fetchWithRetries(Transfer& transfer, const std::string& what)
+        {
+            int failures = 0;
+            while (true)
+            {
+                const uint64_t before = transfer.position;
+                std::string error;
+                switch (fetch(transfer, error))
+                {
+                case FetchStatus::DONE:
+                    return true;
+                case FetchStatus::STOPPED:
+                    return false;
+                case FetchStatus::FATAL:
+                    fail(what + ": " + error);
+                    return false;
+                case FetchStatus::RETRY:
+                    break;
+                }
+
+                if (transfer.position > before)
+                {
+                    failures = 0;
+                }
+                if (++failures > m_options.maxRetries)
+                {
+                    fail(what + ": " + error);
+                    return false;
+                }
+                std::cerr << "[SegmentedDownloader] " << what << " of " << m_url << ": " << error
+                    << ", retrying (" << failures << "/" << m_options.maxRetries << ")\n";
+
+                if (!m_segmented)
+                {
+                    // Without ranges the transfer can only start over
+                    m_doneBytes -= transfer.position;
+                    transfer.position = 0;
+                    m_hasher.reset();
+                    m_hashedBytes = 0;
+                }
+
+                if (!waitBeforeRetry(m_options.retryDelay * failures))
+                {
+                    return false;
+                }
+            }
+        }
+
+        FetchStatus fetch(Transfer& transfer, std::string& error)
+        {
+            CURL* curl = transfer.curl;
+            setCommonOptions(curl);
+            const std::string range = std::to_string(transfer.position) + "-" + std::to_string(transfer.end - 1);
+            curl_easy_setopt(curl, CURLOPT_RANGE, m_segmented ? range.c_str() : nullptr);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onWrite);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, onTransferProgress);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+
+            transfer.file->clear();
+            transfer.file->seekp(static_cast<std::streamoff>(transfer.position));
+            const CURLcode res = curl_easy_perform(curl);
+            transfer.file->flush();
+
+            long status = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            if (!*transfer.file)
+            {
+                error = "writing " + partPathFor(m_target).string() + " failed";
+                return FetchStatus::FATAL;
+            }
+            if (stopped())
+            {
+                return FetchStatus::STOPPED;
+            }
+
+            if (status != 0 && status != transfer.expectedStatus)
+            {
+                error = "HTTP " + std::to_string(status);
+                return isTransient(status) ? FetchStatus::RETRY : FetchStatus::FATAL;
+            }
+            // With the expected status and the file intact, onWrite only refuses an overlong body
+            if (res == CURLE_WRITE_ERROR)
+            {
+                error = "server sent more than requested";
+                return FetchStatus::FATAL;
+            }
+            if (res != CURLE_OK)
+            {
+                error = curl_easy_strerror(res);
+                return FetchStatus::RETRY;
+            }
+            if (transfer.end != UINT64_MAX && transfer.position != transfer.end)
+            {
+                error = "connection closed early";
+                return FetchStatus::RETRY;
+            }
+            return FetchStatus::DONE;
+        }
+
+        bool verifying() const
+        {
+            return !m_expectedSha256.empty();
+        }
+
+        // Feeds segments to the hasher in file order, each as soon as it is on disk
+        void hashSegments()
+        {
+            std::ifstream file(partPathFor(m_target), std::ios::binary);
+            std::vector<char> buffer(HASH_BUFFER_SIZE);
+            for (size_t index = 0; file && index < m_segmentDone.size(); ++index)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock, [&]() { return m_segmentDone[index] || m_stop || m_activeWorkers == 0; });
+                    if (!m_segmentDone[index])
+                    {
+                        break;
+                    }
+                }
+
+                const auto start = std::chrono::steady_clock::now();
+                file.seekg(static_cast<std::streamoff>(segmentBegin(index)));
+                for (uint64_t left = segmentEnd(index) - segmentBegin(index); left > 0; )
+                {
+                    const size_t size = static_cast<size_t>(std::min<uint64_t>(left, buffer.size()));
+                    if (!file.read(buffer.data(), static_cast<std::streamsize>(size)))
+                    {
+                        break;
+                    }
+                    m_hasher.update(buffer.data(), size);
+                    m_hashedBytes += size;
+                    left -= size;
+                }
+                m_hashBusy += std::chrono::steady_clock::now() - start;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_hashing = false;
+            m_cv.notify_all();
+        }
+
+        // `lag` is how long hashing ran on after the last byte arrived
+        bool verifySha256(std::chrono::steady_clock::duration lag)
+        {
+            if (m_hashedBytes != m_doneBytes)
+            {
+                std::cerr << "[SegmentedDownloader] Could not hash all of " << partPathFor(m_target) << "\n";
+                return false;
+            }
+
+            const std::string actual = m_hasher.finishHex();
+            if (actual != m_expectedSha256)
+            {
+                std::cerr << "[SegmentedDownloader] SHA-256 mismatch for " << m_url << ": expected "
+                    << m_expectedSha256 << ", got " << actual << "\n";
+                return false;
+            }
+            m_sha256 = actual;
+
+            const double mib = static_cast<double>(m_hashedBytes) / (1024.0 * 1024.0);
+            const double busy = std::chrono::duration<double>(m_hashBusy).count();
+            std::cerr << "[SegmentedDownloader] Verified " << m_target.filename() << ": " << mib
+                << " MiB hashed at " << (busy > 0 ? mib / busy : 0.0) << " MiB/s, "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(lag).count()
+                << " ms after the last byte\n";
+            return true;
+        }
+
+        // Only throttling and server errors are worth another attempt
+        static bool isTransient(long status)
+        {
+            return status == 408 || status == 429 || status >= 500;
+        }
+
+        // False if the download was stopped during the wait
+        bool waitBeforeRetry(std::chrono::milliseconds delay)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + delay;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // The cancel flag doesn't notify, so poll it
+            while (!m_stop && !*m_cancel && std::chrono::steady_clock::now() < deadline)
+            {
+                m_cv.wait_until(lock, std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+            }
+            return !m_stop && !*m_cancel;
+        }
+
+        void setCommonOptions(CURL* curl) const
+        {
+            curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, m_options.connectTimeoutSeconds);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, m_options.stallTimeoutSeconds);
+        }
+
+        std::optional<size_t> nextSegment()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop || m_next >= m_pending.size())
+            {
+                return std::nullopt;
+            }
+            return m_pending[m_next++];
+        }
+
+        void markDone(size_t index)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Losing a line only means downloading that segment again after a restart
+            m_journal << index << '\n';
+            m_journal.flush();
+            m_segmentDone[index] = true;
+            m_cv.notify_all();
+        }
+
+        void fail(const std::string& error)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_failed)
+            {
+                m_failed = true;
+                m_error = error;
+            }
+            m_stop = true;
+            m_cv.notify_all();
+        }
+
+        bool stopped()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stop || *m_cancel;
+        }
+
+        uint64_t segmentBegin(size_t index) const
+        {
+            return index * m_options.segmentSize;
+        }
+
+        uint64_t segmentEnd(size_t index) const
+        {
+            return std::min(m_total, segmentBegin(index) + m_options.segmentSize);
+        }
+
+        static size_t onWrite(char* data, size_t size, size_t count, void* userdata)
+        {
+            Transfer* transfer = static_cast<Transfer*>(userdata);
+            const size_t bytes = size * count;
+
+            // Error pages must not end up in the file
+            long status = 0;
+            curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &status);
+            if (status != transfer->expectedStatus || bytes > transfer->end - transfer->position)
+            {
+                return 0;
+            }
+
+            transfer->file->write(data, static_cast<std::streamsize>(bytes));
+            if (!*transfer->file)
+            {
+                return 0;
+            }
+            transfer->position += bytes;
+            transfer->owner->m_doneBytes += bytes;
+
+            SegmentedDownloader* owner = transfer->owner;
+            if (owner->verifying() && !owner->m_segmented)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                owner->m_hasher.update(data, bytes);
+                owner->m_hashedBytes += bytes;
+                owner->m_hashBusy += std::chrono::steady_clock::now() - start;
+            }
+            if (owner->m_options.limiter)
+            {
+                owner->m_options.limiter->consume(bytes);
+            }
+            return bytes;
+        }
+
+        static int onTransferProgress(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+        {
+            SegmentedDownloader* self = static_cast<SegmentedDownloader*>(userdata);
+            // Non-zero aborts the transfer
+            return self->m_stop.load() || self->m_cancel->load() ? 1 : 0;
+        }
+
+        static size_t onProbeBody(char*, size_t size, size_t count, void* userdata)
+        {
+            ProbeHeaders* headers = static_cast<ProbeHeaders*>(userdata);
+            headers->bodyBytes += size * count;
+            return headers->bodyBytes > 1 ? 0 : size * count;
+        }
+
+        static size_t onProbeHeader(char* data, size_t size, size_t count, void* userdata)
+        {
+            ProbeHeaders* headers = static_cast<ProbeHeaders*>(userdata);
+            const std::string line(data, size * count);
+            if (line.rfind("HTTP/", 0) == 0)
+            {
+                *headers = ProbeHeaders();
+                return size * count;
+            }
+
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                return size * count;
+            }
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t\r\n") + 1);
+
+            try
+            {
+                if (name == "content-range")
+                {
+                    // bytes 0-0/12345, or bytes 0-0/* when the size is unknown
+                    const size_t slash = value.rfind('/');
+                    if (slash != std::string::npos && value.compare(slash + 1, std::string::npos, "*") != 0)
+                    {
+                        headers->rangeTotal = std::stoull(value.substr(slash + 1));
+                    }
+                }
+                else if (name == "content-length")
+                {
+                    headers->contentLength = std::stoull(value);
+                }
+                else if (name == "etag")
+                {
+                    headers->etag = value;
+                }
+                else if (name == "last-modified")
+                {
+                    headers->lastModified = value;
+                }
+            }
+            catch (const std::exception&)
+            {
+                // A malformed number just leaves the size unknown
+            }
+            return size * count;
+        }
+
+        const std::string           m_url;
+        const std::filesystem::path m_target;
+        Options                     m_options;
+        const std::atomic_bool*     m_cancel = nullptr;
+
+        bool                        m_segmented = false;
+        uint64_t                    m_total = 0;
+        std::atomic<uint64_t>       m_doneBytes{ 0 };
+
+        // Used by one thread at a time: the hashing thread, or the plain transfer's worker
+        std::string                 m_expectedSha256;
+        std::string                 m_sha256;
+        Crypto::Sha256              m_hasher;
+        uint64_t                    m_hashedBytes = 0;
+        std::chrono::steady_clock::duration m_hashBusy{ 0 };
+
+        // Guards everything below
+        std::mutex                  m_mutex;
+        std::condition_variable     m_cv;
+        std::vector<size_t>         m_pending;
+        std::vector<bool>           m_segmentDone;
+        size_t                      m_next = 0;
+        size_t                      m_activeWorkers = 0;
+        bool                        m_hashing = false;
+        std::ofstream               m_journal;
+        std::atomic<bool>           m_stop{ false };
+        bool                        m_failed = false;
+        std::string                 m_error;
+    };
+} // namespace Model
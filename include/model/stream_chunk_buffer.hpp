@@ -0,0 +1,80 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <optional>
+
+namespace Model
+{
+    /**
+     * @brief Bounded FIFO of streamed text chunks addressed by their absolute index.
+     *
+     * The server pulls chunks in order, so taking chunk N releases every chunk before
+     * it. Producers check full() before reading more output from the engine; when the
+     * client falls behind, generated text simply stays in the engine until the buffer
+     * drains, which keeps memory per stream bounded. Not thread safe; the owning
+     * streaming context's mutex guards it.
+     */
+    class StreamChunkBuffer
+    {
+    public:
+        explicit StreamChunkBuffer(size_t maxChunks = 256, size_t maxBytes = 64 * 1024)
+            : m_maxChunks(maxChunks), m_maxBytes(maxBytes)
+        {
+        }
+
+        void push(std::string chunk)
+        {
+            m_bytes += chunk.size();
+            m_chunks.push_back(std::move(chunk));
+        }
+
+        bool full() const
+        {
+            return m_chunks.size() >= m_maxChunks || m_bytes >= m_maxBytes;
+        }
+
+        // Total number of chunks ever pushed, i.e. the index the next chunk will get.
+        size_t pushedCount() const
+        {
+            return m_firstIndex + m_chunks.size();
+        }
+
+        // Removes and returns chunk `index`, dropping any older chunks still buffered.
+        std::optional<std::string> take(size_t index)
+        {
+            while (!m_chunks.empty() && m_firstIndex < index)
+            {
+                popFront();
+            }
+            if (m_chunks.empty() || m_firstIndex != index)
+            {
+                return std::nullopt;
+            }
+
+            m_bytes -= m_chunks.front().size();
+            std::string chunk = std::move(m_chunks.front());
+            m_chunks.pop_front();
+            ++m_firstIndex;
+            return chunk;
+        }
+
+        size_t bufferedBytes() const { return m_bytes; }
+        size_t bufferedChunks() const { return m_chunks.size(); }
+
+    private:
+        void popFront()
+        {
+            m_bytes -= m_chunks.front().size();
+            m_chunks.pop_front();
+            ++m_firstIndex;
+        }
+
+        std::deque<std::string> m_chunks;
+        size_t m_firstIndex = 0;
+        size_t m_bytes = 0;
+        const size_t m_maxChunks;
+        const size_t m_maxBytes;
+    };
+
+} // namespace Model
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <unordered_map>
+
+namespace Model
+{
+    /**
+     * @brief The engine job left behind by a cancelled stream, for the caller to stop.
+     */
+    struct CancelledStream
+    {
+        std::string model;
+        int         jobId = -1;
+        size_t      generatedTokens = 0;
+    };
+
+    /**
+     * @brief Cancellation helpers shared by the chat and completion streaming contexts.
+     *
+     * A context needs `mtx`, `cv`, `model`, `jobId`, `finished`, `error`, `errorMessage`,
+     * `lastPull`, `pullsWaiting` and `generatedTokens`. Stopping the engine job is left to
+     * the caller, so these can be driven without an engine. Locks are never nested:
+     * request handlers take a context's mutex before the map's, so the map is only
+     * locked on its own.
+     */
+    namespace StreamReaper
+    {
+        /**
+         * @brief Fails the context's pending chunk wait.
+         * @return The job to stop, or nullopt if it had already finished.
+         */
+        template <typename Context>
+        std::optional<CancelledStream> cancel(Context& ctx, const char* reason)
+        {
+            CancelledStream cancelled;
+            bool finished = false;
+            {
+                std::lock_guard<std::mutex> lock(ctx.mtx);
+                cancelled.model = ctx.model;
+                cancelled.jobId = ctx.jobId;
+                cancelled.generatedTokens = ctx.generatedTokens;
+                finished = ctx.finished;
+                ctx.error = true;
+                ctx.errorMessage = reason;
+            }
+            ctx.cv.notify_all();
+
+            if (finished)
+            {
+                return std::nullopt;
+            }
+            return cancelled;
+        }
+
+        // Removes and returns the stream, or nullptr if it isn't open
+        template <typename Context>
+        std::shared_ptr<Context> take(std::mutex& contextsMutex,
+            std::unordered_map<std::string, std::shared_ptr<Context>>& contexts, const std::string& requestId)
+        {
+            std::lock_guard<std::mutex> lock(contextsMutex);
+            auto it = contexts.find(requestId);
+            if (it == contexts.end())
+            {
+                return nullptr;
+            }
+            std::shared_ptr<Context> ctx = std::move(it->second);
+            contexts.erase(it);
+            return ctx;
+        }
+
+        /**
+         * @brief Removes and returns the streams whose client has not pulled a chunk for
+         *        `idleTimeout` and is not waiting for one now. A stream replaced under the
+         *        same id meanwhile is kept.
+         */
+        template <typename Context>
+        std::vector<std::pair<std::string, std::shared_ptr<Context>>> takeIdle(std::mutex& contextsMutex,
+            std::unordered_map<std::string, std::shared_ptr<Context>>& contexts,
+            std::chrono::steady_clock::duration idleTimeout)
+        {
+            std::vector<std::pair<std::string, std::shared_ptr<Context>>> snapshot;
+            {
+                std::lock_guard<std::mutex> lock(contextsMutex);
+                snapshot.assign(contexts.begin(), contexts.end());
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            std::vector<std::pair<std::string, std::shared_ptr<Context>>> idle;
+            for (auto& entry : snapshot)
+            {
+                std::lock_guard<std::mutex> lock(entry.second->mtx);
+                if (entry.second->pullsWaiting == 0 && now - entry.second->lastPull >= idleTimeout)
+                {
+                    idle.push_back(std::move(entry));
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(contextsMutex);
+            for (const auto& [requestId, ctx] : idle)
+            {
+                auto it = contexts.find(requestId);
+                if (it != contexts.end() && it->second == ctx)
+                {
+                    contexts.erase(it);
+                }
+            }
+            return idle;
+        }
+    }
+
+} // namespace Model
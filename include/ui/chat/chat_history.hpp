@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
+#include <optional>
 
 namespace ChatHistoryConstants {
     constexpr float MIN_SCROLL_DIFFERENCE = 1.0f;
@@ -68,6 +70,14 @@ public:
         }
 
         m_lastMessageCount = currentMessageCount;
+
+        // A regeneration that had to stop the running job goes ahead once that job's
+        // finishing callback has cleared the generation flag.
+        if (m_pendingRegenerate && !Model::ModelManager::getInstance().isCurrentlyGenerating()) {
+            const int index = *m_pendingRegenerate;
+            m_pendingRegenerate.reset();
+            regenerateResponse(index);
+        }
     }
 
 private:
@@ -201,33 +211,37 @@ private:
 		ImGui::EndChild();
     }
 
-    static void chatStreamingCallback(const std::string& partialOutput, const float tps, const int jobId, const bool isFinished) {
+    // The chat name is bound before the job starts: the job id -> chat mapping is only set
+    // once startChatCompletionJob has returned, and the job may already be streaming by then.
+    static std::function<void(const std::string&, const float, const int, const bool)>
+        makeChatStreamingCallback(const std::string& chatName) {
+        return [chatName](const std::string& partialOutput, const float tps, const int, const bool isFinished) {
+            chatStreamingCallback(chatName, partialOutput, tps, isFinished);
+        };
+    }
+
+    static void chatStreamingCallback(const std::string& chatName, const std::string& partialOutput, const float tps, const bool isFinished) {
         auto& chatManager = Chat::ChatManager::getInstance();
         auto& modelManager = Model::ModelManager::getInstance();
-        std::string chatName = chatManager.getChatNameByJobId(jobId);
 
         if (isFinished) modelManager.setModelGenerationInProgress(false);
 
+        // partialOutput only holds the text generated since the previous callback
+        if (chatManager.appendToLastAssistantMessage(chatName, partialOutput, tps) || partialOutput.empty()) {
+            return;
+        }
+
         auto chatOpt = chatManager.getChat(chatName);
         if (chatOpt) {
-            Chat::ChatHistory chat = chatOpt.value();
-            if (!chat.messages.empty() && chat.messages.back().role == "assistant") {
-                // Append to existing assistant message
-                chat.messages.back().content = partialOutput;
-                chat.messages.back().tps = tps;
-                chatManager.updateChat(chatName, chat);
-            }
-            else {
-                // Create new assistant message
-                Chat::Message assistantMsg;
-                assistantMsg.id = static_cast<int>(chat.messages.size()) + 1;
-                assistantMsg.role = "assistant";
-                assistantMsg.content = partialOutput;
-                assistantMsg.tps = tps;
-                assistantMsg.modelName = modelManager.getCurrentModelName().value_or("idk") + " | "
-                    + modelManager.getCurrentVariantType();
-                chatManager.addMessage(chatName, assistantMsg);
-            }
+            // Create new assistant message
+            Chat::Message assistantMsg;
+            assistantMsg.id = static_cast<int>(chatOpt->messages.size()) + 1;
+            assistantMsg.role = "assistant";
+            assistantMsg.content = partialOutput;
+            assistantMsg.tps = tps;
+            assistantMsg.modelName = modelManager.getCurrentModelName().value_or("idk") + " | "
+                + modelManager.getCurrentVariantType();
+            chatManager.addMessage(chatName, assistantMsg);
         }
     }
 
@@ -241,15 +255,14 @@ private:
 			return;
 		}
 
-        // Stop current generation if running.
+        // Stop current generation if running, and regenerate once it has finished rather
+        // than deleting messages the job is still streaming into.
         if (modelManager.isCurrentlyGenerating()) {
-            modelManager.stopJob(chatManager.getCurrentJobId(), modelManager.getCurrentModelName().value(), modelManager.getCurrentVariantType());
-
-            while (true)
-            {
-                if (!modelManager.isCurrentlyGenerating())
-                    break;
+            if (!m_pendingRegenerate) {
+                modelManager.stopJob(chatManager.getCurrentJobId(), modelManager.getCurrentModelName().value(), modelManager.getCurrentVariantType());
             }
+            m_pendingRegenerate = index;
+            return;
         }
 
         auto currentChatOpt = chatManager.getCurrentChat();
@@ -315,7 +328,7 @@ private:
             chatManager.getCurrentChat().value()
         );
 
-        int jobId = modelManager.startChatCompletionJob(completionParams, chatStreamingCallback, 
+        int jobId = modelManager.startChatCompletionJob(completionParams, makeChatStreamingCallback(currentChat.name),
             modelManager.getCurrentModelName().value(), modelManager.getCurrentVariantType());
         if (!chatManager.setCurrentJobId(jobId)) {
             std::cerr << "[ChatSection] Failed to set the current job ID.\n";
@@ -448,5 +461,6 @@ private:
     ImVec4 bubbleBgColorAssistant;
 
     size_t m_lastMessageCount = 0;
+    std::optional<int> m_pendingRegenerate;
     std::unordered_map<std::string, bool> m_thinkToggleStates;
 };
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <optional>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <ctime>
 
 namespace ChatSidebarConstants {
@@ -47,6 +48,27 @@ private:
     LabelConfig  m_recentsLabelConfig;
 };
 
+class ChatSearchComponent {
+public:
+    void render(float sidebarWidth) {
+        InputFieldConfig config("##chatSearch", ImVec2(sidebarWidth - 20.0f, 0), m_query, m_focusSearch);
+        config.placeholderText = "Search chats";
+        config.backgroundColor = RGBAToImVec4(34, 34, 34, 255);
+        config.hoverColor = RGBAToImVec4(44, 44, 44, 255);
+        config.activeColor = RGBAToImVec4(54, 54, 54, 255);
+        InputField::render(config);
+        ImGui::Spacing();
+    }
+
+    const std::string& getQuery() const {
+        return m_query;
+    }
+
+private:
+    std::string m_query;
+    bool m_focusSearch = false;
+};
+
 class ChatListComponent {
 public:
     ChatListComponent(const ButtonConfig& baseChatButtonConfig, const ButtonConfig& baseDeleteButtonConfig)
@@ -54,28 +76,96 @@ public:
     {
     }
 
-    void render(float sidebarWidth, float availableHeight) {
+    void render(float sidebarWidth, float availableHeight, const std::string& searchQuery) {
         auto& chatManager = Chat::ChatManager::getInstance();
-        const auto chats = chatManager.getChats();  // Get a copy for safe iteration.
         const auto currentChatName = chatManager.getCurrentChatName();
 
         const ImVec2 contentArea(sidebarWidth, availableHeight);
         ImGui::BeginChild("ChatHistoryButtons", contentArea, false, ImGuiWindowFlags_NoScrollbar);
 
-        for (const auto& chat : chats) {
-            renderChatButton(chat, contentArea, currentChatName);
-            renderDeleteButton(chat, contentArea);
-            ImGui::Spacing();
+        if (searchQuery.find_first_not_of(" \t") != std::string::npos) {
+            renderSearchResults(searchQuery, contentArea, currentChatName);
+        }
+        else {
+            const auto chats = chatManager.getChatSummaries();  // Get a copy for safe iteration.
+            for (const auto& chat : chats) {
+                renderChatButton(chat, contentArea, currentChatName);
+                renderDeleteButton(chat, contentArea);
+                ImGui::Spacing();
+            }
         }
 
         ImGui::EndChild();
     }
 
 private:
+    // Chats with matching messages, in order of their best match
+    struct SearchResult {
+        std::string chatName;
+        size_t matches;
+    };
+
     ButtonConfig m_baseChatButtonConfig;
     ButtonConfig m_baseDeleteButtonConfig;
 
-    void renderChatButton(const Chat::ChatHistory& chat, const ImVec2& contentArea,
+    // Results are recomputed only when the query or the index changes, not every frame
+    std::string m_searchQuery;
+    uint64_t m_searchRevision = 0;
+    std::vector<SearchResult> m_searchResults;
+
+    void updateSearchResults(const std::string& query) {
+        auto& chatManager = Chat::ChatManager::getInstance();
+        const uint64_t revision = chatManager.getSearchRevision();
+        if (query == m_searchQuery && revision == m_searchRevision) {
+            return;
+        }
+        m_searchQuery = query;
+        m_searchRevision = revision;
+
+        m_searchResults.clear();
+        std::unordered_map<std::string, size_t> resultIndex;
+        for (const auto& hit : chatManager.searchChats(query, 200)) {
+            auto [it, inserted] = resultIndex.try_emplace(hit.chatName, m_searchResults.size());
+            if (inserted) {
+                m_searchResults.push_back({ hit.chatName, 0 });
+            }
+            ++m_searchResults[it->second].matches;
+        }
+    }
+
+    void renderSearchResults(const std::string& query, const ImVec2& contentArea,
+        const std::optional<std::string>& currentChatName) {
+        updateSearchResults(query);
+
+        if (m_searchResults.empty()) {
+            LabelConfig label;
+            label.id = "##noSearchResults";
+            label.label = "No matching chats";
+            label.size = ImVec2(0, 0);
+            label.fontSize = FontsManager::MD;
+            Label::render(label);
+            return;
+        }
+
+        for (const auto& result : m_searchResults) {
+            ButtonConfig config = m_baseChatButtonConfig;
+            config.id = "##searchResult" + result.chatName;
+            config.label = result.chatName;
+            config.size = ImVec2(contentArea.x - 20, 0);
+            config.state = (currentChatName && *currentChatName == result.chatName)
+                ? ButtonState::ACTIVE : ButtonState::NORMAL;
+            config.onClick = [chatName = result.chatName]() {
+                Chat::ChatManager::getInstance().switchToChat(chatName);
+                };
+            config.tooltip = std::to_string(result.matches) +
+                (result.matches == 1 ? " matching message" : " matching messages");
+
+            Button::render(config);
+            ImGui::Spacing();
+        }
+    }
+
+    void renderChatButton(const Chat::ChatSummary& chat, const ImVec2& contentArea,
         const std::optional<std::string>& currentChatName) {
         ButtonConfig config = m_baseChatButtonConfig;
         config.id = "##chat" + std::to_string(chat.id);
@@ -97,7 +187,7 @@ private:
         Button::render(config);
     }
 
-    void renderDeleteButton(const Chat::ChatHistory& chat, const ImVec2& contentArea) {
+    void renderDeleteButton(const Chat::ChatSummary& chat, const ImVec2& contentArea) {
         // Position the delete button on the right of the chat button.
         ImGui::SameLine(contentArea.x - 38);
         ImGui::SetCursorPosY(ImGui::GetCursorPosY() - 3);
@@ -138,8 +228,9 @@ public:
         m_sidebarWidth = ImGui::GetWindowSize().x;
 
         m_chatHeaderComponent.render();
+        m_chatSearchComponent.render(m_sidebarWidth);
         float availableHeight = sidebarHeight - ImGui::GetCursorPosY();
-        m_chatListComponent.render(m_sidebarWidth, availableHeight);
+        m_chatListComponent.render(m_sidebarWidth, availableHeight, m_chatSearchComponent.getQuery());
 
         ImGui::End();
     }
@@ -151,6 +242,7 @@ public:
 private:
     float m_sidebarWidth;
     ChatHeaderComponent m_chatHeaderComponent;
+    ChatSearchComponent m_chatSearchComponent;
     ChatListComponent m_chatListComponent;
 
     // Helper functions to initialize base configurations.
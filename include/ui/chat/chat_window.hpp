@@ -15,7 +15,11 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <memory>
 #include <functional>
+#include <mutex>
+#include <future>
+#include <chrono>
 
 class RenameChatModalComponent {
 public:
@@ -200,6 +204,8 @@ public:
     }
 
     void render(float leftSidebarWidth, float rightSidebarWidth) {
+        applyGeneratedTitle();
+
         ImGuiIO& io = ImGui::GetIO();
         ImVec2 windowSize = ImVec2(io.DisplaySize.x - rightSidebarWidth - leftSidebarWidth,
             io.DisplaySize.y - Config::TITLE_BAR_HEIGHT - Config::FOOTER_HEIGHT);
@@ -298,39 +304,65 @@ private:
         ImGui::EndChild();
     }
 
-    static void chatStreamingCallback(const std::string& partialOutput, const float tps, const int jobId, const bool isFinished) {
+    // The chat name is bound before the job starts: the job id -> chat mapping is only set
+    // once startChatCompletionJob has returned, and the job may already be streaming by then.
+    static std::function<void(const std::string&, const float, const int, const bool)>
+        makeChatStreamingCallback(const std::string& chatName) {
+        return [chatName](const std::string& partialOutput, const float tps, const int, const bool isFinished) {
+            chatStreamingCallback(chatName, partialOutput, tps, isFinished);
+        };
+    }
+
+    static void chatStreamingCallback(const std::string& chatName, const std::string& partialOutput, const float tps, const bool isFinished) {
         auto& chatManager = Chat::ChatManager::getInstance();
         auto& modelManager = Model::ModelManager::getInstance();
-        std::string chatName = chatManager.getChatNameByJobId(jobId);
 
         if (isFinished) modelManager.setModelGenerationInProgress(false);
 
+        // partialOutput only holds the text generated since the previous callback
+        if (chatManager.appendToLastAssistantMessage(chatName, partialOutput, tps) || partialOutput.empty()) {
+            return;
+        }
+
         auto chatOpt = chatManager.getChat(chatName);
         if (chatOpt) {
-            Chat::ChatHistory chat = chatOpt.value();
-            if (!chat.messages.empty() && chat.messages.back().role == "assistant") {
-                // Append to existing assistant message
-                chat.messages.back().content = partialOutput;
-                chat.messages.back().tps = tps;
-                chatManager.updateChat(chatName, chat);
+            // Create new assistant message
+            Chat::Message assistantMsg;
+            assistantMsg.id = static_cast<int>(chatOpt->messages.size()) + 1;
+            assistantMsg.role = "assistant";
+            assistantMsg.content = partialOutput;
+            assistantMsg.tps = tps;
+            assistantMsg.modelName = modelManager.getCurrentModelName().value_or("idk") + " | "
+                + modelManager.getCurrentVariantType();
+            chatManager.addMessage(chatName, assistantMsg);
+        }
+    }
+
+    // Starts renaming the chat to a generated title, and reports how the last rename went,
+    // without ever waiting for the rename to finish.
+    void applyGeneratedTitle() {
+        if (m_titleRename.valid()) {
+            if (m_titleRename.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
             }
-            else {
-                // Create new assistant message
-                Chat::Message assistantMsg;
-                assistantMsg.id = static_cast<int>(chat.messages.size()) + 1;
-                assistantMsg.role = "assistant";
-                assistantMsg.content = partialOutput;
-                assistantMsg.tps = tps;
-                assistantMsg.modelName = modelManager.getCurrentModelName().value_or("idk") + " | "
-                    + modelManager.getCurrentVariantType();
-                chatManager.addMessage(chatName, assistantMsg);
+            if (!m_titleRename.get()) {
+                std::cerr << "[ChatSection] Failed to rename chat to: " << m_renamingTo << "\n";
             }
         }
+
+        std::optional<std::string> title;
+        {
+            std::lock_guard<std::mutex> lock(m_titleMutex);
+            title.swap(m_generatedTitle);
+        }
+        if (title) {
+            m_renamingTo = *title;
+            m_titleRename = Chat::ChatManager::getInstance().renameCurrentChat(*title);
+        }
     }
 
     void generateChatTitle(const std::string& firstUserMessage) {
         auto& modelManager = Model::ModelManager::getInstance();
-        auto& chatManager = Chat::ChatManager::getInstance();
 
         // Create parameters for title generation
         ChatCompletionParameters titleParams;
@@ -348,17 +380,16 @@ private:
         titleParams.temperature = 0.7;  // Slightly creative but not too random
         titleParams.streaming = false;  // No need for streaming for a quick title
 
-        // Use a separate thread to avoid blocking UI
-        std::thread([titleParams]() {
-            auto& modelManager = Model::ModelManager::getInstance();
-            auto& chatManager = Chat::ChatManager::getInstance();
+        // Run on the shared streaming pump so title generation doesn't tie up a thread of its own
+        auto titleText = std::make_shared<std::string>();
 
-            // Generate the title (synchronous call)
-            CompletionResult titleResult = modelManager.chatCompleteSync(titleParams, modelManager.getCurrentModelName().value(), modelManager.getCurrentVariantType(), false);
+        auto titleCallback = [this, titleText](const std::string& partialOutput, const float tps, const int jobId, const bool isFinished) {
+            titleText->append(partialOutput);
+            if (!isFinished) return;
 
-            if (!titleResult.text.empty()) {
+            if (!titleText->empty()) {
                 // Clean up the generated title
-                std::string newTitle = titleResult.text;
+                std::string newTitle = *titleText;
 
                 // Trim whitespace and quotes
                 // Remove symbols and trim whitespace, and if the title contain text "Title:", remove it
@@ -396,15 +427,20 @@ private:
 
                 trim(newTitle);
 
-                // Apply the new title if it's valid
+                // Apply the new title if it's valid. The rename happens on the UI thread, since
+                // waiting for it here would stall every job on the pump.
                 if (!newTitle.empty()) {
-                    if (!chatManager.renameCurrentChat(newTitle).get())
-                    {
-                        std::cerr << "[ChatSection] Failed to rename chat to: " << newTitle << "\n";
-                    }
+                    std::lock_guard<std::mutex> lock(m_titleMutex);
+                    m_generatedTitle = std::move(newTitle);
                 }
             }
-            }).detach();
+            };
+
+        if (modelManager.startChatCompletionJob(titleParams, titleCallback,
+            modelManager.getCurrentModelName().value(), modelManager.getCurrentVariantType(), false) < 0)
+        {
+            std::cerr << "[ChatSection] Failed to start title generation job\n";
+        }
     }
 
     // Render the row of buttons that allow the user to switch models or clear chat.
@@ -464,7 +500,7 @@ private:
             buildChatCompletionParameters(currentChat, message);
 
         auto& modelManager = Model::ModelManager::getInstance();
-        int jobId = modelManager.startChatCompletionJob(completionParams, chatStreamingCallback,
+        int jobId = modelManager.startChatCompletionJob(completionParams, makeChatStreamingCallback(currentChat.name),
             modelManager.getCurrentModelName().value(), modelManager.getCurrentVariantType());
         if (!chatManager.setCurrentJobId(jobId)) {
             std::cerr << "[ChatSection] Failed to set the current job ID.\n";
@@ -642,6 +678,12 @@ private:
     bool m_wasAtBottom;
     float m_lastContentHeight;
 
+    // Title produced by the title job, waiting for the UI thread to apply it
+    std::mutex m_titleMutex;
+    std::optional<std::string> m_generatedTitle;
+    std::future<bool> m_titleRename;
+    std::string m_renamingTo;
+
     // Child components.
     ModelManagerModal modelManagerModal;
     RenameChatModalComponent renameChatModal;
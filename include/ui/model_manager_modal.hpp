@@ -4,7 +4,7 @@
 #include "ui/widgets.hpp"
 #include "ui/markdown.hpp"
 #include "model/model_manager.hpp"
-#include "model/gguf_reader.hpp"
+#include "model/gguf_metadata_cache.hpp"
 #include "ui/fonts.hpp"
 #include <string>
 #include <vector>
@@ -203,9 +203,6 @@ private:
     // Buttons
     std::vector<ButtonConfig> variantButtons;
 
-	// GGUF reader
-    GGUFMetadataReader m_ggufReader;
-
     // Check if input is a URL
     bool isUrlInput(const std::string& input) {
         // Simple regex to detect URLs
@@ -790,11 +787,11 @@ private:
         std::optional<GGUFModelParams> metadata;
 		for (const auto& [variantName, variant] : m_variants) {
 			if (!variant.downloadLink.empty()) {
-				metadata = m_ggufReader.readModelParams(variant.downloadLink, false);
+				metadata = GGUFMetadataCache::instance().readModelParams(variant.downloadLink, false);
 				break;
 			}
             else {
-				metadata = m_ggufReader.readModelParams(variant.path, false);
+				metadata = GGUFMetadataCache::instance().readModelParams(variant.path, false);
 				break;
             }
 		}
@@ -0,0 +1,159 @@
+// Serialize and parse benchmark for ChatBinaryFormat against the JSON chat format. Run it
+// through chat_format_bench.py, or build it against the app's include directories like the
+// app itself, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include /I ..\..\include\chat /I ..\..\external\nlohmann /I ..\..\external\imgui chat_format_bench.cpp
+//
+//   chat_format_bench <messages> <rounds>
+//
+// Builds one chat of <messages> messages and, for each format, times writing it to a
+// string and reading it back: to_json plus dump against json::parse plus from_json, and
+// ChatBinaryFormat with and without the KLZ codec. Prints
+// "<format> <encoded bytes> <serialize ms> <parse ms>" per format, with the mean per round.
+// Exits non-zero if a format does not give back the chat it was given.
+
+#include "chat/chat_binary_format.hpp"
+
+#include <sstream>
+#include <iostream>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the timed results alive, so the compiler can't drop the work
+    volatile size_t g_sink = 0;
+
+    Chat::ChatHistory makeChat(int messages)
+    {
+        Chat::ChatHistory chat(42, 1700000000, "Format benchmark", {});
+        const auto start = std::chrono::system_clock::now();
+        for (int i = 0; i < messages; ++i)
+        {
+            std::string content = "Message " + std::to_string(i) + " with \"quotes\", a tab\tand a newline\n: ";
+            while (content.size() < 200 + static_cast<size_t>(i % 7) * 60)
+            {
+                content += "lorem ipsum dolor sit amet " + std::to_string(i * 17 + static_cast<int>(content.size())) + " ";
+            }
+            Chat::Message message(i, i % 2 == 0 ? "user" : "assistant", content,
+                i % 2 == 0 ? "" : "fake:Q4_K_M", 17.25F, i % 5 == 0, i % 11 == 0,
+                start + std::chrono::seconds(i * 3));
+            chat.messages.push_back(std::move(message));
+        }
+        // The Message constructor only takes user and assistant; other roles are assigned
+        if (!chat.messages.empty())
+        {
+            chat.messages.front().role = "system";
+        }
+        return chat;
+    }
+
+    // JSON timestamps are whole seconds, so that is all either side is compared at
+    bool sameChat(const Chat::ChatHistory& a, const Chat::ChatHistory& b)
+    {
+        if (a.id != b.id || a.lastModified != b.lastModified || a.name != b.name || a.messages.size() != b.messages.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.messages.size(); ++i)
+        {
+            const auto& x = a.messages[i];
+            const auto& y = b.messages[i];
+            const auto seconds = [](const Chat::Message& m) {
+                return std::chrono::duration_cast<std::chrono::seconds>(m.timestamp.time_since_epoch()).count();
+            };
+            if (x.id != y.id || x.role != y.role || x.content != y.content || x.modelName != y.modelName ||
+                x.isLiked != y.isLiked || x.isDisliked != y.isDisliked || x.tps != y.tps || seconds(x) != seconds(y))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct Format
+    {
+        const char* name;
+        std::string (*serialize)(const Chat::ChatHistory&);
+        Chat::ChatHistory (*parse)(const std::string&);
+    };
+
+    std::string writeJson(const Chat::ChatHistory& chat)
+    {
+        json j = chat;
+        return j.dump();
+    }
+
+    Chat::ChatHistory readJson(const std::string& encoded)
+    {
+        Chat::ChatHistory chat;
+        from_json(json::parse(encoded), chat);
+        return chat;
+    }
+
+    template <Chat::ChatBinaryFormat::Codec codec>
+    std::string writeBinary(const Chat::ChatHistory& chat)
+    {
+        std::ostringstream out(std::ios::binary);
+        Chat::ChatBinaryFormat::write(out, chat, 7, codec);
+        return out.str();
+    }
+
+    Chat::ChatHistory readBinary(const std::string& encoded)
+    {
+        std::istringstream in(encoded, std::ios::binary);
+        uint64_t epoch = 0;
+        return Chat::ChatBinaryFormat::read(in, epoch);
+    }
+
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: chat_format_bench <messages> <rounds>\n";
+        return 2;
+    }
+
+    const Chat::ChatHistory chat = makeChat(std::stoi(argv[1]));
+    const int rounds = (std::max)(1, std::stoi(argv[2]));
+
+    const Format formats[] = {
+        { "json", &writeJson, &readJson },
+        { "binary", &writeBinary<Chat::ChatBinaryFormat::Codec::NONE>, &readBinary },
+        { "binary-klz", &writeBinary<Chat::ChatBinaryFormat::Codec::KLZ>, &readBinary },
+    };
+
+    int failures = 0;
+    for (const Format& format : formats)
+    {
+        const std::string encoded = format.serialize(chat);
+        if (!sameChat(format.parse(encoded), chat))
+        {
+            std::cout << "FAILED: " << format.name << " does not round-trip the chat" << std::endl;
+            ++failures;
+            continue;
+        }
+
+        auto start = Clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+            g_sink = g_sink + format.serialize(chat).size();
+        }
+        const double serializeMs = msSince(start) / rounds;
+
+        start = Clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+            g_sink = g_sink + format.parse(encoded).messages.size();
+        }
+        const double parseMs = msSince(start) / rounds;
+
+        std::cout << format.name << " " << encoded.size() << " " << serializeMs << " " << parseMs << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
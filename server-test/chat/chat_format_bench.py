@@ -0,0 +1,53 @@
+"""
+Runs chat_format_bench for a range of chat lengths and prints size, serialize time and
+parse time for the JSON chat format and for ChatBinaryFormat, plain and KLZ-compressed.
+
+Build chat_format_bench.cpp first (see the top of that file), then run
+    python chat_format_bench.py path/to/chat_format_bench
+
+Fails if a format loses data in a round trip, or if the plain binary format is not faster
+than JSON to both serialize and parse.
+"""
+
+import os
+import subprocess
+import sys
+
+# (messages, rounds)
+CHATS = [(10, 2000), (100, 200), (1000, 20), (10000, 3)]
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python chat_format_bench.py path/to/chat_format_bench")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    failures = 0
+
+    print(f"{'messages':>8}  {'format':10} {'bytes':>10} {'serialize ms':>13} {'parse ms':>10}")
+    for messages, rounds in CHATS:
+        result = subprocess.run([binary, str(messages), str(rounds)], stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT, text=True, timeout=600)
+        rows = {}
+        for line in result.stdout.splitlines():
+            parts = line.split()
+            if len(parts) != 4 or line.startswith("FAILED"):
+                print(line)
+                continue
+            rows[parts[0]] = (int(parts[1]), float(parts[2]), float(parts[3]))
+            print(f"{messages:>8}  {parts[0]:10} {rows[parts[0]][0]:>10} {rows[parts[0]][1]:13.3f} {rows[parts[0]][2]:10.3f}")
+
+        if result.returncode != 0 or len(rows) != 3:
+            failures += 1
+            continue
+        if rows["binary"][1] >= rows["json"][1] or rows["binary"][2] >= rows["json"][2]:
+            print("  the binary format was not faster than JSON")
+            failures += 1
+
+    print(f"{len(CHATS)} chat lengths, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
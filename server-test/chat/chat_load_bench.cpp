@@ -0,0 +1,150 @@
+// Startup-time benchmark for FileChatPersistence. Run it through chat_load_bench.py, or
+// build it against the app's include directories and OpenSSL like the app itself, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include /I ..\..\include\chat /I ..\..\external\nlohmann /I ..\..\external\imgui /I ..\..\external\OpenSSL\3.4.0\include chat_load_bench.cpp /link /LIBPATH:..\..\external\OpenSSL\3.4.0\lib libcrypto.lib
+//
+//   chat_load_bench <dir> generate <chats> <messages per chat>
+//   chat_load_bench <dir> load <workers>
+//
+// "generate" fills <dir> with synthetic chats through saveChat. "load" times what startup
+// does with them, each time from a fresh FileChatPersistence limited to <workers> load
+// workers (0 for one per hardware thread):
+//   all          loadAllChats, decrypting and parsing every chat
+//   index-cold   loadChatIndex with chats.index removed, which decrypts every chat too
+//   index-warm   loadChatIndex again with the index it just wrote
+// Prints "<what> <workers> <ms>" per step and exits non-zero if a chat is missing, out of
+// order or has the wrong number of messages.
+
+#include "chat/chat_persistence.hpp"
+
+#include <iostream>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::array<uint8_t, 32> benchKey()
+    {
+        std::array<uint8_t, 32> key{};
+        for (size_t i = 0; i < key.size(); ++i)
+        {
+            key[i] = static_cast<uint8_t>(i * 13 + 5);
+        }
+        return key;
+    }
+
+    // Zero-padded so file name order matches creation order
+    std::string chatName(int index)
+    {
+        std::string digits = std::to_string(index);
+        return "chat" + std::string(digits.size() < 6 ? 6 - digits.size() : 0, '0') + digits;
+    }
+
+    int generate(const std::filesystem::path& dir, int chats, int messages)
+    {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+
+        Chat::FileChatPersistence persistence(dir, benchKey());
+        for (int c = 0; c < chats; ++c)
+        {
+            Chat::ChatHistory chat(c, c, chatName(c), {});
+            for (int m = 0; m < messages; ++m)
+            {
+                std::string content = "Chat " + std::to_string(c) + ", message " + std::to_string(m) + ": ";
+                content.append(200 + (c * 7 + m * 13) % 400, static_cast<char>('a' + (c + m) % 26));
+                chat.messages.emplace_back(m, m % 2 == 0 ? "user" : "assistant", content,
+                    m % 2 == 0 ? "" : "fake:Q4_K_M", 20.0F);
+            }
+            if (!persistence.saveChat(chat).get())
+            {
+                std::cout << "FAILED: could not save " << chat.name << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    template <typename Item>
+    bool checkLoaded(const std::vector<Item>& items, size_t chats, size_t messages, size_t (*messageCount)(const Item&))
+    {
+        if (items.size() != chats)
+        {
+            std::cout << "FAILED: loaded " << items.size() << " of " << chats << " chats" << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            if (items[i].name != chatName(static_cast<int>(i)) || messageCount(items[i]) != messages)
+            {
+                std::cout << "FAILED: chat " << i << " is " << items[i].name << " with "
+                    << messageCount(items[i]) << " messages" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t countOf(const Chat::ChatHistory& chat) { return chat.messages.size(); }
+    size_t countOf(const Chat::ChatSummary& summary) { return summary.messageCount; }
+
+    int load(const std::filesystem::path& dir, size_t workers)
+    {
+        // What generate wrote, recovered from the file names and one loaded chat
+        size_t chats = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            chats += entry.path().extension() == ".chat" ? 1 : 0;
+        }
+        size_t messages = 0;
+        {
+            Chat::FileChatPersistence persistence(dir, benchKey());
+            auto first = persistence.loadChat(chatName(0)).get();
+            messages = first ? first->messages.size() : 0;
+        }
+
+        const std::array<uint8_t, 32> key = benchKey();
+        bool ok = true;
+        {
+            Chat::FileChatPersistence persistence(dir, key);
+            persistence.setLoadWorkers(workers);
+            const auto start = Clock::now();
+            const auto all = persistence.loadAllChats().get();
+            std::cout << "all " << workers << " " << msSince(start) << std::endl;
+            ok = checkLoaded<Chat::ChatHistory>(all, chats, messages, &countOf) && ok;
+        }
+
+        std::filesystem::remove(dir / "chats.index");
+        for (const char* step : { "index-cold", "index-warm" })
+        {
+            Chat::FileChatPersistence persistence(dir, key);
+            persistence.setLoadWorkers(workers);
+            const auto start = Clock::now();
+            const auto summaries = persistence.loadChatIndex().get();
+            std::cout << step << " " << workers << " " << msSince(start) << std::endl;
+            ok = checkLoaded<Chat::ChatSummary>(summaries, chats, messages, &countOf) && ok;
+        }
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string mode = argc > 2 ? argv[2] : "";
+    if (mode == "generate" && argc == 5)
+    {
+        return generate(argv[1], std::stoi(argv[3]), std::stoi(argv[4]));
+    }
+    if (mode == "load" && argc == 4)
+    {
+        return load(argv[1], std::stoul(argv[3]));
+    }
+
+    std::cerr << "usage: chat_load_bench <dir> generate <chats> <messages per chat>\n"
+                 "       chat_load_bench <dir> load <workers>\n";
+    return 2;
+}
@@ -0,0 +1,61 @@
+"""
+Generates a directory of 5,000 encrypted chats with chat_load_bench and times startup over
+it with different numbers of load workers: loading every chat, building the chat index
+from scratch, and reading the index back once it exists.
+
+Build chat_load_bench.cpp first (see the top of that file), then run
+    python chat_load_bench.py path/to/chat_load_bench [chats] [messages per chat]
+
+Decrypting and parsing is CPU-bound, so the speedup over one worker is bounded by the
+number of cores; on a single core expect none. Fails if any load lost or reordered chats.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# 0 means one worker per hardware thread
+WORKERS = [1, 2, 4, 0]
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python chat_load_bench.py path/to/chat_load_bench [chats] [messages per chat]")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    chats = int(sys.argv[2]) if len(sys.argv) > 2 else 5000
+    messages = int(sys.argv[3]) if len(sys.argv) > 3 else 20
+    directory = tempfile.mkdtemp(prefix="chat_load_bench_")
+    failures = 0
+
+    try:
+        subprocess.run([binary, directory, "generate", str(chats), str(messages)], check=True, timeout=3600)
+        print(f"{chats} chats of {messages} messages on {os.cpu_count()} hardware threads")
+
+        baseline = {}
+        for workers in WORKERS:
+            result = subprocess.run([binary, directory, "load", str(workers)], stdout=subprocess.PIPE,
+                                    stderr=subprocess.STDOUT, text=True, timeout=600)
+            label = "auto" if workers == 0 else str(workers)
+            for line in result.stdout.splitlines():
+                parts = line.split()
+                if len(parts) != 3 or parts[0].startswith("FAILED"):
+                    print(line)
+                    continue
+                ms = float(parts[2])
+                baseline.setdefault(parts[0], ms)
+                print(f"  {parts[0]:11} {label:>4} workers {ms:9.1f} ms  ({baseline[parts[0]] / ms:.2f}x one worker)")
+            if result.returncode != 0:
+                failures += 1
+    finally:
+        shutil.rmtree(directory, ignore_errors=True)
+
+    print(f"{len(WORKERS)} worker counts, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
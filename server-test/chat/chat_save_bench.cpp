@@ -0,0 +1,213 @@
+// Save-cost benchmark for FileChatPersistence. Run it through chat_save_bench.py, or build
+// it against the app's include directories and OpenSSL like the app itself, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include /I ..\..\include\chat /I ..\..\external\nlohmann /I ..\..\external\imgui /I ..\..\external\OpenSSL\3.4.0\include chat_save_bench.cpp /link /LIBPATH:..\..\external\OpenSSL\3.4.0\lib libcrypto.lib
+//
+//   chat_save_bench <dir> <chat length> <saves>
+//
+// Builds a chat of <chat length> messages, saves it once, then adds one message at a time
+// and saves after each, the way ChatManager does while a conversation goes on. The same
+// sequence then runs through the save path used before the journal: to_json, dump,
+// Crypto::encrypt and a DurableWriter rewrite of the whole file. Prints
+// "<path> <chat length> <mean ms> <p95 ms> <bytes written per save>" for both, where the
+// journal figures include any compactions that fell inside the run. Before printing it
+// reloads the journaled chat and exits non-zero if any message is missing or changed.
+
+#include "chat/chat_persistence.hpp"
+
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Timing
+    {
+        std::vector<double> ms;
+        uintmax_t bytes = 0;
+
+        double mean() const
+        {
+            double sum = 0.0;
+            for (double value : ms) sum += value;
+            return ms.empty() ? 0.0 : sum / static_cast<double>(ms.size());
+        }
+
+        double p95() const
+        {
+            if (ms.empty()) return 0.0;
+            std::vector<double> sorted = ms;
+            std::sort(sorted.begin(), sorted.end());
+            return sorted[static_cast<size_t>(0.95 * static_cast<double>(sorted.size() - 1) + 0.5)];
+        }
+    };
+
+    // Alternating turns of a few hundred bytes, each one different
+    Chat::Message makeMessage(int index)
+    {
+        std::string content = "Message " + std::to_string(index) + ": ";
+        while (content.size() < 300)
+        {
+            content += "the quick brown fox " + std::to_string(index * 31 + static_cast<int>(content.size())) + " ";
+        }
+        return Chat::Message(index, index % 2 == 0 ? "user" : "assistant", content,
+            index % 2 == 0 ? "" : "fake:Q4_K_M", 12.5F);
+    }
+
+    uintmax_t sizeOrZero(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : size;
+    }
+
+    uintmax_t chatFileBytes(const std::filesystem::path& dir)
+    {
+        uintmax_t total = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.path().extension() == ".chat" || entry.path().extension() == ".journal")
+            {
+                total += entry.file_size();
+            }
+        }
+        return total;
+    }
+
+    // Bytes written are estimated from file growth: a journal append adds its records,
+    // while a compaction or a full rewrite writes the whole new file
+    Timing runJournal(const std::filesystem::path& dir, const std::array<uint8_t, 32>& key,
+        Chat::ChatHistory chat, int saves)
+    {
+        Timing timing;
+        Chat::FileChatPersistence persistence(dir, key);
+        persistence.saveChat(chat).get();
+
+        const std::filesystem::path chatPath = persistence.getChatPath(chat.name);
+        for (int i = 0; i < saves; ++i)
+        {
+            chat.messages.push_back(makeMessage(static_cast<int>(chat.messages.size())));
+            chat.lastModified++;
+
+            const uintmax_t snapshotBefore = sizeOrZero(chatPath);
+            const uintmax_t before = chatFileBytes(dir);
+            const auto start = Clock::now();
+            if (!persistence.saveChat(chat).get())
+            {
+                throw std::runtime_error("saveChat failed");
+            }
+            timing.ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+            const uintmax_t after = chatFileBytes(dir);
+            const bool compacted = sizeOrZero(chatPath) != snapshotBefore;
+            timing.bytes += compacted ? sizeOrZero(chatPath) : after - before;
+        }
+        return timing;
+    }
+
+    Timing runFullRewrite(const std::filesystem::path& dir, const std::array<uint8_t, 32>& key,
+        Chat::ChatHistory chat, int saves)
+    {
+        Timing timing;
+        const std::filesystem::path chatPath = dir / (chat.name + ".chat");
+        for (int i = 0; i < saves; ++i)
+        {
+            chat.messages.push_back(makeMessage(static_cast<int>(chat.messages.size())));
+            chat.lastModified++;
+
+            const auto start = Clock::now();
+            json chatJson = chat;
+            const std::string serialized = chatJson.dump();
+            const std::vector<uint8_t> plaintext(serialized.begin(), serialized.end());
+            const std::vector<uint8_t> encrypted = Crypto::encrypt(plaintext, key);
+            if (!DurableWriter::instance().write(chatPath, std::string(encrypted.begin(), encrypted.end())))
+            {
+                throw std::runtime_error("full rewrite failed");
+            }
+            timing.ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            timing.bytes += encrypted.size();
+        }
+        return timing;
+    }
+
+    int check(const std::filesystem::path& dir, const std::array<uint8_t, 32>& key, const Chat::ChatHistory& expected)
+    {
+        Chat::FileChatPersistence persistence(dir, key);
+        const auto loaded = persistence.loadChat(expected.name).get();
+        if (!loaded || loaded->messages.size() != expected.messages.size())
+        {
+            std::cout << "FAILED: reloaded chat has " << (loaded ? loaded->messages.size() : 0)
+                << " of " << expected.messages.size() << " messages" << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < expected.messages.size(); ++i)
+        {
+            const auto& a = loaded->messages[i];
+            const auto& b = expected.messages[i];
+            if (a.id != b.id || a.role != b.role || a.content != b.content || a.modelName != b.modelName)
+            {
+                std::cout << "FAILED: message " << i << " changed across the reload" << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << "usage: chat_save_bench <dir> <chat length> <saves>\n";
+        return 2;
+    }
+
+    const std::filesystem::path dir = argv[1];
+    const int length = std::stoi(argv[2]);
+    const int saves = (std::max)(1, std::stoi(argv[3]));
+
+    std::array<uint8_t, 32> key{};
+    for (size_t i = 0; i < key.size(); ++i)
+    {
+        key[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+
+    Chat::ChatHistory chat(1, 1, "bench", {});
+    for (int i = 0; i < length; ++i)
+    {
+        chat.messages.push_back(makeMessage(i));
+    }
+
+    const std::filesystem::path journalDir = dir / "journal";
+    const std::filesystem::path rewriteDir = dir / "rewrite";
+    std::filesystem::remove_all(journalDir);
+    std::filesystem::remove_all(rewriteDir);
+    std::filesystem::create_directories(journalDir);
+    std::filesystem::create_directories(rewriteDir);
+
+    try
+    {
+        const Timing journal = runJournal(journalDir, key, chat, saves);
+        const Timing rewrite = runFullRewrite(rewriteDir, key, chat, saves);
+
+        Chat::ChatHistory expected = chat;
+        for (int i = 0; i < saves; ++i)
+        {
+            expected.messages.push_back(makeMessage(static_cast<int>(expected.messages.size())));
+        }
+        if (check(journalDir, key, expected) != 0)
+        {
+            return 1;
+        }
+
+        std::cout << "journal " << length << " " << journal.mean() << " " << journal.p95() << " " << journal.bytes / saves << std::endl;
+        std::cout << "rewrite " << length << " " << rewrite.mean() << " " << rewrite.p95() << " " << rewrite.bytes / saves << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "FAILED: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+"""
+Runs chat_save_bench for a range of chat lengths and prints save cost as a function of
+chat length, for FileChatPersistence's journal and for the full rewrite it replaced.
+The last run saves long enough to cross COMPACT_RECORDS, so its journal figures include
+the amortized cost of compacting.
+
+Build chat_save_bench.cpp first (see the top of that file), then run
+    python chat_save_bench.py path/to/chat_save_bench
+
+Fails if a reload lost messages, if a journal save wrote more than a few records' worth
+of bytes on average, or if it was not faster than a full rewrite.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# (chat length, saves)
+RUNS = [(10, 150), (100, 150), (1000, 150), (5000, 150), (100, 1200)]
+MAX_JOURNAL_BYTES_PER_SAVE = 4096
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python chat_save_bench.py path/to/chat_save_bench")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    directory = tempfile.mkdtemp(prefix="chat_save_bench_")
+    failures = 0
+
+    print(f"{'messages':>8} {'saves':>6}  {'path':8} {'mean ms':>9} {'p95 ms':>9} {'bytes/save':>11}")
+    try:
+        for length, saves in RUNS:
+            result = subprocess.run([binary, directory, str(length), str(saves)], stdout=subprocess.PIPE,
+                                    stderr=subprocess.STDOUT, text=True, timeout=600)
+            rows = {}
+            for line in result.stdout.splitlines():
+                parts = line.split()
+                if len(parts) == 5 and parts[0] in ("journal", "rewrite"):
+                    rows[parts[0]] = (float(parts[2]), float(parts[3]), int(parts[4]))
+                    print(f"{length:>8} {saves:>6}  {parts[0]:8} {rows[parts[0]][0]:9.2f} "
+                          f"{rows[parts[0]][1]:9.2f} {rows[parts[0]][2]:11}")
+
+            if result.returncode != 0 or len(rows) != 2:
+                print(result.stdout)
+                failures += 1
+                continue
+            if saves < 512 and rows["journal"][2] > MAX_JOURNAL_BYTES_PER_SAVE:
+                print(f"  journal wrote {rows['journal'][2]} bytes per save")
+                failures += 1
+            if rows["journal"][0] >= rows["rewrite"][0]:
+                print("  journal saves were not faster than full rewrites")
+                failures += 1
+    finally:
+        shutil.rmtree(directory, ignore_errors=True)
+
+    print(f"{len(RUNS)} runs, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
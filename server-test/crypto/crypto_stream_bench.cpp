@@ -0,0 +1,270 @@
+// Throughput benchmark for Crypto's chunked AES-GCM streams. Run it through
+// crypto_stream_bench.py, or build it against the app's include directory and OpenSSL like
+// the app itself, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include /I ..\..\external\OpenSSL\3.4.0\include crypto_stream_bench.cpp /link /LIBPATH:..\..\external\OpenSSL\3.4.0\lib libcrypto.lib
+//
+//   crypto_stream_bench <payload MiB> <rounds>
+//
+// Encrypts and decrypts one payload in memory, both as a single Crypto::encrypt/decrypt
+// buffer the way chats used to be saved (string, plaintext copy, ciphertext), and through
+// EncryptStreamBuf/DecryptStreamBuf at a few chunk sizes. Streams read from and write to
+// memory without copying, so only the crypto path is timed. Prints
+// "<mode> <chunk KiB> <MB/s> <peak KiB allocated>" per mode. For the whole-buffer modes
+// the chunk is the payload itself, and the peak counts every heap allocation an operation
+// made on top of its input. Exits non-zero if a round trip differs, or if a tampered or
+// truncated stream decrypts.
+
+#include "crypto/crypto.hpp"
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+    // Live and peak heap bytes, tracked through the replaced global operator new below
+    std::atomic<size_t> g_liveBytes{ 0 };
+    std::atomic<size_t> g_peakBytes{ 0 };
+
+    void resetPeak()
+    {
+        g_peakBytes = g_liveBytes.load();
+    }
+}
+
+void* operator new(size_t size)
+{
+    void* block = std::malloc(size + sizeof(std::max_align_t));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    const size_t live = g_liveBytes += size;
+    size_t peak = g_peakBytes.load();
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live))
+    {
+    }
+    return static_cast<char*>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (!pointer)
+    {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - sizeof(std::max_align_t);
+    g_liveBytes -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const size_t CHUNK_SIZES[] = { 16 * 1024, Crypto::STREAM_CHUNK_SIZE, 1024 * 1024 };
+
+    // Reads straight from a caller-owned buffer
+    class MemoryReadBuf : public std::streambuf
+    {
+    public:
+        MemoryReadBuf(const char* data, size_t size)
+        {
+            char* begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+
+    // Appends to a caller-owned string, or only counts when there is none
+    class MemoryWriteBuf : public std::streambuf
+    {
+    public:
+        explicit MemoryWriteBuf(std::string* target) : m_target(target) {}
+
+        size_t written() const { return m_written; }
+
+    protected:
+        std::streamsize xsputn(const char* data, std::streamsize size) override
+        {
+            if (m_target)
+            {
+                m_target->append(data, static_cast<size_t>(size));
+            }
+            m_written += static_cast<size_t>(size);
+            return size;
+        }
+
+        int_type overflow(int_type c) override
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                const char ch = traits_type::to_char_type(c);
+                xsputn(&ch, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+    private:
+        std::string* m_target;
+        size_t m_written = 0;
+    };
+
+    struct Measurement
+    {
+        double mbPerSecond = 0.0;
+        size_t peakKiB = 0;
+    };
+
+    template <typename Operation>
+    Measurement measure(size_t payloadBytes, int rounds, Operation operation)
+    {
+        Measurement measurement;
+        double seconds = 0.0;
+        for (int round = 0; round < rounds; ++round)
+        {
+            const size_t before = g_liveBytes.load();
+            resetPeak();
+            const auto start = Clock::now();
+            operation();
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            measurement.peakKiB = (std::max)(measurement.peakKiB, (g_peakBytes.load() - before) / 1024);
+        }
+        measurement.mbPerSecond = static_cast<double>(payloadBytes) * rounds / seconds / 1e6;
+        return measurement;
+    }
+
+    void print(const char* mode, size_t chunkSize, const Measurement& measurement)
+    {
+        std::cout << mode << " " << chunkSize / 1024 << " " << static_cast<long long>(measurement.mbPerSecond)
+            << " " << measurement.peakKiB << std::endl;
+    }
+
+    std::string sealStream(const std::string& plaintext, const std::array<uint8_t, Crypto::KEY_SIZE>& key, size_t chunkSize)
+    {
+        std::string sealed;
+        MemoryWriteBuf sink(&sealed);
+        std::ostream out(&sink);
+        MemoryReadBuf source(plaintext.data(), plaintext.size());
+        std::istream in(&source);
+        Crypto::encryptStream(in, out, key, chunkSize);
+        return sealed;
+    }
+
+    bool opens(const std::string& sealed, const std::array<uint8_t, Crypto::KEY_SIZE>& key, std::string* plaintext)
+    {
+        try
+        {
+            MemoryWriteBuf sink(plaintext);
+            std::ostream out(&sink);
+            MemoryReadBuf source(sealed.data(), sealed.size());
+            std::istream in(&source);
+            Crypto::decryptStream(in, out, key);
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    int check(const std::string& payload, const std::array<uint8_t, Crypto::KEY_SIZE>& key)
+    {
+        int failures = 0;
+        auto expect = [&failures](bool ok, const std::string& what) {
+            if (!ok)
+            {
+                std::cout << "FAILED: " << what << std::endl;
+                ++failures;
+            }
+        };
+
+        for (size_t chunkSize : CHUNK_SIZES)
+        {
+            const std::string label = std::to_string(chunkSize / 1024) + " KiB chunks";
+            const std::string sealed = sealStream(payload, key, chunkSize);
+
+            std::string opened;
+            expect(opens(sealed, key, &opened) && opened == payload, "round trip with " + label);
+
+            std::string tampered = sealed;
+            tampered[Crypto::STREAM_HEADER_SIZE + 4 + tampered.size() / 3] ^= 0x01;
+            expect(!opens(tampered, key, nullptr), "a flipped bit is rejected with " + label);
+
+            // Cut at a chunk boundary: every remaining chunk is intact, only the final one is gone
+            const size_t framed = 4 + chunkSize + Crypto::TAG_SIZE;
+            if (payload.size() > chunkSize)
+            {
+                expect(!opens(sealed.substr(0, Crypto::STREAM_HEADER_SIZE + framed), key, nullptr),
+                    "a stream without its final chunk is rejected with " + label);
+            }
+        }
+
+        const std::vector<uint8_t> plaintext(payload.begin(), payload.end());
+        expect(Crypto::decrypt(Crypto::encrypt(plaintext, key), key) == plaintext, "whole-buffer round trip");
+        return failures;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: crypto_stream_bench <payload MiB> <rounds>\n";
+        return 2;
+    }
+
+    const size_t payloadBytes = static_cast<size_t>(std::stoul(argv[1])) * 1024 * 1024;
+    const int rounds = (std::max)(1, std::stoi(argv[2]));
+
+    std::array<uint8_t, Crypto::KEY_SIZE> key{};
+    for (size_t i = 0; i < key.size(); ++i)
+    {
+        key[i] = static_cast<uint8_t>(i * 11 + 3);
+    }
+
+    std::string payload(payloadBytes, '\0');
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+        payload[i] = static_cast<char>((i * 2654435761u) >> 13);
+    }
+
+    if (check(payload, key) != 0)
+    {
+        return 1;
+    }
+
+    // The old save path: serialized string -> plaintext vector -> ciphertext vector
+    const std::vector<uint8_t> whole = Crypto::encrypt(std::vector<uint8_t>(payload.begin(), payload.end()), key);
+    print("whole-encrypt", payloadBytes, measure(payloadBytes, rounds, [&]() {
+        const std::vector<uint8_t> plaintext(payload.begin(), payload.end());
+        const std::vector<uint8_t> encrypted = Crypto::encrypt(plaintext, key);
+        }));
+    print("whole-decrypt", payloadBytes, measure(payloadBytes, rounds, [&]() {
+        const std::vector<uint8_t> plaintext = Crypto::decrypt(whole, key);
+        }));
+
+    for (size_t chunkSize : CHUNK_SIZES)
+    {
+        const std::string sealed = sealStream(payload, key, chunkSize);
+        print("stream-encrypt", chunkSize, measure(payloadBytes, rounds, [&]() {
+            MemoryWriteBuf sink(nullptr);
+            std::ostream out(&sink);
+            Crypto::EncryptStreamBuf stream(out, key, chunkSize);
+            stream.sputn(payload.data(), static_cast<std::streamsize>(payload.size()));
+            stream.finish();
+            }));
+        print("stream-decrypt", chunkSize, measure(payloadBytes, rounds, [&]() {
+            opens(sealed, key, nullptr);
+            }));
+    }
+    return 0;
+}
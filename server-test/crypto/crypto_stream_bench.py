@@ -0,0 +1,53 @@
+"""
+Runs crypto_stream_bench over a few payload sizes and prints MB/s and peak allocation for
+whole-buffer Crypto::encrypt/decrypt and for chunked streams at several chunk sizes.
+
+Build crypto_stream_bench.cpp first (see the top of that file), then run
+    python crypto_stream_bench.py path/to/crypto_stream_bench
+
+Fails if a round-trip or tamper check fails, or if a stream allocated more than a few
+chunks at once, since stream memory must not grow with the payload.
+"""
+
+import os
+import subprocess
+import sys
+
+# (payload MiB, rounds)
+PAYLOADS = [(1, 50), (16, 5), (128, 2)]
+# Plaintext and sealed buffers of one chunk each, plus the stream objects themselves
+MAX_STREAM_CHUNKS = 3
+STREAM_OVERHEAD_KIB = 64
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python crypto_stream_bench.py path/to/crypto_stream_bench")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    failures = 0
+
+    print(f"{'payload':>8}  {'mode':15} {'chunk KiB':>9} {'MB/s':>7} {'peak KiB':>9}")
+    for mib, rounds in PAYLOADS:
+        result = subprocess.run([binary, str(mib), str(rounds)], stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT, text=True, timeout=600)
+        for line in result.stdout.splitlines():
+            parts = line.split()
+            if len(parts) != 4 or line.startswith("FAILED"):
+                print(line)
+                continue
+            mode, chunk_kib, mb_per_second, peak_kib = parts[0], int(parts[1]), int(parts[2]), int(parts[3])
+            print(f"{mib:>5} MiB  {mode:15} {chunk_kib:>9} {mb_per_second:>7} {peak_kib:>9}")
+            if mode.startswith("stream") and peak_kib > MAX_STREAM_CHUNKS * chunk_kib + STREAM_OVERHEAD_KIB:
+                print(f"  {mode} held {peak_kib} KiB for {chunk_kib} KiB chunks")
+                failures += 1
+        if result.returncode != 0:
+            failures += 1
+
+    print(f"{len(PAYLOADS)} payload sizes, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
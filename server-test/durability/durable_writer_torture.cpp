@@ -0,0 +1,153 @@
+// Child process for torture.py. Build it against the app's include directory, e.g.
+//   cl /std:c++17 /EHsc /I ..\..\include durable_writer_torture.cpp
+//   g++ -std=c++17 -pthread -I ../../include durable_writer_torture.cpp -o durable_writer_torture
+//
+//   durable_writer_torture <dir> write   rewrites a few files through DurableWriter until
+//                                        killed, printing "<file> <version>" after each
+//                                        write() has returned
+//   durable_writer_torture <dir> check   sweeps stale temp files like a persistence load
+//                                        does, then prints "<file> <version>" for every
+//                                        intact file, "BAD <file>" for a torn one and
+//                                        "TEMP <name>" for any temp file still there
+
+#include "durable_writer.hpp"
+
+#include <random>
+#include <sstream>
+#include <cstdint>
+#include <iostream>
+
+namespace
+{
+    constexpr int FILES = 8;
+
+    uint64_t checksum(const std::string& data)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : data)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::filesystem::path fileFor(const std::filesystem::path& dir, int index)
+    {
+        return dir / ("file" + std::to_string(index) + ".dat");
+    }
+
+    // "v<version>\n<payload>\nend <checksum of payload>\n", with a payload of up to ~1 MB
+    std::string contentsFor(uint64_t version)
+    {
+        std::mt19937_64 random(version);
+        std::string payload(static_cast<size_t>(random() % (1 << 20)), '\0');
+        for (auto& c : payload)
+        {
+            c = static_cast<char>('a' + random() % 26);
+        }
+        return "v" + std::to_string(version) + "\n" + payload + "\nend " + std::to_string(checksum(payload)) + "\n";
+    }
+
+    // The version stored in the file, or -1 if it is torn or corrupt
+    long long readVersion(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        const size_t header = contents.find('\n');
+        const size_t footer = contents.rfind("\nend ");
+        if (contents.size() < 2 || contents[0] != 'v' || header == std::string::npos ||
+            footer == std::string::npos || footer < header || contents.back() != '\n')
+        {
+            return -1;
+        }
+
+        const std::string payload = contents.substr(header + 1, footer - header - 1);
+        const std::string stored = contents.substr(footer + 5, contents.size() - footer - 6);
+        if (stored != std::to_string(checksum(payload)))
+        {
+            return -1;
+        }
+        return std::stoll(contents.substr(1, header - 1));
+    }
+
+    int runWriter(const std::filesystem::path& dir)
+    {
+        // Carry on from the newest version already on disk, so versions only ever grow
+        uint64_t version = 0;
+        for (int i = 0; i < FILES; ++i)
+        {
+            version = (std::max)(version, static_cast<uint64_t>((std::max)(0LL, readVersion(fileFor(dir, i)))));
+        }
+
+        while (true)
+        {
+            ++version;
+            const int index = static_cast<int>(version % FILES);
+            if (!DurableWriter::instance().write(fileFor(dir, index), contentsFor(version)))
+            {
+                std::cout << "FAILED " << index << " " << version << std::endl;
+                return 1;
+            }
+            std::cout << index << " " << version << std::endl;
+        }
+    }
+
+    int runCheck(const std::filesystem::path& dir)
+    {
+        DurableWriter::instance().removeStaleTemps(dir);
+
+        for (int i = 0; i < FILES; ++i)
+        {
+            const auto path = fileFor(dir, i);
+            if (!std::filesystem::exists(path))
+            {
+                continue;
+            }
+            const long long version = readVersion(path);
+            if (version < 0)
+            {
+                std::cout << "BAD " << i << std::endl;
+            }
+            else
+            {
+                std::cout << i << " " << version << std::endl;
+            }
+        }
+
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.path().filename().string().find(".tmp") != std::string::npos)
+            {
+                std::cout << "TEMP " << entry.path().filename().string() << std::endl;
+            }
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: durable_writer_torture <dir> write|check\n";
+        return 2;
+    }
+
+    const std::filesystem::path dir = argv[1];
+    std::filesystem::create_directories(dir);
+
+    const std::string mode = argv[2];
+    if (mode == "write")
+    {
+        return runWriter(dir);
+    }
+    if (mode == "check")
+    {
+        return runCheck(dir);
+    }
+
+    std::cerr << "unknown mode: " << mode << "\n";
+    return 2;
+}
@@ -0,0 +1,96 @@
+// Benchmark for the GGUF readers. Run it through gguf_reader_bench.py, or build it against
+// the app's include directory and libcurl, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include\model /I ..\..\external\curl\include gguf_reader_bench.cpp /link /LIBPATH:..\..\external\curl\lib libcurl.lib
+//   g++ -std=c++17 -O2 -I ../../include/model gguf_reader_bench.cpp -lcurl -o gguf_reader_bench
+//
+//   gguf_reader_bench <rounds> <file.gguf>...
+//
+// Times three ways of reading each file, averaged over <rounds>:
+//   streamed   readModelParams over a FileDataSource: one read per field, and arrays such
+//              as the tokenizer vocab skipped element by element, stopping once the model
+//              parameters are known. This is how local files were read before GGUFFile,
+//              and how URLs still are.
+//   params     readModelParams on the path, which maps the file through GGUFFile
+//   full       constructing a GGUFFile: every metadata value and the whole tensor table
+// Prints "<file> <metadata keys> <tensors> <streamed ms> <params ms> <full ms>" per file
+// and exits non-zero if a file fails to parse or the two readers disagree.
+
+#include "gguf_reader.hpp"
+
+#include <chrono>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    template <typename Read>
+    double meanMs(int rounds, Read read)
+    {
+        read();
+        const auto start = Clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+            read();
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / rounds;
+    }
+
+    bool sameParams(const GGUFModelParams& a, const GGUFModelParams& b)
+    {
+        return a.hidden_size == b.hidden_size && a.attention_heads == b.attention_heads &&
+            a.hidden_layers == b.hidden_layers && a.kv_heads == b.kv_heads;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: gguf_reader_bench <rounds> <file.gguf>...\n";
+        return 2;
+    }
+
+    const int rounds = (std::max)(1, std::stoi(argv[1]));
+    GGUFMetadataReader reader;
+    int failures = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string path = argv[i];
+        try
+        {
+            FileDataSource first(path);
+            const auto streamed = reader.readModelParams(first);
+            const auto mapped = reader.readModelParams(path);
+            if (!streamed && !mapped)
+            {
+                std::cout << "FAILED: " << path << ": neither reader could read it" << std::endl;
+                ++failures;
+                continue;
+            }
+            if (!streamed || !mapped || !sameParams(*streamed, *mapped))
+            {
+                std::cout << "FAILED: " << path << ": the streamed and mapped readers disagree" << std::endl;
+                ++failures;
+                continue;
+            }
+
+            const GGUFFile file(path);
+            const double streamedMs = meanMs(rounds, [&]() {
+                FileDataSource source(path);
+                reader.readModelParams(source);
+            });
+            const double paramsMs = meanMs(rounds, [&]() { reader.readModelParams(path); });
+            const double fullMs = meanMs(rounds, [&]() { GGUFFile parsed(path); });
+
+            std::cout << path << " " << file.metadata().size() << " " << file.tensors().size() << " "
+                << streamedMs << " " << paramsMs << " " << fullMs << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "FAILED: " << path << ": " << e.what() << std::endl;
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+"""
+Times the GGUF readers with gguf_reader_bench: the streamed reader local files used to go
+through, readModelParams over GGUFFile, and a full GGUFFile parse of the metadata and
+tensor table.
+
+Build gguf_reader_bench.cpp first (see the top of that file), then run
+    python gguf_reader_bench.py path/to/gguf_reader_bench [model.gguf ...]
+
+With no models given it writes synthetic headers shaped like Llama 3 8B and Qwen2 7B,
+with a 128k or 152k tokenizer vocab and a full tensor table, as sparse files of the real
+size. One of them puts the tokenizer before the architecture keys, which is the case
+where the streamed reader has to skip the whole vocab. Fails if any file fails to parse
+or the readers disagree on the model parameters.
+"""
+
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+ROUNDS = 5
+
+TYPES = {"u32": 4, "i32": 5, "f32": 6, "str": 8, "arr": 9}
+GGML_TYPE_Q4_K = 12
+
+
+def gguf_string(value):
+    data = value.encode()
+    return struct.pack("<Q", len(data)) + data
+
+
+def kv(key, kind, value):
+    out = gguf_string(key) + struct.pack("<I", TYPES[kind])
+    if kind in ("u32", "i32", "f32"):
+        out += struct.pack({"u32": "<I", "i32": "<i", "f32": "<f"}[kind], value)
+    elif kind == "str":
+        out += gguf_string(value)
+    else:
+        element, values = value
+        out += struct.pack("<IQ", TYPES[element], len(values))
+        if element == "str":
+            out += b"".join(gguf_string(v) for v in values)
+        else:
+            out += struct.pack("<%d%s" % (len(values), "i" if element == "i32" else "f"), *values)
+    return out
+
+
+def write_synthetic(path, arch, vocab, merges, layers, embedding, heads, kv_heads, tokenizer_first, size):
+    rng = random.Random(1)
+    tokens = ["".join(rng.choice("abcdefghijklmnopqrstuvwxyz") for _ in range(rng.randint(1, 9)))
+              for _ in range(vocab)]
+    merge_rules = [tokens[rng.randrange(vocab)] + " " + tokens[rng.randrange(vocab)] for _ in range(merges)]
+
+    general = [kv("general.architecture", "str", arch), kv("general.name", "str", "Synthetic"),
+               kv("general.file_type", "u32", 15)]
+    hyper = [kv(arch + ".block_count", "u32", layers), kv(arch + ".context_length", "u32", 8192),
+             kv(arch + ".embedding_length", "u32", embedding), kv(arch + ".feed_forward_length", "u32", 14336),
+             kv(arch + ".attention.head_count", "u32", heads), kv(arch + ".attention.head_count_kv", "u32", kv_heads),
+             kv(arch + ".rope.freq_base", "f32", 500000.0),
+             kv(arch + ".attention.layer_norm_rms_epsilon", "f32", 1e-5)]
+    tokenizer = [kv("tokenizer.ggml.model", "str", "gpt2"), kv("tokenizer.ggml.tokens", "arr", ("str", tokens)),
+                 kv("tokenizer.ggml.token_type", "arr", ("i32", [1] * vocab)),
+                 kv("tokenizer.ggml.merges", "arr", ("str", merge_rules)),
+                 kv("tokenizer.ggml.bos_token_id", "u32", 1), kv("tokenizer.ggml.eos_token_id", "u32", 2)]
+    metadata = general + (tokenizer + hyper if tokenizer_first else hyper + tokenizer)
+
+    shapes = [("token_embd.weight", [embedding, vocab])]
+    for layer in range(layers):
+        for name, shape in [("attn_q", [embedding, embedding]), ("attn_k", [embedding, embedding // 4]),
+                            ("attn_v", [embedding, embedding // 4]), ("attn_output", [embedding, embedding]),
+                            ("ffn_gate", [embedding, 14336]), ("ffn_up", [embedding, 14336]),
+                            ("ffn_down", [14336, embedding]), ("attn_norm", [embedding]), ("ffn_norm", [embedding])]:
+            shapes.append(("blk.%d.%s.weight" % (layer, name), shape))
+    shapes += [("output_norm.weight", [embedding]), ("output.weight", [embedding, vocab])]
+
+    table = b""
+    offset = 0
+    for name, shape in shapes:
+        table += gguf_string(name) + struct.pack("<I", len(shape))
+        table += b"".join(struct.pack("<Q", d) for d in shape) + struct.pack("<IQ", GGML_TYPE_Q4_K, offset)
+        elements = 1
+        for d in shape:
+            elements *= d
+        offset += (elements * 9 // 16 + 31) // 32 * 32
+
+    header = b"GGUF" + struct.pack("<IQQ", 3, len(shapes), len(metadata)) + b"".join(metadata) + table
+    with open(path, "wb") as f:
+        f.write(header)
+        f.truncate(max(size, len(header)))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python gguf_reader_bench.py path/to/gguf_reader_bench [model.gguf ...]")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    models = [os.path.abspath(p) for p in sys.argv[2:]]
+    directory = None
+
+    try:
+        if not models:
+            directory = tempfile.mkdtemp(prefix="gguf_reader_bench_")
+            for name, args in [("llama3-8b.gguf", ("llama", 128256, 280147, 32, 4096, 32, 8, False, 4_920_000_000)),
+                               ("qwen2-7b.gguf", ("qwen2", 151936, 151387, 28, 3584, 28, 4, False, 4_680_000_000)),
+                               ("llama3-8b-tokenizer-first.gguf",
+                                ("llama", 128256, 280147, 32, 4096, 32, 8, True, 4_920_000_000))]:
+                models.append(os.path.join(directory, name))
+                write_synthetic(models[-1], *args)
+
+        # The readers log their own errors to stderr, which is passed through
+        result = subprocess.run([binary, str(ROUNDS)] + models, stdout=subprocess.PIPE, text=True, timeout=3600)
+        print(f"{'file':34} {'keys':>5} {'tensors':>8} {'streamed ms':>12} {'params ms':>10} {'full ms':>8}")
+        failures = 0
+        for line in result.stdout.splitlines():
+            parts = line.rsplit(" ", 5)
+            if len(parts) != 6 or line.startswith("FAILED"):
+                print(line)
+                failures += 1
+                continue
+            print(f"{os.path.basename(parts[0]):34} {parts[1]:>5} {parts[2]:>8} {float(parts[3]):12.2f} "
+                  f"{float(parts[4]):10.2f} {float(parts[5]):8.2f}")
+
+        if result.returncode != 0 and failures == 0:
+            failures = 1
+        print(f"{len(models)} files, {failures} failures")
+        return 1 if failures else 0
+    finally:
+        if directory:
+            shutil.rmtree(directory, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,213 @@
+// Contention benchmark for JobRegistry. Run it through job_registry_bench.py, or build it
+// against the app's include directory, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include\model job_registry_bench.cpp
+//   g++ -std=c++17 -O2 -pthread -I ../../include/model job_registry_bench.cpp -o job_registry_bench
+//
+//   job_registry_bench <threads> <jobs per thread> <models>
+//
+// Every thread plays the fake jobs of one server request after another: register the job,
+// check its cancel token the way a streaming step does, then remove it, while one more
+// thread keeps cancelling jobs that may or may not exist. Job ids restart at 0 for every
+// model, as they do per engine. The same load then runs against the old layout, a job id
+// vector and an active-job map behind one shared mutex, for comparison.
+//
+// Before timing anything it checks that jobs of different models with the same id stay
+// apart and that duplicates are refused. Prints "<layout> <threads> <jobs/s>" lines and
+// exits non-zero if a check fails.
+
+#include "job_registry.hpp"
+
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <shared_mutex>
+
+namespace
+{
+    constexpr int STEPS_PER_JOB = 8;
+
+    std::string modelName(int index)
+    {
+        return "model-" + std::to_string(index) + ":Q4_K_M";
+    }
+
+    // What ModelManager used before the registry: every change takes the global lock
+    class GlobalLockRegistry
+    {
+    public:
+        std::shared_ptr<std::atomic<bool>> add(const std::string&, int jobId)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            m_jobIds.push_back(jobId);
+            auto token = std::make_shared<std::atomic<bool>>(true);
+            m_activeJobs[jobId] = token;
+            return token;
+        }
+
+        void remove(const std::string&, int jobId)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            m_jobIds.erase(std::remove(m_jobIds.begin(), m_jobIds.end(), jobId), m_jobIds.end());
+            m_activeJobs.erase(jobId);
+        }
+
+        void cancel(const std::string&, int jobId)
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_activeJobs.find(jobId);
+            if (it != m_activeJobs.end())
+            {
+                it->second->store(false);
+            }
+        }
+
+        // The streaming loops took the shared lock on every tick
+        bool isActive(const std::string&, int jobId, const std::shared_ptr<std::atomic<bool>>&)
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            auto it = m_activeJobs.find(jobId);
+            return it != m_activeJobs.end() && it->second->load();
+        }
+
+    private:
+        std::shared_mutex m_mutex;
+        std::vector<int> m_jobIds;
+        std::unordered_map<int, std::shared_ptr<std::atomic<bool>>> m_activeJobs;
+    };
+
+    // The registry as ModelManager uses it: hot loops only load their token
+    class ShardedRegistry
+    {
+    public:
+        Model::JobRegistry::CancelToken add(const std::string& modelId, int jobId)
+        {
+            return m_registry.add(modelId, jobId);
+        }
+
+        void remove(const std::string& modelId, int jobId) { m_registry.remove(modelId, jobId); }
+        void cancel(const std::string& modelId, int jobId) { m_registry.cancel(modelId, jobId); }
+
+        bool isActive(const std::string&, int, const Model::JobRegistry::CancelToken& token)
+        {
+            return token->load(std::memory_order_acquire);
+        }
+
+        size_t size() const { return m_registry.size(); }
+
+    private:
+        Model::JobRegistry m_registry;
+    };
+
+    template <typename Registry>
+    double run(int threads, int jobsPerThread, int models)
+    {
+        Registry registry;
+        std::vector<std::atomic<int>> nextJobId(models);
+        std::atomic<bool> stop{ false };
+        std::atomic<long long> activeSteps{ 0 };
+
+        std::thread canceller([&]() {
+            unsigned int seed = 12345;
+            while (!stop)
+            {
+                seed = seed * 1103515245u + 12345u;
+                const int model = static_cast<int>(seed % models);
+                registry.cancel(modelName(model), nextJobId[model].load() - 1);
+                std::this_thread::yield();
+            }
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                const std::string model = modelName(t % models);
+                long long steps = 0;
+                for (int i = 0; i < jobsPerThread; ++i)
+                {
+                    const int jobId = nextJobId[t % models].fetch_add(1);
+                    auto token = registry.add(model, jobId);
+                    for (int step = 0; step < STEPS_PER_JOB; ++step)
+                    {
+                        steps += registry.isActive(model, jobId, token) ? 1 : 0;
+                    }
+                    registry.remove(model, jobId);
+                }
+                activeSteps += steps;
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        stop = true;
+        canceller.join();
+        return static_cast<double>(threads) * jobsPerThread / seconds;
+    }
+
+    int check()
+    {
+        int failures = 0;
+        auto expect = [&failures](bool ok, const char* what) {
+            if (!ok)
+            {
+                std::cout << "FAILED: " << what << std::endl;
+                ++failures;
+            }
+        };
+
+        Model::JobRegistry registry;
+        auto a = registry.add("a:Q4", 0);
+        auto b = registry.add("b:Q4", 0);
+        expect(registry.size() == 2, "two models may both run job 0");
+
+        registry.cancel("a:Q4", 0);
+        expect(!a->load() && b->load(), "cancelling a's job 0 leaves b's job 0 running");
+        expect(!registry.isActive("a:Q4", 0) && registry.isActive("b:Q4", 0), "isActive follows the model");
+
+        bool refused = false;
+        try
+        {
+            registry.add("b:Q4", 0);
+        }
+        catch (const std::logic_error&)
+        {
+            refused = true;
+        }
+        expect(refused && registry.size() == 2, "a duplicate is refused and not counted");
+
+        registry.remove("a:Q4", 0);
+        registry.remove("a:Q4", 0);
+        expect(registry.size() == 1, "removing twice counts once");
+
+        const auto cancelled = registry.cancelAll();
+        expect(cancelled.size() == 1 && cancelled[0].modelId == "b:Q4" && !b->load(), "cancelAll reports model and id");
+        return failures;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << "usage: job_registry_bench <threads> <jobs per thread> <models>\n";
+        return 2;
+    }
+
+    const int threads = std::stoi(argv[1]);
+    const int jobsPerThread = std::stoi(argv[2]);
+    const int models = (std::max)(1, std::stoi(argv[3]));
+
+    if (check() != 0)
+    {
+        return 1;
+    }
+
+    std::cout << "global-lock " << threads << " " << static_cast<long long>(run<GlobalLockRegistry>(threads, jobsPerThread, models)) << std::endl;
+    std::cout << "sharded " << threads << " " << static_cast<long long>(run<ShardedRegistry>(threads, jobsPerThread, models)) << std::endl;
+    return 0;
+}
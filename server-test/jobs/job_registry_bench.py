@@ -0,0 +1,43 @@
+"""
+Runs job_registry_bench at increasing thread counts and prints the job throughput of the
+sharded JobRegistry next to the old global-lock layout.
+
+Build job_registry_bench.cpp first (see the top of that file), then run
+    python job_registry_bench.py path/to/job_registry_bench [jobs per thread] [models]
+"""
+
+import os
+import subprocess
+import sys
+
+THREADS = [1, 2, 4, 8, 16, 32, 64]
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python job_registry_bench.py path/to/job_registry_bench [jobs per thread] [models]")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    jobs = sys.argv[2] if len(sys.argv) > 2 else "50000"
+    models = sys.argv[3] if len(sys.argv) > 3 else "4"
+
+    print(f"{os.cpu_count()} CPUs, {jobs} jobs per thread, {models} models")
+    print(f"{'threads':>8} {'global lock':>14} {'sharded':>14} {'speedup':>8}")
+    for threads in THREADS:
+        result = subprocess.run([binary, str(threads), jobs, models], stdout=subprocess.PIPE, text=True)
+        if result.returncode != 0:
+            print(result.stdout, end="")
+            return 1
+
+        rates = {}
+        for line in result.stdout.splitlines():
+            layout, _, rate = line.split()
+            rates[layout] = int(rate)
+        print(f"{threads:>8} {rates['global-lock']:>12}/s {rates['sharded']:>12}/s "
+              f"{rates['sharded'] / rates['global-lock']:>7.1f}x")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,42 @@
+"""
+Runs stream_cancel_test over a range of abort points and idle timeouts. Each run streams
+from a fake engine to a client that leaves after N chunks, and checks that the job is
+stopped right away when the disconnect is reported, and by the idle reaper otherwise.
+
+Build stream_cancel_test.cpp first (see the top of that file), then run
+    python stream_cancel.py path/to/stream_cancel_test
+"""
+
+import os
+import subprocess
+import sys
+
+ABORT_AFTER_CHUNKS = [0, 1, 5, 50, 500]
+IDLE_TIMEOUTS_MS = [100, 300]
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python stream_cancel.py path/to/stream_cancel_test")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    failures = 0
+    runs = 0
+
+    for timeout in IDLE_TIMEOUTS_MS:
+        for chunks in ABORT_AFTER_CHUNKS:
+            result = subprocess.run([binary, str(chunks), str(timeout)], stdout=subprocess.PIPE,
+                                    stderr=subprocess.STDOUT, text=True, timeout=60)
+            runs += 1
+            for line in result.stdout.splitlines():
+                print(f"abort after {chunks} chunks, idle timeout {timeout} ms: {line}")
+            if result.returncode != 0:
+                failures += 1
+
+    print(f"{runs} runs, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,256 @@
+// Streams from a fake engine to a client that goes away after a few chunks, and checks
+// that the job is stopped through the same StreamReaper calls ModelManager makes. Run it
+// through stream_cancel.py, or build it against the app's include directory, e.g.
+//   cl /std:c++17 /EHsc /I ..\..\include\model stream_cancel_test.cpp
+//   g++ -std=c++17 -pthread -I ../../include/model stream_cancel_test.cpp -o stream_cancel_test
+//
+//   stream_cancel_test <chunks before the client aborts> <idle timeout ms>
+//
+// Two cases run, each with a first token slower than the idle timeout, so a stream whose
+// client is waiting must not be reaped:
+//   disconnect   the client reports that it is gone, as cancelStreamingRequest does
+//   reaper       the client just stops pulling, and the idle reaper has to notice
+// Prints one line per case and exits non-zero if a check fails.
+
+#include "stream_reaper.hpp"
+#include "stream_chunk_buffer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <optional>
+#include <iostream>
+#include <condition_variable>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::milliseconds;
+
+    // Same fields as ModelManager's streaming contexts
+    struct StreamContext
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        Model::StreamChunkBuffer chunks;
+        std::string model;
+        int jobId = -1;
+        std::string errorMessage;
+        bool finished = false;
+        bool error = false;
+        Clock::time_point lastPull = Clock::now();
+        int pullsWaiting = 0;
+        size_t generatedTokens = 0;
+    };
+
+    using Contexts = std::unordered_map<std::string, std::shared_ptr<StreamContext>>;
+
+    // Produces one token per interval into the context until stopped or out of tokens
+    class FakeEngine
+    {
+    public:
+        FakeEngine(std::shared_ptr<StreamContext> ctx, Milliseconds firstToken, Milliseconds perToken, size_t tokens)
+            : m_thread([this, ctx, firstToken, perToken, tokens]() {
+                std::this_thread::sleep_for(firstToken);
+                for (size_t i = 0; i < tokens && !m_stopped; ++i)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(ctx->mtx);
+                        if (!ctx->chunks.full())
+                        {
+                            ctx->chunks.push("token" + std::to_string(i) + " ");
+                        }
+                        ++ctx->generatedTokens;
+                    }
+                    ctx->cv.notify_all();
+                    std::this_thread::sleep_for(perToken);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(ctx->mtx);
+                    ctx->finished = true;
+                }
+                ctx->cv.notify_all();
+            })
+        {
+        }
+
+        ~FakeEngine()
+        {
+            stop();
+            m_thread.join();
+        }
+
+        // What ModelManager::cancelJob amounts to for this engine
+        void stop()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_stopped.exchange(true))
+            {
+                m_stoppedAt = Clock::now();
+            }
+        }
+
+        std::optional<Clock::time_point> stoppedAt() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stopped ? std::optional<Clock::time_point>(m_stoppedAt) : std::nullopt;
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::atomic<bool>  m_stopped{ false };
+        Clock::time_point  m_stoppedAt;
+        std::thread        m_thread;
+    };
+
+    // The chunk loop of a streaming handler: one pull per chunk, waiting like the server does
+    bool pullChunk(StreamContext& ctx, size_t chunkIndex, Milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(ctx.mtx);
+        ctx.lastPull = Clock::now();
+        ++ctx.pullsWaiting;
+        const bool ready = ctx.cv.wait_for(lock, timeout, [&ctx, chunkIndex]() {
+            return ctx.chunks.pushedCount() > chunkIndex || ctx.finished || ctx.error;
+        });
+        --ctx.pullsWaiting;
+        ctx.lastPull = Clock::now();
+        return ready && !ctx.error && ctx.chunks.take(chunkIndex).has_value();
+    }
+
+    struct Outcome
+    {
+        bool   stopped = false;
+        bool   streamRemoved = false;
+        bool   pendingPullFailed = true;
+        long long stopLatencyMs = -1;
+        size_t tokensAtCancel = 0;
+    };
+
+    Outcome run(bool reportDisconnect, size_t chunksBeforeAbort, Milliseconds idleTimeout)
+    {
+        const std::string requestId = "req-1";
+        const Milliseconds reaperInterval = (std::max)(idleTimeout / 4, Milliseconds(1));
+        const Milliseconds chunkTimeout = idleTimeout * 20;
+
+        std::mutex contextsMutex;
+        Contexts contexts;
+        auto ctx = std::make_shared<StreamContext>();
+        ctx->model = "fake:Q4";
+        ctx->jobId = 7;
+        contexts[requestId] = ctx;
+
+        FakeEngine engine(ctx, idleTimeout * 2, Milliseconds(2), 1000000);
+        Outcome outcome;
+        std::mutex outcomeMutex;
+
+        auto cancel = [&](const std::shared_ptr<StreamContext>& stream, const char* reason) {
+            if (auto cancelled = Model::StreamReaper::cancel(*stream, reason))
+            {
+                engine.stop();
+                std::lock_guard<std::mutex> lock(outcomeMutex);
+                outcome.tokensAtCancel = cancelled->generatedTokens;
+            }
+        };
+
+        std::atomic<bool> reaperStop{ false };
+        std::thread reaper([&]() {
+            while (!reaperStop)
+            {
+                std::this_thread::sleep_for(reaperInterval);
+                for (const auto& [id, stream] : Model::StreamReaper::takeIdle(contextsMutex, contexts, idleTimeout))
+                {
+                    cancel(stream, "client stopped reading");
+                }
+            }
+        });
+
+        for (size_t i = 0; i < chunksBeforeAbort; ++i)
+        {
+            if (!pullChunk(*ctx, i, chunkTimeout))
+            {
+                std::cerr << "chunk " << i << " failed before the client aborted\n";
+                break;
+            }
+        }
+        const Clock::time_point abortedAt = Clock::now();
+
+        if (reportDisconnect)
+        {
+            // A pull for the next chunk is already waiting when the disconnect is reported;
+            // it has to fail rather than sit out the chunk timeout
+            std::thread waiter([&]() {
+                const bool got = pullChunk(*ctx, SIZE_MAX, chunkTimeout);
+                std::lock_guard<std::mutex> lock(outcomeMutex);
+                outcome.pendingPullFailed = !got;
+            });
+            std::this_thread::sleep_for(Milliseconds(5));
+            if (auto stream = Model::StreamReaper::take(contextsMutex, contexts, requestId))
+            {
+                cancel(stream, "client disconnected");
+            }
+            waiter.join();
+        }
+
+        const auto deadline = abortedAt + idleTimeout * 10;
+        while (!engine.stoppedAt() && Clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(Milliseconds(1));
+        }
+
+        reaperStop = true;
+        reaper.join();
+
+        if (const auto stoppedAt = engine.stoppedAt())
+        {
+            outcome.stopped = true;
+            outcome.stopLatencyMs = std::chrono::duration_cast<Milliseconds>(*stoppedAt - abortedAt).count();
+        }
+        {
+            std::lock_guard<std::mutex> lock(contextsMutex);
+            outcome.streamRemoved = contexts.empty();
+        }
+        return outcome;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: stream_cancel_test <chunks before abort> <idle timeout ms>\n";
+        return 2;
+    }
+
+    const size_t chunks = std::stoul(argv[1]);
+    const Milliseconds idleTimeout(std::stoll(argv[2]));
+    int failures = 0;
+
+    for (const bool reportDisconnect : { true, false })
+    {
+        const Outcome outcome = run(reportDisconnect, chunks, idleTimeout);
+
+        // A reported disconnect stops the job at once; the reaper needs the idle timeout plus
+        // a reaper interval, and both get slack for a loaded machine
+        const long long limitMs = reportDisconnect ? 100 : idleTimeout.count() * 2 + 100;
+        const bool ok = outcome.stopped && outcome.streamRemoved && outcome.pendingPullFailed &&
+            outcome.stopLatencyMs <= limitMs && outcome.tokensAtCancel >= chunks;
+
+        std::cout << (reportDisconnect ? "disconnect" : "reaper") << ": "
+            << (ok ? "ok" : "FAILED") << ", stopped " << outcome.stopLatencyMs
+            << " ms after the client left (limit " << limitMs << " ms), "
+            << outcome.tokensAtCancel << " tokens generated, stream "
+            << (outcome.streamRemoved ? "removed" : "still open");
+        if (reportDisconnect)
+        {
+            std::cout << ", pending pull " << (outcome.pendingPullFailed ? "failed" : "still waiting");
+        }
+        std::cout << std::endl;
+
+        if (!ok)
+        {
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,410 @@
+// Latency benchmark for job streaming. Run it through token_latency_bench.py, or build it
+// against the app's include directories, e.g.
+//   cl /std:c++17 /EHsc /O2 /I ..\..\include /I ..\..\include\model /I ..\..\external\genta-personal\include token_latency_bench.cpp
+//   g++ -std=c++17 -O2 -pthread -I ../../include -I ../../include/model -I ../../external/genta-personal/include token_latency_bench.cpp -o token_latency_bench
+//
+//   token_latency_bench <concurrent jobs> <tokens per job> <first token ms> <token interval ms>
+//
+// A fake engine produces tokens on a timer, and each job is consumed three ways:
+//   sleep-poll      the loop ModelManager used to run: read the result, sleep 100 ms
+//   notifier-poll   JobPump woken by JobNotifier's polling fallback, as with today's DLL
+//   notifier-push   JobPump woken by the engine through IInferenceEngineStreamingExt
+// For every token it records when the engine produced it and when the consumer first saw
+// it. Prints "<mode> ttft <ms> delay p50 <ms> p95 <ms> max <ms>" per mode, where ttft is
+// from submitting the job to seeing its first token, and exits non-zero if a consumer
+// misses, repeats or reorders tokens.
+
+#include "job_pump.hpp"
+#include "job_notifier.hpp"
+
+#include <map>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::milliseconds;
+
+    constexpr Milliseconds OLD_POLL_INTERVAL(100);
+    constexpr size_t PUMP_THREADS = 4;
+
+    double toMs(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // Appends one token per interval to every submitted job; with push enabled it also
+    // implements the streaming extension
+    class FakeEngine : public IInferenceEngine, public Model::IInferenceEngineStreamingExt
+    {
+    public:
+        FakeEngine(size_t tokens, Milliseconds firstToken, Milliseconds interval, bool push)
+            : m_tokens(tokens), m_firstToken(firstToken), m_interval(interval), m_push(push)
+        {
+        }
+
+        ~FakeEngine() override
+        {
+            for (auto& [id, job] : m_jobs)
+            {
+                job->stopped = true;
+            }
+            for (auto& [id, job] : m_jobs)
+            {
+                job->thread.join();
+            }
+        }
+
+        static Model::IInferenceEngineStreamingExt* resolve(IInferenceEngine* engine)
+        {
+            auto* fake = dynamic_cast<FakeEngine*>(engine);
+            return fake && fake->m_push ? fake : nullptr;
+        }
+
+        bool loadModel(const char*, const LoadingParameters, const int) override { return true; }
+        bool unloadModel() override { return true; }
+        int submitChatCompletionsJob(const ChatCompletionParameters&) override { return submit(); }
+
+        int submitCompletionsJob(const CompletionParameters&) override { return submit(); }
+
+        void stopJob(int jobId) override { job(jobId).stopped = true; }
+
+        bool isJobFinished(int jobId) override
+        {
+            Job& j = job(jobId);
+            std::lock_guard<std::mutex> lock(j.mutex);
+            return j.finished;
+        }
+
+        CompletionResult getJobResult(int jobId) override
+        {
+            Job& j = job(jobId);
+            std::lock_guard<std::mutex> lock(j.mutex);
+            return j.result;
+        }
+
+        void waitForJob(int jobId) override
+        {
+            while (!isJobFinished(jobId))
+            {
+                std::this_thread::sleep_for(Milliseconds(1));
+            }
+        }
+
+        bool hasJobError(int) override { return false; }
+        std::string getJobError(int) override { return std::string(); }
+
+        // The callback mutex is separate from the result mutex, so callbacks run without
+        // the lock readers take, and unregistering still waits for a running callback
+        bool setJobUpdateCallback(int jobId, Model::JobUpdateCallback callback, void* userData) override
+        {
+            Job& j = job(jobId);
+            std::lock_guard<std::mutex> lock(j.callbackMutex);
+            j.callback = callback;
+            j.userData = userData;
+            return true;
+        }
+
+        bool getJobResultSince(int jobId, size_t tokenOffset, size_t textOffset, CompletionResult& delta) override
+        {
+            Job& j = job(jobId);
+            std::lock_guard<std::mutex> lock(j.mutex);
+            if (j.result.tokens.size() > tokenOffset)
+            {
+                delta.tokens.assign(j.result.tokens.begin() + tokenOffset, j.result.tokens.end());
+            }
+            if (j.result.text.size() > textOffset)
+            {
+                delta.text = j.result.text.substr(textOffset);
+            }
+            delta.tps = j.result.tps;
+            return true;
+        }
+
+        Clock::time_point submittedAt(int jobId) { return job(jobId).submittedAt; }
+
+        std::vector<Clock::time_point> producedAt(int jobId)
+        {
+            Job& j = job(jobId);
+            std::lock_guard<std::mutex> lock(j.mutex);
+            return j.producedAt;
+        }
+
+    private:
+        struct Job
+        {
+            std::mutex mutex;
+            CompletionResult result{ {}, std::string(), 0.0F };
+            std::vector<Clock::time_point> producedAt;
+            bool finished = false;
+            std::atomic<bool> stopped{ false };
+            Clock::time_point submittedAt;
+
+            std::mutex callbackMutex;
+            Model::JobUpdateCallback callback = nullptr;
+            void* userData = nullptr;
+
+            std::thread thread;
+        };
+
+        Job& job(int jobId)
+        {
+            std::lock_guard<std::mutex> lock(m_jobsMutex);
+            return *m_jobs.at(jobId);
+        }
+
+        int submit()
+        {
+            std::lock_guard<std::mutex> lock(m_jobsMutex);
+            const int jobId = m_nextJobId++;
+            auto j = std::make_unique<Job>();
+            Job* raw = j.get();
+            raw->submittedAt = Clock::now();
+            raw->thread = std::thread([this, raw, jobId]() { produce(*raw, jobId); });
+            m_jobs[jobId] = std::move(j);
+            return jobId;
+        }
+
+        void produce(Job& j, int jobId)
+        {
+            Clock::time_point next = j.submittedAt + m_firstToken;
+            for (size_t i = 0; i < m_tokens && !j.stopped; ++i)
+            {
+                std::this_thread::sleep_until(next);
+                next += m_interval;
+                {
+                    std::lock_guard<std::mutex> lock(j.mutex);
+                    j.result.tokens.push_back(static_cast<int32_t>(i));
+                    j.result.text += "t" + std::to_string(i) + " ";
+                    j.producedAt.push_back(Clock::now());
+                }
+                notify(j, jobId);
+            }
+            {
+                std::lock_guard<std::mutex> lock(j.mutex);
+                j.finished = true;
+            }
+            notify(j, jobId);
+        }
+
+        void notify(Job& j, int jobId)
+        {
+            std::lock_guard<std::mutex> lock(j.callbackMutex);
+            if (j.callback)
+            {
+                j.callback(jobId, j.userData);
+            }
+        }
+
+        const size_t m_tokens;
+        const Milliseconds m_firstToken;
+        const Milliseconds m_interval;
+        const bool m_push;
+
+        std::mutex m_jobsMutex;
+        std::map<int, std::unique_ptr<Job>> m_jobs;
+        int m_nextJobId = 0;
+    };
+
+    // When the consumer first saw each token of one job
+    struct Observed
+    {
+        std::vector<Clock::time_point> seenAt;
+        std::vector<int32_t> tokens;
+        size_t textOffset = 0;
+
+        void record(const CompletionResult& delta)
+        {
+            const Clock::time_point now = Clock::now();
+            tokens.insert(tokens.end(), delta.tokens.begin(), delta.tokens.end());
+            seenAt.insert(seenAt.end(), delta.tokens.size(), now);
+            textOffset += delta.text.size();
+        }
+    };
+
+    // The consumer loop as ModelManager ran it before JobNotifier
+    void consumeBySleeping(FakeEngine& engine, int jobId, Observed& observed)
+    {
+        while (true)
+        {
+            const bool finished = engine.isJobFinished(jobId);
+            CompletionResult full = engine.getJobResult(jobId);
+            if (full.tokens.size() > observed.tokens.size())
+            {
+                CompletionResult delta;
+                delta.tokens.assign(full.tokens.begin() + observed.tokens.size(), full.tokens.end());
+                delta.text = full.text.substr(observed.textOffset);
+                observed.record(delta);
+            }
+            if (finished)
+            {
+                return;
+            }
+            std::this_thread::sleep_for(OLD_POLL_INTERVAL);
+        }
+    }
+
+    // One JobPump step, reading like ModelManager::readJobResultSince
+    bool consumeStep(FakeEngine& engine, Model::JobNotifier& notifier, int jobId, Observed& observed)
+    {
+        const bool finished = engine.isJobFinished(jobId);
+
+        CompletionResult delta;
+        if (auto* ext = notifier.extensionFor(&engine))
+        {
+            ext->getJobResultSince(jobId, observed.tokens.size(), observed.textOffset, delta);
+        }
+        else
+        {
+            CompletionResult full = engine.getJobResult(jobId);
+            delta.tokens.assign(full.tokens.begin() + observed.tokens.size(), full.tokens.end());
+            delta.text = full.text.substr(observed.textOffset);
+        }
+        if (!delta.tokens.empty())
+        {
+            observed.record(delta);
+        }
+        return finished;
+    }
+
+    struct Result
+    {
+        std::vector<double> ttftMs;
+        std::vector<double> delayMs;
+        int failures = 0;
+    };
+
+    Result run(const std::string& mode, int jobs, size_t tokens, Milliseconds firstToken, Milliseconds interval)
+    {
+        FakeEngine engine(tokens, firstToken, interval, mode == "notifier-push");
+        std::vector<Observed> observed(jobs);
+        std::vector<int> jobIds;
+
+        if (mode == "sleep-poll")
+        {
+            std::vector<std::thread> consumers;
+            for (int i = 0; i < jobs; ++i)
+            {
+                const int jobId = engine.submitCompletionsJob(CompletionParameters());
+                jobIds.push_back(jobId);
+                consumers.emplace_back([&engine, &observed, jobId, i]() { consumeBySleeping(engine, jobId, observed[i]); });
+            }
+            for (auto& consumer : consumers)
+            {
+                consumer.join();
+            }
+        }
+        else
+        {
+            // Same wiring as ModelManager::startStreamingPump
+            Model::JobNotifier notifier;
+            notifier.setExtensionResolver(&FakeEngine::resolve);
+            JobPump pump(PUMP_THREADS);
+
+            std::mutex doneMutex;
+            std::condition_variable doneCv;
+            int remaining = jobs;
+
+            for (int i = 0; i < jobs; ++i)
+            {
+                const int jobId = engine.submitCompletionsJob(CompletionParameters());
+                jobIds.push_back(jobId);
+
+                JobPump::Handle handle = pump.add(
+                    [&engine, &notifier, &observed, jobId, i]() { return consumeStep(engine, notifier, jobId, observed[i]); },
+                    [&, jobId]() {
+                        notifier.unsubscribe(&engine, jobId);
+                        std::lock_guard<std::mutex> lock(doneMutex);
+                        --remaining;
+                        doneCv.notify_all();
+                    });
+                notifier.subscribe(&engine, jobId, [&pump, handle]() { pump.wake(handle); });
+                pump.wake(handle);
+            }
+
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCv.wait(lock, [&remaining]() { return remaining == 0; });
+        }
+
+        Result result;
+        for (int i = 0; i < jobs; ++i)
+        {
+            const std::vector<Clock::time_point> produced = engine.producedAt(jobIds[i]);
+            bool inOrder = observed[i].tokens.size() == tokens;
+            for (size_t t = 0; inOrder && t < tokens; ++t)
+            {
+                inOrder = observed[i].tokens[t] == static_cast<int32_t>(t);
+            }
+            if (!inOrder || produced.size() != tokens)
+            {
+                std::cout << "FAILED: " << mode << " job " << jobIds[i] << " saw " << observed[i].tokens.size()
+                    << " of " << tokens << " tokens, or out of order" << std::endl;
+                ++result.failures;
+                continue;
+            }
+
+            if (tokens > 0)
+            {
+                result.ttftMs.push_back(toMs(observed[i].seenAt[0] - engine.submittedAt(jobIds[i])));
+            }
+            for (size_t t = 0; t < tokens; ++t)
+            {
+                result.delayMs.push_back(toMs(observed[i].seenAt[t] - produced[t]));
+            }
+        }
+        return result;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+        return values[(std::min)(index, values.size() - 1)];
+    }
+
+    double mean(const std::vector<double>& values)
+    {
+        double sum = 0.0;
+        for (double value : values)
+        {
+            sum += value;
+        }
+        return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 5)
+    {
+        std::cerr << "usage: token_latency_bench <concurrent jobs> <tokens per job> <first token ms> <token interval ms>\n";
+        return 2;
+    }
+
+    const int jobs = (std::max)(1, std::stoi(argv[1]));
+    const size_t tokens = std::stoul(argv[2]);
+    const Milliseconds firstToken(std::stoll(argv[3]));
+    const Milliseconds interval(std::stoll(argv[4]));
+
+    int failures = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const char* mode : { "sleep-poll", "notifier-poll", "notifier-push" })
+    {
+        const Result result = run(mode, jobs, tokens, firstToken, interval);
+        failures += result.failures;
+        std::cout << mode << " ttft " << mean(result.ttftMs)
+            << " delay p50 " << percentile(result.delayMs, 0.50)
+            << " p95 " << percentile(result.delayMs, 0.95)
+            << " max " << percentile(result.delayMs, 1.0) << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+"""
+Runs token_latency_bench over a few engine speeds and job counts, and compares the old
+100 ms sleep loop with JobNotifier's polling fallback and with engine push. Each run
+reports time to first token and how long a token waited between the engine producing it
+and the consumer seeing it.
+
+Build token_latency_bench.cpp first (see the top of that file), then run
+    python token_latency_bench.py path/to/token_latency_bench
+
+Fails if a consumer lost tokens, or if a notifier path was not faster than the sleep loop.
+"""
+
+import os
+import subprocess
+import sys
+
+# (concurrent jobs, tokens per job, first token ms, token interval ms)
+CONFIGS = [
+    (1, 50, 150, 25),
+    (4, 100, 150, 10),
+    (16, 50, 230, 40),
+]
+
+
+def parse(output):
+    results = {}
+    for line in output.splitlines():
+        parts = line.split()
+        if len(parts) == 10 and parts[1] == "ttft":
+            results[parts[0]] = {"ttft": float(parts[2]), "p50": float(parts[5]),
+                                 "p95": float(parts[7]), "max": float(parts[9])}
+    return results
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: python token_latency_bench.py path/to/token_latency_bench")
+        return 2
+
+    binary = os.path.abspath(sys.argv[1])
+    failures = 0
+
+    for jobs, tokens, first_token, interval in CONFIGS:
+        result = subprocess.run([binary, str(jobs), str(tokens), str(first_token), str(interval)],
+                                stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True, timeout=300)
+        print(f"{jobs} jobs x {tokens} tokens, first token at {first_token} ms, then every {interval} ms")
+        results = parse(result.stdout)
+        for mode, r in results.items():
+            print(f"  {mode:14} ttft {r['ttft']:7.1f} ms   token delay p50 {r['p50']:6.1f} ms"
+                  f"  p95 {r['p95']:6.1f} ms  max {r['max']:6.1f} ms")
+
+        if result.returncode != 0 or len(results) != 3:
+            print(result.stdout)
+            failures += 1
+            continue
+        for mode in ("notifier-poll", "notifier-push"):
+            if results[mode]["p95"] >= results["sleep-poll"]["p95"]:
+                print(f"  {mode} was not faster than sleep-poll")
+                failures += 1
+
+    print(f"{len(CONFIGS)} configurations, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
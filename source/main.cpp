@@ -248,6 +248,9 @@ public:
             EnforceFrameRate(frameStartTime);
         }
 
+        // Write out chat edits still waiting in the save queue
+        Chat::ChatManager::getInstance().flushPendingSaves();
+
         return 0;
     }
 